@@ -1 +1,3 @@
 from .feat import Feat, FeatRegressor, FeatClassifier
+from .feat import csv_to_columnar, load_columnar
+from .feat import csv_to_longitudinal, load_longitudinal
@@ -10,6 +10,10 @@ from sklearn.base import BaseEstimator, RegressorMixin, ClassifierMixin
 import numpy as np
 import pandas as pd
 from _feat import cppFeat
+from _feat import csv_to_columnar as _csv_to_columnar
+from _feat import load_columnar as _load_columnar
+from _feat import csv_to_longitudinal as _csv_to_longitudinal
+from _feat import load_longitudinal as _load_longitudinal
 from sklearn.metrics import mean_squared_error as mse
 from sklearn.metrics import log_loss
 from sklearn.utils import check_X_y, check_array
@@ -137,6 +141,18 @@ class Feat(BaseEstimator):
         Tune the initial linear model's penalization parameter. 
     tune_final: boolean, optional (default: True)
         Tune the final linear model's penalization parameter. 
+    cache_size: int, optional (default: 268435456)
+        Memory in bytes used to cache the outputs of subtrees on the 
+        training data, so that subtrees shared between programs are 
+        evaluated once. If 0, outputs are not cached. 
+    downsample: float, optional (default: 1.0)
+        Fraction of the training samples that lexicase selection uses as 
+        cases. A new sample is drawn each generation, and individuals 
+        only store their errors on it. 
+    informed_downsample: boolean, optional (default: False)
+        Draw the down-sampled cases so that they are as different as 
+        possible, judged by the errors of a few individuals on every 
+        sample. 
     starting_pop: str, optional (default: "")
         Provide a starting pop in json format. 
     """
@@ -190,6 +206,9 @@ class Feat(BaseEstimator):
                  protected_groups="", 
                  tune_initial=False, 
                  tune_final=True, 
+                 cache_size=268435456, 
+                 downsample=1.0, 
+                 informed_downsample=False, 
                  starting_pop="",
                 ):
         self.pop_size=pop_size
@@ -234,6 +253,9 @@ class Feat(BaseEstimator):
         self.protected_groups=protected_groups
         self.tune_initial=tune_initial
         self.tune_final=tune_final
+        self.cache_size=cache_size
+        self.downsample=downsample
+        self.informed_downsample=informed_downsample
         self.starting_pop=starting_pop
         
     def load(self, filename):
@@ -276,7 +298,9 @@ class Feat(BaseEstimator):
             setattr(self.cfeat_, k, v)
 
     def fit(self, X, y, Z=None):
-        """Fit a model."""    
+        """Fit a model. Z is longitudinal data, or the path of a 
+        longitudinal file, which is read in C++ straight into flat 
+        storage."""    
 
         X,y = self._clean(X, y, set_feature_names=True)
 
@@ -290,6 +314,22 @@ class Feat(BaseEstimator):
         self.is_fitted_ = True
         return self
 
+    def fit_columnar(self, path, Z=None):
+        """Fit a model on a columnar file written by csv_to_columnar. The
+        features are read from the mapped file without passing through 
+        Python. Z is as in fit."""
+        self._set_cfeat_params() 
+
+        if Z:
+            self.cfeat_.fit_columnar(path,Z)
+        else:
+            self.cfeat_.fit_columnar(path)
+
+        self.feature_names = self.cfeat_.feature_names
+        self.n_features_in_ = len(self.feature_names.split(','))
+        self.is_fitted_ = True
+        return self
+
     def predict(self,X,Z=None):
         """Predict on X."""
         if not self.is_fitted_:
@@ -313,15 +353,11 @@ class Feat(BaseEstimator):
             raise NotImplementedError('longitudinal not implemented')
             return
 
-        archive = self.cfeat_.get_archive(front)
+        ids = self.cfeat_.get_archive_ids(front)
+        y_pred = self.cfeat_.predict_archive_batch(X, front)
         preds = []
-        for ind in archive:
-            if ind['id'] == 9234:
-                print('individual:',json.dumps(ind,indent=2))
-            tmp = {}
-            tmp['id'] = ind['id']
-            tmp['y_pred'] = self.cfeat_.predict_archive(ind['id'], X) 
-            preds.append(tmp)
+        for i, yp in zip(ids, y_pred):
+            preds.append({'id':i, 'y_pred':yp})
 
         return preds
 
@@ -402,6 +438,13 @@ class Feat(BaseEstimator):
     def get_dim(self): return self.cfeat_.get_dim()
     def get_n_nodes(self): return self.cfeat_.get_n_nodes()
     def get_complexity(self): return self.cfeat_.get_complexity()
+    def predict_file(self, path, out_path, chunk_size=65536, sep=','):
+        """Predict on a csv file too large for memory, chunk_size rows at a 
+        time, writing one prediction per line to out_path."""
+        return self.cfeat_.predict_file(path, out_path, chunk_size, sep)
+    def export_cpp(self, name='feat_model'): 
+        """C++ header source that reproduces predict() without Feat."""
+        return self.cfeat_.export_cpp(name)
 
 class FeatRegressor(Feat):
     """Convenience method that enforces regression options."""
@@ -469,15 +512,42 @@ class FeatClassifier(Feat):
 
         X = self._prep_X(X)
 
-        archive = self.cfeat_.get_archive(front)
+        ids = self.cfeat_.get_archive_ids(front)
+        if Z:
+            y_proba = self.cfeat_.predict_proba_archive_batch(X, Z, front)
+        else:
+            y_proba = self.cfeat_.predict_proba_archive_batch(X, front)
         probs = []
-        for ind in archive:
-            tmp = {}
-            tmp['id'] = ind['id']
-            if Z:
-                tmp['y_proba'] = self.cfeat_.predict_proba_archive(ind['id'], X, Z)
-            else:
-                tmp['y_proba'] = self.cfeat_.predict_proba_archive(ind['id'], X)
-            probs.append(tmp)
+        for i, yp in zip(ids, y_proba):
+            probs.append({'id':i, 'y_proba':yp})
 
         return probs
+
+
+def csv_to_columnar(csv_path, path, sep=','):
+    """Converts a csv file laid out for Feat to a binary columnar file that
+    loads without parsing. The conversion runs in parallel."""
+    _csv_to_columnar(csv_path, path, sep)
+
+
+def load_columnar(path):
+    """Loads a columnar file written by csv_to_columnar. Returns X 
+    (samples x features), y and the feature names."""
+    X, y, names, _ = _load_columnar(path)
+    return X.T, y, names
+
+
+def csv_to_longitudinal(csv_path, path, sep=','):
+    """Converts a longitudinal csv file, with the columns id, date, value and
+    name, to a binary file that loads without parsing. The conversion runs in
+    parallel."""
+    _csv_to_longitudinal(csv_path, path, sep)
+
+
+def load_longitudinal(path, ids=None):
+    """Loads longitudinal data from a csv file or a file written by 
+    csv_to_longitudinal, as the Z argument of fit and predict. If ids are 
+    given, sample k holds the rows of ids[k]; otherwise ids must be 
+    0 ... n-1. Each sample gets its own arrays, so to fit on large files,
+    pass their path to fit instead."""
+    return _load_longitudinal(path, [] if ids is None else list(ids))
@@ -22,23 +22,125 @@ namespace FT{
         {
             validation=false;
             group_intersections=0;
+            cache = NULL;
+            fm_only = false;
             if (X.size() != 0)
                 set_protected_groups();
+            set_longitudinal();
+        }
+
+        void Data::set_feature_major()
+        {
+            fm_only = false;
+            X_fm.resize(0, 0);
+            transposed = Once();
+        }
+
+        void Data::set_features(RowMatrixXf features)
+        {
+            view.reset();
+            view.rows.clear();
+            fm_only = true;
+            X.resize(0, 0);
+            X_fm = std::move(features);
+            set_protected_groups();
+        }
+
+        void Data::transpose() const
+        {
+            std::call_once(*transposed.flag, [&]{ X_fm = X; });
+        }
+
+        MatrixXf Data::matrix() const
+        {
+            if (!is_view() && !fm_only)
+                return X;
+            MatrixXf m(n_features(), n_samples());
+            for (int i = 0; i < n_features(); ++i)
+                m.row(i) = feature(i).matrix().transpose();
+            return m;
+        }
+
+        void Data::set_longitudinal()
+        {
+            Z_flat = flatten(Z);
+        }
+
+        void Data::set_longitudinal(LongVars vars)
+        {
+            Z_flat = std::move(vars);
+        }
+
+        Data::View::View(const View& v) : source(v.source), rows(v.rows)
+        {
+            if (source)
+                reset(source);
+        }
+
+        void Data::View::reset(const Data* source)
+        {
+            this->source = source;
+            features.reset();
+            gathered.clear();
+            vars.clear();
+            if (!source)
+                return;
+            features.reset(new std::once_flag[source->n_features()]);
+            gathered.resize(source->n_features());
+            for (const auto& val : source->Z_flat)
+                vars[val.first];
+        }
+
+        const LongVars& Data::get_longitudinal() const
+        {
+            if (is_view())
+                for (const auto& val : view.vars)
+                    gather_longitudinal(val.first);
+            return Z_flat;
+        }
+
+        void Data::gather_feature(int i) const
+        {
+            std::call_once(view.features[i], [&]{
+                const float* x = view.source->feature(i).data();
+                ArrayXf& f = view.gathered[i];
+                f.resize(view.rows.size());
+                for (size_t j = 0; j < view.rows.size(); ++j)
+                    f[j] = x[view.rows[j]];
+            });
+        }
+
+        void Data::gather_longitudinal(const string& name) const
+        {
+            auto it = view.vars.find(name);
+            if (it == view.vars.end())
+                return;
+            std::call_once(it->second, [&]{
+                Z_flat.at(name) = 
+                    view.source->longitudinal(name).gather(view.rows);
+            });
         }
         
         void Data::set_protected_groups()
         {
             this->cases.resize(0);
             group_intersections=0;
+            // data made from a matrix reads X, which is not transposed 
+            // just for this
+            auto values = [&](int i) -> VectorXf {
+                if (is_view() || fm_only)
+                    return feature(i).matrix();
+                return X.row(i).transpose();
+            };
             // store levels of protected attributes in X
             if (!protect.empty())
             {
-                logger.log("storing protected attributes...",2);
+                LOG("storing protected attributes...",2);
                 for (int i = 0; i < protect.size(); ++i)
                 {
                     if (protect.at(i))
                     {
-                        protect_levels[i] = unique(VectorXf(X.row(i)));
+                        protect_levels[i] = unique(values(i));
                         protected_groups.push_back(i);
                         group_intersections += protect_levels.at(i).size();
                     }
@@ -46,27 +148,27 @@ namespace FT{
                 for (auto pl : protect_levels)
                 {
                     int group = pl.first;
-                    logger.log("\tfeature " + to_string( group) + ":"
+                    LOG("\tfeature " + to_string( group) + ":"
                         + to_string(pl.second.size()) + " values; ",3);
                 }
                 // if there aren't that many group interactions, we might as 
                 // well enumerate them to save time during execution.
                 if (group_intersections < 100)
                 {
-                    logger.log("storing group intersections...",3);
+                    LOG("storing group intersections...",3);
                     for (auto pl : protect_levels)
                     {
                         int group = pl.first;
                         for (auto level : pl.second)
                         {
-                            ArrayXb x = (X.row(group).array() == level);
+                            ArrayXb x = (values(group).array() == level);
                             this->cases.push_back(x);
                             /* cout << "new case with : " << x.count() */ 
                             /*     << "samples\n"; */
                         }
                             
                     }
-                    logger.log("stored " + to_string(this->cases.size()) 
+                    LOG("stored " + to_string(this->cases.size()) 
                             +" cases",3);
                 }
                 /* else */
@@ -84,32 +186,135 @@ namespace FT{
                 WARN("batch_size is set to " 
                         + to_string(batch_size) + " when getting batch");
 
-            vector<size_t> idx(y.size());
+            vector<size_t> idx(std::max(batch_size, 0));
             std::iota(idx.begin(), idx.end(), 0);
     //        r.shuffle(idx.begin(), idx.end());
-            db.X.resize(X.rows(),batch_size);
-            db.y.resize(batch_size);
-            for (const auto& val: Z )
+            view_cases(db, idx);
+        }
+
+        void Data::get_cases(Data &db, const vector<size_t>& idx) const
+        {
+            size_t n = idx.size();
+            db.view.reset();
+            db.view.rows.clear();
+            db.cache = NULL;
+            // the cases are copied to feature-major order only
+            db.fm_only = true;
+            db.X.resize(0, 0);
+            db.X_fm.resize(n_features(), n);
+            db.y.resize(n);
+            for (unsigned i = 0; i<n; ++i)
             {
-                db.Z[val.first].first.resize(batch_size);
-                db.Z[val.first].second.resize(batch_size);
+               if (!is_view() && !fm_only)
+                   db.X_fm.col(i) = X.col(idx.at(i)); 
+               db.y(i) = y(idx.at(i)); 
             }
-            for (unsigned i = 0; i<batch_size; ++i)
+            for (int j = 0; (is_view() || fm_only) && j < n_features(); ++j)
             {
-               
-               db.X.col(i) = X.col(idx.at(i)); 
-               db.y(i) = y(idx.at(i)); 
+                Map<const ArrayXf> x = feature(j);
+                float* f = db.X_fm.row(j).data();
+                for (unsigned i = 0; i<n; ++i)
+                    f[i] = x(idx.at(i));
+            }
+            LongVars vars;
+            for (const auto& val: get_longitudinal())
+                vars.emplace(val.first, val.second.gather(idx));
+            db.set_longitudinal(std::move(vars));
+            db.set_protected_groups();
+        }
 
-               for (const auto& val: Z )
-               {
-                    db.Z.at(val.first).first.at(i) = \
-                                      Z.at(val.first).first.at(idx.at(i));
-                    db.Z.at(val.first).second.at(i) = \
-                                      Z.at(val.first).second.at(idx.at(i));
-               }
+        void Data::view_cases(Data &db, const vector<size_t>& idx) const
+        {
+            size_t n = idx.size();
+            const Data* source = is_view() ? view.source : this;
+            db.view.reset(source);
+            db.cache = NULL;
+            db.view.rows.resize(n);
+            db.y.resize(y.size() ? n : 0);
+            for (unsigned i = 0; i<n; ++i)
+            {
+                db.view.rows[i] = is_view() ? view.rows.at(idx.at(i)) 
+                                            : idx.at(i);
+                if (y.size())
+                    db.y(i) = y(idx[i]);
             }
+            db.fm_only = false;
+            db.X.resize(0, 0);
+            db.X_fm.resize(0, 0);
+            db.Z_flat.clear();
+            for (const auto& val : source->Z_flat)
+                db.Z_flat[val.first];
             db.set_protected_groups();
         }
+
+        void Data::split_cases(vector<size_t>& t_idx, vector<size_t>& v_idx,
+                float split, bool shuffle, std::mt19937* gen) const
+        {
+            // order[k] is the sample at position k after shuffling. the 
+            // folds are chosen by position and hold their samples in 
+            // order of position.
+            int n = n_samples();
+            vector<int> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            if (shuffle)
+            {
+                if (gen)
+                    r.shuffle(order.begin(), order.end(), *gen);
+                else
+                    r.shuffle(order.begin(), order.end());
+            }
+            t_idx.clear();
+            v_idx.clear();
+
+            if (!classification)
+            {
+                int train_size = min(int(n*split), n-1);
+                int val_size = max(int(n*(1-split)), 1);
+                for (int k = 0; k < train_size; ++k)
+                    t_idx.push_back(order[k]);
+                for (int k = train_size; k < train_size + val_size; ++k)
+                    v_idx.push_back(order.at(k));
+                return;
+            }
+
+            LOG("Stratify split called with initial data size as " 
+                    + to_string(n), 3);
+                            
+            std::map<float, vector<int>> label_indices;
+                
+            //getting positions for all labels
+            for(int k = 0; k < n; k++)
+                label_indices[y(order[k])].push_back(k);
+                   
+            vector<int> t_pos;
+            vector<int> v_pos;
+            
+            for (const auto& li : label_indices)
+            {
+                int t_size = ceil(li.second.size()*split);
+                int x;
+                
+                for(x = 0; x < t_size; x++)
+                    t_pos.push_back(li.second.at(x));
+                    
+                for(; x < li.second.size(); x++)
+                    v_pos.push_back(li.second.at(x));
+                
+                LOG("Label is " + to_string(li.first), 3, "\t");
+                LOG("Total size = " + to_string(li.second.size()), 
+                        3, "\t");
+                LOG("training_size = " + to_string(t_size), 3, "\t");
+                LOG("verification size = " 
+                        + to_string((li.second.size() - t_size)), 3, "\n");
+            }
+            
+            sort(t_pos.begin(), t_pos.end());
+            sort(v_pos.begin(), v_pos.end());
+            for (int k : t_pos)
+                t_idx.push_back(order[k]);
+            for (int k : v_pos)
+                v_idx.push_back(order[k]);
+        }
         
         DataRef::DataRef()
         {
@@ -225,219 +430,17 @@ namespace FT{
             vCreated = false;
         }
         
-        void DataRef::shuffle_data()
-        {
-            Eigen::PermutationMatrix<Dynamic,Dynamic> perm(o->X.cols());
-            perm.setIdentity();
-            r.shuffle(perm.indices().data(), 
-                    perm.indices().data()+perm.indices().size());
-            /* cout << "X before shuffle: \n"; */
-            /* cout << o->X.transpose() << "\n"; */
-            o->X = o->X * perm;       // shuffles columns of X
-
-            /* cout << "X after shuffle: \n"; */
-            /* cout << o->X.transpose() << "\n"; */
-            // shuffle y too
-            o->y = (o->y.transpose() * perm).transpose() ;       
-            
-            if(o->Z.size() > 0)
-            {
-                std::vector<int> zidx(o->y.size());
-                // zidx maps the perm_indices values to their indices, 
-                // i.e. the inverse transform
-                for (unsigned i = 0; i < perm.indices().size(); ++i)
-                    zidx.at(perm.indices()(i)) = i;
-                /* cout << "zidx :\n"; */
-                /* for (const auto& zi : zidx) */
-                /*     cout << zi << "," ; */
-                /* cout << "\n"; */
-                for(auto &val : o->Z)
-				{
-                    /* cout << "unshuffled " << val.first << ": \n"; */
-                    /* for (unsigned i = 0; i < val.second.first.size(); ++i) */
-                    /* { */
-                        /* cout << val.second.first.at(i).transpose() << "\n"; */
-                    /* } */
-                    reorder_longitudinal(val.second.first, zidx);
-                    reorder_longitudinal(val.second.second, zidx);
-                    /* cout << "shuffled " << val.first << ": \n"; */
-                    /* for (unsigned i = 0; i < val.second.first.size(); ++i) */
-                    /* { */
-                    /*     cout << val.second.first.at(i).transpose() << "\n"; */
-                    /* } */
-				}
-            }
-        }
-        
-        void DataRef::split_stratified(float split)
+        void DataRef::train_test_split(bool shuffle, float split, 
+                                       std::mt19937* gen)
         {
-            logger.log("Stratify split called with initial data size as " 
-                    + to_string(o->X.cols()), 3);
-                            
-            std::map<float, vector<int>> label_indices;
-                
-            //getting indices for all labels
-            for(int x = 0; x < o->y.size(); x++)
-                label_indices[o->y(x)].push_back(x);
-                   
-            /* for (const auto& li : label_indices){ */
-            /*     cout << "label " << li.first << ":\t"; */
-            /*     for (const auto& val : li.second){ */
-            /*         cout << val << ", "; */
-            /*     } */ 
-            /*     cout << endl; */
-            /* } */
-            std::map<float, vector<int>>::iterator it = label_indices.begin();
-            
-            vector<int> t_indices;
-            vector<int> v_indices;
-            
-            int t_size;
-            int x;
-            
-            for(; it != label_indices.end(); it++)
-            {
-                t_size = ceil(it->second.size()*split);
-                
-                for(x = 0; x < t_size; x++)
-                    t_indices.push_back(it->second.at(x));
-                    
-                for(; x < it->second.size(); x++)
-                    v_indices.push_back(it->second.at(x));
-                
-                logger.log("Label is " + to_string(it->first), 3, "\t");
-                logger.log("Total size = " + to_string(it->second.size()), 
-                        3, "\t");
-                logger.log("training_size = " + to_string(t_size), 3, "\t");
-                logger.log("verification size = " 
-                        + to_string((it->second.size() - t_size)), 3, "\n");
-                
-            }
-            
-            X_t.resize(o->X.rows(), t_indices.size());
-            X_v.resize(o->X.rows(), v_indices.size());
-            y_t.resize(t_indices.size());
-            y_v.resize(v_indices.size());
-            
-            sort(t_indices.begin(), t_indices.end());
-            
-            for(int x = 0; x < t_indices.size(); x++)
-            {
-                t->X.col(x) = o->X.col(t_indices.at(x));
-                t->y(x) = o->y(t_indices.at(x));
-                
-                if(o->Z.size() > 0)
-                {
-                    for(auto const &val : o->Z)
-                    {
-                        t->Z[val.first].first.push_back(
-                                val.second.first[t_indices.at(x)]);
-                        t->Z[val.first].second.push_back(
-                                val.second.second[t_indices.at(x)]);
-                    }
-                }
-            }
-            
-            sort(v_indices.begin(), v_indices.end());
-            
-            for(int x = 0; x < v_indices.size(); x++)
-            {
-                v->X.col(x) = o->X.col(v_indices.at(x));
-                v->y(x) = o->y(v_indices.at(x));
-                
-                if(o->Z.size() > 0)
-                {
-                    for(auto const &val : o->Z)
-                    {
-                        v->Z[val.first].first.push_back(
-                                val.second.first[t_indices.at(x)]);
-                        v->Z[val.first].second.push_back(
-                                val.second.second[t_indices.at(x)]);
-                    }
-                }
-            }
-
-        }
-     
-        void DataRef::train_test_split(bool shuffle, float split)
-        {
-            /* @param X: n_features x n_samples matrix of training data
-             * @param y: n_samples vector of training labels
-             * @param shuffle: whether or not to shuffle X and y
-             * @param[out] X_t, X_v, y_t, y_v: training and validation matrices
+            /* @param shuffle: whether or not to shuffle the samples
+             * @param split: fraction of the samples used for training
+             * @param[out] t, v: training and validation data
              */
-             
-            if (shuffle)     // generate shuffle index for the split
-                shuffle_data();
-                
-            if(classification)
-                split_stratified(split);
-            else
-            {        
-                int train_size = min(int(o->X.cols()*split), 
-                                     int(o->X.cols()-1));
-                int val_size = max(int(o->X.cols()*(1-split)), 1);
-                // resize training and test sets
-                X_t.resize(o->X.rows(),train_size);
-                X_v.resize(o->X.rows(),val_size);
-                y_t.resize(train_size);
-                y_v.resize(val_size);
-                
-                // map training and test sets  
-                t->X = MatrixXf::Map(o->X.data(),t->X.rows(),
-                                     t->X.cols());
-                v->X = MatrixXf::Map(o->X.data()+t->X.rows()*t->X.cols(),
-                                           v->X.rows(),v->X.cols());
-
-                t->y = VectorXf::Map(o->y.data(),t->y.size());
-                v->y = VectorXf::Map(o->y.data()+t->y.size(),v->y.size());
-                if(o->Z.size() > 0)
-                    split_longitudinal(o->Z, t->Z, v->Z, split);
-            }
-            t->set_protected_groups();
-            v->set_protected_groups();
+            vector<size_t> t_idx, v_idx;
+            o->split_cases(t_idx, v_idx, split, shuffle, gen);
+            o->get_cases(*t, t_idx);
+            o->get_cases(*v, v_idx);
         }  
-        
-        void DataRef::split_longitudinal( LongData &Z, LongData &Z_t, 
-                LongData &Z_v, float split)
-        {
-        
-            int size;
-            for ( const auto val: Z )
-            {
-                size = Z.at(val.first).first.size();
-                break;
-            }
-            
-            int testSize = int(size*split);
-            int validateSize = int(size*(1-split));
-                
-            for ( const auto &val: Z )
-            {
-                vector<ArrayXf> _Z_t_v, _Z_t_t, _Z_v_v, _Z_v_t;
-                _Z_t_v.assign(Z[val.first].first.begin(), 
-                        Z[val.first].first.begin()+testSize);
-                _Z_t_t.assign(Z[val.first].second.begin(), 
-                        Z[val.first].second.begin()+testSize);
-                _Z_v_v.assign(Z[val.first].first.begin()+testSize, 
-                          Z[val.first].first.begin()+testSize+validateSize);
-                _Z_v_t.assign(Z[val.first].second.begin()+testSize, 
-                          Z[val.first].second.begin()+testSize+validateSize);
-                
-                Z_t[val.first] = make_pair(_Z_t_v, _Z_t_t);
-                Z_v[val.first] = make_pair(_Z_v_v, _Z_v_t);
-            }
-        }
-        
-		void DataRef::reorder_longitudinal(vector<ArrayXf> &v, 
-                vector<int> const &order )  
-        {   
-			for ( int s = 1, d; s < order.size(); ++ s ) {
-				for ( d = order.at(s); d < s; d = order.at(d) ) ;
-				if (d == s) 
-                    while ( d = order.at(d), d != s ) 
-                        swap( v.at(s), v.at(d));
-			}
-		}
     }
 }
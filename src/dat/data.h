@@ -10,6 +10,9 @@ license: GNU/GPL v3
 #include <Eigen/Dense>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <random>
 
 using std::vector;
 using Eigen::MatrixXf;
@@ -19,16 +22,20 @@ using Eigen::VectorXi;
 using Eigen::Dynamic;
 using Eigen::Map;
 typedef Eigen::Array<bool,Eigen::Dynamic,1> ArrayXb;
+typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> 
+    RowMatrixXf;
 using namespace std;
-typedef std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf>>> LongData;
 // internal includes
 //#include "params.h"
+#include "longitudinal.h"
 #include "../util/utils.h"
 //#include "node/node.h"
 //external includes
 
 namespace FT
 {
+    namespace Pop{ class SubtreeCache; }
+
     /**
     * @namespace FT::Dat
     * @brief namespace containing Data structures used in Feat
@@ -37,6 +44,17 @@ namespace FT
         /*!
          * @class Data
          * @brief data holding X, y, and Z data
+         *
+         * Terminals read features in feature-major order (see feature()).
+         * Data made from a matrix copies X to that order the first time a
+         * feature is read. Data copied by get_cases() or filled by 
+         * set_features() holds its features only in that order, and X is 
+         * left empty.
+         *
+         * A Data may also be a view of some samples of another one (see
+         * view_cases()). A view holds y and the indices of its samples;
+         * its features and longitudinal variables are gathered from the
+         * source the first time they are read, and X is left empty.
          */
         class Data
         {
@@ -44,25 +62,163 @@ namespace FT
      
                 MatrixXf& X; // n_features x n_samples matrix of features 
                 VectorXf& y; // n_samples labels
-                LongData& Z; // longitudinal features
+                LongData& Z; // longitudinal features, as given
                 bool classification;
                 bool validation; 
                 vector<bool> protect; // protected subgroups of features
+                /// cache of subtree outputs on this data, set by 
+                /// SubtreeCache::set_data(). views don't have one.
+                mutable Pop::SubtreeCache* cache;
 
                 Data(MatrixXf& X, VectorXf& y, LongData& Z, bool c = false, 
                         vector<bool> protect = vector<bool>());
 
                 void set_validation(bool v=true);
                 void set_protected_groups();
+
+                /// drops the feature-major copy of X, so that it is made 
+                /// again when a feature is read. call after modifying X.
+                void set_feature_major();
+
+                /// holds the features given in feature-major order 
+                /// (n_features x n_samples), as get_cases() does, and 
+                /// leaves X empty.
+                void set_features(RowMatrixXf features);
+
+                /// number of samples, which views count without X
+                int n_samples() const
+                {
+                    return is_view() ? view.rows.size() 
+                                     : fm_only ? X_fm.cols() : X.cols();
+                }
+
+                /// number of features
+                int n_features() const
+                {
+                    return is_view() ? view.source->n_features()
+                                     : fm_only ? X_fm.rows() : X.rows();
+                }
+
+                /// true if this data is a view of another
+                bool is_view() const { return view.source != nullptr; }
+
+                /// samples of feature i, contiguous in memory
+                Map<const ArrayXf> feature(int i) const
+                {
+                    if (is_view())
+                    {
+                        gather_feature(i);
+                        return Map<const ArrayXf>(view.gathered[i].data(), 
+                                                  view.rows.size());
+                    }
+                    if (!fm_only)
+                        transpose();
+                    return Map<const ArrayXf>(X_fm.row(i).data(), 
+                                              X_fm.cols());
+                }
+
+                /// the features as an n_features x n_samples matrix. data 
+                /// without X assembles it from its features.
+                MatrixXf matrix() const;
+
+                /// flattens Z into the storage read by longitudinal nodes.
+                /// call after modifying Z.
+                void set_longitudinal();
+
+                /// replaces the flat longitudinal storage. Z is left as is.
+                void set_longitudinal(LongVars vars);
+
+                /// longitudinal variable name. throws std::out_of_range
+                /// if there is none.
+                const LongVar& longitudinal(const string& name) const
+                {
+                    if (is_view())
+                        gather_longitudinal(name);
+                    return Z_flat.at(name);
+                }
+
+                /// all longitudinal variables
+                const LongVars& get_longitudinal() const;
                 
-                /// select random subset of data for training weights.
+                /// makes db a view of a subset of the samples for training 
+                /// weights.
                 void get_batch(Data &db, int batch_size) const;
+
+                /// copies the samples in idx to db.
+                void get_cases(Data &db, const vector<size_t>& idx) const;
+
+                /// makes db a view of the samples in idx, in that order. 
+                /// views of views index the data underneath, which must 
+                /// outlive db and not change while db is in use.
+                void view_cases(Data &db, const vector<size_t>& idx) const;
+
+                /// splits the samples into training and validation folds,
+                /// stratified by label for classification. if shuffle is 
+                /// set, the samples are shuffled first, drawing from gen if
+                /// it is given.
+                void split_cases(vector<size_t>& t_idx, 
+                        vector<size_t>& v_idx, float split, bool shuffle, 
+                        std::mt19937* gen = nullptr) const;
                 // protect_levels stores the levels of protected factors in X.
                 map<int,vector<float>> protect_levels;   
                 vector<int> protected_groups;
                 int group_intersections;
                 vector<ArrayXb> cases;  // used to pre-process cases if there 
                                         // aren't that many group intersections
+            private:
+                /// the samples of a view, and which of their features and
+                /// longitudinal variables have been gathered
+                struct View
+                {
+                    const Data* source = nullptr;   ///< data that isn't a view
+                    vector<size_t> rows;            ///< samples of source
+                    std::unique_ptr<std::once_flag[]> features;
+                    /// gathered features, by index. each is allocated when
+                    /// it is first read.
+                    mutable vector<ArrayXf> gathered;
+                    mutable std::map<string, std::once_flag> vars;
+
+                    View() = default;
+                    /// copies gather everything again into their own data
+                    View(const View& v);
+                    /// views the features and variables of source
+                    void reset(const Data* source = nullptr);
+                };
+                View view;
+
+                /// once flag that copies start unset
+                struct Once
+                {
+                    std::unique_ptr<std::once_flag> flag;
+
+                    Once() : flag(new std::once_flag) {}
+                    Once(const Once&) : Once() {}
+                    Once& operator=(const Once&) 
+                    { 
+                        flag.reset(new std::once_flag); 
+                        return *this; 
+                    }
+                };
+                Once transposed;
+
+                /// copies X to X_fm, once
+                void transpose() const;
+
+                /// gathers feature i of a view from its source, once
+                void gather_feature(int i) const;
+
+                /// gathers variable name of a view from its source, once
+                void gather_longitudinal(const string& name) const;
+
+                /// X with the samples of each feature stored contiguously, 
+                /// so that terminals read features without striding over X.
+                /// views don't use it.
+                mutable RowMatrixXf X_fm;
+                /// true if the features are held only in X_fm
+                bool fm_only;
+                /// the longitudinal variables in CSR layout. datasets 
+                /// derived by splits and batches only fill this, not Z.
+                mutable LongVars Z_flat;
         };
         
         /* !
@@ -123,24 +279,11 @@ namespace FT
                 
                 void setValidationData(Data *d);
                 
-                /// shuffles original data
-                void shuffle_data();
-                
-                /// split classification data as stratas
-                void split_stratified(float split);
-                
-                /// splits data into training and validation folds.
-                void train_test_split(bool shuffle, float split);
-
-                void split_longitudinal(
-                            LongData&Z,
-                            LongData&Z_t,
-                            LongData&Z_v,
-                            float split);
-                            
-                /// reordering utility for shuffling longitudinal data.
-                void reorder_longitudinal(vector<ArrayXf> &vec1, 
-                        const vector<int>& order); 
+                /// splits data into training and validation folds, copied
+                /// from o in one pass. o is left in order. if gen is 
+                /// given, the shuffle draws from it instead of r.
+                void train_test_split(bool shuffle, float split, 
+                                      std::mt19937* gen = nullptr);
 
         };
     }
@@ -0,0 +1,192 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "longitudinal.h"
+#include "../util/error.h"
+#include "../init.h"
+#include <algorithm>
+#include <cmath>
+
+namespace FT{
+
+    namespace Dat{
+
+        /// maps nans to 0 and clamps to [MIN_FLT, MAX_FLT], as
+        /// Node::limited() does
+        static inline float limit(float v)
+        {
+            if (std::isnan(v)) return 0.0f;
+            return std::min(std::max(v, MIN_FLT), MAX_FLT);
+        }
+
+        LongVar::LongVar() : offsets(1, 0), cache(std::make_shared<Cache>()) 
+        {}
+
+        LongVar::LongVar(
+                const std::pair<vector<ArrayXf>, vector<ArrayXf>>& z)
+            : cache(std::make_shared<Cache>())
+        {
+            const vector<ArrayXf>& v = z.first;
+            const vector<ArrayXf>& t = z.second;
+            if (v.size() != t.size())
+                THROW_LENGTH_ERROR("longitudinal values and times have "
+                        "different numbers of samples");
+
+            offsets.resize(v.size() + 1);
+            offsets[0] = 0;
+            for (size_t i = 0; i < v.size(); ++i)
+            {
+                if (v[i].size() != t[i].size())
+                    THROW_LENGTH_ERROR("sample " + std::to_string(i)
+                            + " has different numbers of values and times");
+                offsets[i+1] = offsets[i] + v[i].size();
+            }
+
+            values.resize(offsets.back());
+            times.resize(offsets.back());
+            for (size_t i = 0; i < v.size(); ++i)
+            {
+                values.segment(offsets[i], v[i].size()) = v[i];
+                times.segment(offsets[i], t[i].size()) = t[i];
+            }
+        }
+
+        LongVar LongVar::gather(const vector<size_t>& idx) const
+        {
+            LongVar g;
+            g.offsets.resize(idx.size() + 1);
+            for (size_t i = 0; i < idx.size(); ++i)
+                g.offsets[i+1] = g.offsets[i] + count(idx[i]);
+
+            g.values.resize(g.offsets.back());
+            g.times.resize(g.offsets.back());
+            for (size_t i = 0; i < idx.size(); ++i)
+            {
+                g.values.segment(g.offsets[i], g.count(i)) = value(idx[i]);
+                g.times.segment(g.offsets[i], g.count(i)) = time(idx[i]);
+            }
+            return g;
+        }
+
+        LongVar LongVar::slice(size_t start, size_t n) const
+        {
+            LongVar s;
+            size_t first = offsets.at(start), last = offsets.at(start + n);
+            s.offsets.resize(n + 1);
+            for (size_t i = 0; i <= n; ++i)
+                s.offsets[i] = offsets[start + i] - first;
+            s.values = values.segment(first, last - first);
+            s.times = times.segment(first, last - first);
+            return s;
+        }
+
+        std::pair<vector<ArrayXf>, vector<ArrayXf>> LongVar::unflatten() const
+        {
+            std::pair<vector<ArrayXf>, vector<ArrayXf>> z;
+            z.first.reserve(size());
+            z.second.reserve(size());
+            for (size_t i = 0; i < size(); ++i)
+            {
+                z.first.push_back(value(i));
+                z.second.push_back(time(i));
+            }
+            return z;
+        }
+
+        const LongStats& LongVar::stats() const
+        {
+            std::call_once(cache->once, 
+                    [this]{ cache->stats = aggregate(*this); });
+            return cache->stats;
+        }
+
+        LongStats aggregate(const LongVar& z)
+        {
+            size_t n = z.size();
+            LongStats s;
+            for (ArrayXf* a : {&s.count, &s.mean, &s.variance, &s.skew, 
+                               &s.kurtosis, &s.min, &s.max, &s.median, 
+                               &s.slope, &s.recent})
+                a->setZero(n);
+
+            // limited values and times of one sample
+            vector<float> v, t;
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t m = z.count(i);
+                s.count(i) = m;
+                if (m == 0)
+                    continue;
+
+                const float* x = z.values.data() + z.offsets[i];
+                const float* u = z.times.data() + z.offsets[i];
+                v.resize(m);
+                t.resize(m);
+
+                float sum = 0, tsum = 0;
+                float lo = MAX_FLT, hi = MIN_FLT;
+                size_t last = 0;
+                for (size_t j = 0; j < m; ++j)
+                {
+                    v[j] = limit(x[j]);
+                    t[j] = limit(u[j]);
+                    sum += v[j];
+                    tsum += t[j];
+                    lo = std::min(lo, v[j]);
+                    hi = std::max(hi, v[j]);
+                    if (u[j] > u[last])
+                        last = j;
+                }
+                float mean = sum/m, tmean = tsum/m;
+
+                // central moments of the values, and the covariance with
+                // time, accumulated together
+                float m2 = 0, m3 = 0, m4 = 0, tt = 0, tv = 0;
+                #pragma omp simd reduction(+:m2,m3,m4,tt,tv)
+                for (size_t j = 0; j < m; ++j)
+                {
+                    float d = v[j] - mean, d2 = d*d, dt = t[j] - tmean;
+                    m2 += d2;
+                    m3 += d2*d;
+                    m4 += d2*d2;
+                    tt += dt*dt;
+                    tv += dt*d;
+                }
+                m2 /= m; m3 /= m; m4 /= m; tt /= m; tv /= m;
+
+                s.mean(i) = mean;
+                s.variance(i) = m2;
+                s.skew(i) = m3/sqrt(pow(m2, 3));
+                s.kurtosis(i) = m4/pow(m2, 2);
+                s.min(i) = lo;
+                s.max(i) = hi;
+                s.slope(i) = tt > NEAR_ZERO ? tv/tt : 0;
+                s.recent(i) = x[last];
+
+                // the median last, since it reorders v
+                size_t h = m/2;
+                std::nth_element(v.begin(), v.begin() + h, v.end());
+                if (m % 2 == 0)
+                {
+                    float upper = v[h];
+                    s.median(i) = 
+                        (upper + *std::max_element(v.begin(), v.begin() + h))
+                        / 2;
+                }
+                else
+                    s.median(i) = v[h];
+            }
+            return s;
+        }
+
+        LongVars flatten(const LongData& Z)
+        {
+            LongVars vars;
+            for (const auto& z : Z)
+                vars.emplace(z.first, LongVar(z.second));
+            return vars;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#ifndef LONGITUDINAL_H
+#define LONGITUDINAL_H
+
+#include <string>
+#include <Eigen/Dense>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+
+using std::vector;
+using Eigen::ArrayXf;
+using Eigen::Map;
+typedef std::map<std::string,
+                 std::pair<vector<ArrayXf>, vector<ArrayXf>>
+                > LongData;
+
+namespace FT
+{
+    namespace Dat{
+        /*!
+         * @class LongStats
+         * @brief aggregates of each sample of a longitudinal variable, as
+         * computed by the longitudinal nodes. values and times are limited
+         * first, as in Node::limited(), except for recent.
+         */
+        struct LongStats
+        {
+            ArrayXf count;              ///< number of values
+            ArrayXf mean;
+            ArrayXf variance;
+            ArrayXf skew;
+            ArrayXf kurtosis;
+            ArrayXf min;
+            ArrayXf max;
+            ArrayXf median;
+            ArrayXf slope;              ///< slope of values over time
+            ArrayXf recent;             ///< value at the latest time
+        };
+
+        /*!
+         * @class LongVar
+         * @brief one longitudinal variable stored flat, in CSR layout.
+         *
+         * The values and times of sample i are the entries
+         * [offsets[i], offsets[i+1]) of values and times, so the whole
+         * variable lives in three allocations instead of two per sample.
+         */
+        struct LongVar
+        {
+            ArrayXf values;             ///< values of all samples in order
+            ArrayXf times;              ///< times of the values
+            vector<size_t> offsets;     ///< n_samples+1 offsets into values
+
+            LongVar();
+
+            /// flattens one entry of LongData
+            explicit LongVar(
+                    const std::pair<vector<ArrayXf>, vector<ArrayXf>>& z);
+
+            /// number of samples
+            size_t size() const
+            {
+                return offsets.empty() ? 0 : offsets.size() - 1;
+            }
+
+            /// number of values of sample i
+            size_t count(size_t i) const
+            {
+                return offsets[i+1] - offsets[i];
+            }
+
+            /// values of sample i, in place
+            Map<const ArrayXf> value(size_t i) const
+            {
+                return Map<const ArrayXf>(values.data() + offsets[i],
+                                          count(i));
+            }
+
+            /// times of sample i, in place
+            Map<const ArrayXf> time(size_t i) const
+            {
+                return Map<const ArrayXf>(times.data() + offsets[i],
+                                          count(i));
+            }
+
+            /// the samples in idx, in that order
+            LongVar gather(const vector<size_t>& idx) const;
+
+            /// samples [start, start+n)
+            LongVar slice(size_t start, size_t n) const;
+
+            /// the variable as an entry of LongData
+            std::pair<vector<ArrayXf>, vector<ArrayXf>> unflatten() const;
+
+            /// aggregates of every sample, computed on the first call and
+            /// shared by every program that reads them. values and times
+            /// must not change afterwards; gather() and slice() start over.
+            const LongStats& stats() const;
+
+            private:
+                /// computed aggregates, shared by copies of the variable
+                struct Cache
+                {
+                    std::once_flag once;
+                    LongStats stats;
+                };
+                std::shared_ptr<Cache> cache;
+        };
+
+        /// computes the aggregates of each sample of z in one pass over
+        /// its values
+        LongStats aggregate(const LongVar& z);
+
+        /// longitudinal variables by name
+        typedef std::map<std::string, LongVar> LongVars;
+
+        /// flattens every variable of Z
+        LongVars flatten(const LongData& Z);
+
+        /*!
+         * @class LongView
+         * @brief a borrowed view of a LongVar, as pushed onto the
+         * longitudinal stack. copying it copies a pointer.
+         */
+        class LongView
+        {
+            public:
+                LongView(const LongVar* var = nullptr) : var(var) {}
+
+                size_t size() const { return var->size(); }
+                size_t count(size_t i) const { return var->count(i); }
+                Map<const ArrayXf> value(size_t i) const
+                {
+                    return var->value(i);
+                }
+                Map<const ArrayXf> time(size_t i) const
+                {
+                    return var->time(i);
+                }
+                const LongStats& stats() const { return var->stats(); }
+
+            private:
+                const LongVar* var;
+        };
+    }
+}
+
+#endif
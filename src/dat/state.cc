@@ -44,6 +44,33 @@ namespace FT
                         zs.size() >= arity.at('z'));
         }
         
+        void State::allocate(const std::map<char, size_t>& stack_size, 
+                size_t N)
+        {
+            f.reserve(stack_size.at('f'));
+            c.reserve(stack_size.at('c'));
+            b.reserve(stack_size.at('b'));
+            
+            for (unsigned i = 0; i < stack_size.at('f'); ++i)
+                f.at(i).resize(N);
+            for (unsigned i = 0; i < stack_size.at('c'); ++i)
+                c.at(i).resize(N);
+            for (unsigned i = 0; i < stack_size.at('b'); ++i)
+                b.at(i).resize(N);
+        }
+        
+        void State::clear()
+        {
+            f.clear();
+            b.clear();
+            c.clear();
+            z.clear();
+            fs.clear();
+            bs.clear();
+            cs.clear();
+            zs.clear();
+        }
+        
         void Trace::copy_to_trace(State& state, std::map<char, 
                 unsigned int> &arity)
         {
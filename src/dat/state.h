@@ -15,6 +15,7 @@ license: GNU/GPL v3
 #include <vector>
 #include <map>
 #include <iostream>
+#include "longitudinal.h"
 
 using std::vector;
 using Eigen::MatrixXf;
@@ -38,7 +39,8 @@ namespace FT
         class Stack
         {
             private:
-                std::vector<type> st;               ///< vector representing the stack
+                std::vector<type> st;               ///< slots holding the stack elements
+                unsigned int idx;                   ///< number of elements on the stack
                 
             public:
             
@@ -46,49 +48,61 @@ namespace FT
                 Stack()
                 {
                     st = std::vector<type>();
+                    idx = 0;
                 }
                 
-                ///< population pushes element at back of vector
-                void push(type element){ st.push_back(element); }
-                
-                ///< pops element from back of vector and removes it
-                type pop()
-                {
-                    type ret = st.back();
-                    st.pop_back();
-                    return ret;
+                /*!
+                 * pushes element onto the stack. slots left behind by pop()
+                 * are overwritten in place, so their storage is reused. 
+                 */
+                template <typename E> void push(const E& element)
+                { 
+                    if (idx < st.size())
+                        st[idx] = element;
+                    else
+                        st.emplace_back(element);
+                    ++idx;
                 }
                 
+                /*!
+                 * pops element from the stack. the returned reference points
+                 * into the stack's storage and is valid until the next push.
+                 */
+                type& pop(){ return st.at(--idx); }
+                
                 ///< returns true or false depending on stack is empty or not
-                bool empty(){ return st.empty(); }
+                bool empty(){ return idx == 0; }
                 
                 ///< returns size of stack
-                unsigned int size(){ return st.size(); }
+                unsigned int size(){ return idx; }
                 
                 ///< returns top element of stack
-                type& top(){ return st.back(); }
+                type& top(){ return st.at(idx-1); }
                 
                 ///< returns element at particular location in stack
                 type& at(int i){ return st.at(i); }
                 
                 type& operator[](int i){ return at(i); }
                 
-                void resize(int i){ st.resize(i); };
+                void resize(int i){ st.resize(i); idx = i; };
+                
+                ///< makes sure at least i slots are available
+                void reserve(unsigned int i){ if (st.size() < i) st.resize(i); }
                 
-                ///< clears the stack
-                void clear(){ st.clear(); }
+                ///< clears the stack, keeping the slots for reuse
+                void clear(){ idx = 0; }
                 
                 ///< returns start iterator of stack
                 typename vector<type>::iterator begin(){ return st.begin(); }
                 
                 ///< returns end iterator of stack
-                typename vector<type>::iterator end(){ return st.end(); }
+                typename vector<type>::iterator end(){ return st.begin() + idx; }
                 
                 ///< returns const start iterator of stack
                 typename vector<type>::const_iterator begin() const{ return st.begin(); }
                 
                 ///< returns const iterator of stack
-                typename vector<type>::const_iterator end() const{ return st.end(); }
+                typename vector<type>::const_iterator end() const{ return st.begin() + idx; }
                 
                 ~Stack(){}
         };
@@ -103,7 +117,7 @@ namespace FT
             Stack<ArrayXf> f;                   ///< floating node stack
             Stack<ArrayXb> b;                   ///< boolean node stack
             Stack<ArrayXi> c;                   ///<categorical stack
-            Stack<std::pair<vector<ArrayXf>, vector<ArrayXf> > > z;     ///< longitudinal node stack
+            Stack<LongView> z;                  ///< longitudinal node stack
             Stack<string> fs;                   ///< floating node string stack
             Stack<string> bs;                   ///< boolean node string stack
             Stack<string> cs;                   ///< categorical node string stack
@@ -120,12 +134,13 @@ namespace FT
                 return get<Eigen::Array<T,Eigen::Dynamic,1> >();
             }
             
-            template <typename T> void push(Eigen::Array<T,Eigen::Dynamic,1>  value)
+            template <typename T, typename Derived> 
+            void push(const Eigen::DenseBase<Derived>& value)
             {
-                get<T>().push(value);
+                get<T>().push(value.derived());
             }
 
-            template <typename T> Eigen::Array<T,Eigen::Dynamic,1>  pop()
+            template <typename T> Eigen::Array<T,Eigen::Dynamic,1>& pop()
             {
                 return get<T>().pop();
             }
@@ -150,6 +165,13 @@ namespace FT
                 return get<T>().size();
             }
             
+            /// reserves stack slots of length N for a program with the
+            /// given maximum stack sizes
+            void allocate(const std::map<char, size_t>& stack_size, size_t N);
+            
+            /// empties the stacks, keeping their storage for reuse
+            void clear();
+            
         };
         
         template <> inline Stack<ArrayXf>& State::get(){ return f; }
@@ -165,7 +187,7 @@ namespace FT
             Eigen::Array<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> f;
             Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> c;
             Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>  b;
-            Stack<std::pair<vector<ArrayXf>, vector<ArrayXf> > > z;
+            Stack<LongView> z;
             Stack<string> fs;
             Stack<string> cs;
             Stack<string> bs;
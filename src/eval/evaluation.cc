@@ -29,15 +29,18 @@ namespace FT{
             if (offspring) 
                 start = individuals.size()/2;
 
-            // loop through individuals
-            /* #pragma omp parallel for */
+            // loop through individuals. predictions don't change the 
+            // programs, and each model is locked while it predicts, so 
+            // individuals are validated in parallel. program sizes vary, 
+            // so they are handed out one at a time.
+            #pragma omp parallel for schedule(dynamic)
             for (unsigned i = start; i<individuals.size(); ++i)
             {
                 Individual& ind = individuals.at(i);
                 
                 // if there is no validation data,
                 // set fitness_v to fitness and return
-                if (d.X.cols() == 0) 
+                if (d.n_samples() == 0) 
                 {
                     ind.fitness_v = ind.fitness;
                     continue;
@@ -45,12 +48,12 @@ namespace FT{
 
                 bool pass = true;
 
-                logger.log("Validating ind " + to_string(i) 
+                LOG("Validating ind " + to_string(i) 
                         + ", id: " + to_string(ind.id), 3);
 
                 shared_ptr<CLabels> yhat =  ind.predict(d);
                 // assign aggregate fitness
-                logger.log("Assigning fitness to ind " + to_string(i) 
+                LOG("Assigning fitness to ind " + to_string(i) 
                         + ", eqn: " + ind.get_eqn(), 3);
 
                 if (!pass)
@@ -97,30 +100,40 @@ namespace FT{
             /*     /1*     << individuals.at(i).program_str() << endl; *1/ */
             /* } */
             
+            // backprop only changes the individual it runs on, so weights 
+            // are tuned in parallel. each individual gets its own random 
+            // stream, drawn here in order so that the results don't depend 
+            // on the number of threads.
+            vector<unsigned> bp_seeds;
+            std::unique_ptr<const AutoBackProp> backprop;
+            if (params.backprop)
+            {
+                backprop.reset(new AutoBackProp(params.scorer_, 
+                            params.bp.iters, params.bp.learning_rate));
+                for (unsigned i = start; i<individuals.size(); ++i)
+                    bp_seeds.push_back(r.rnd_int(0, 
+                                std::numeric_limits<int>::max()));
+            }
+
             // loop through individuals
-            #pragma omp parallel for
+            #pragma omp parallel for schedule(dynamic)
             for (unsigned i = start; i<individuals.size(); ++i)
             {
                 Individual& ind = individuals.at(i);
 
                 if (params.backprop)
                 {
-                    #pragma omp critical
-                    {
-                    AutoBackProp backprop(params.scorer_, params.bp.iters, 
-                            params.bp.learning_rate);
-                    logger.log("Running backprop on " + ind.get_eqn(), 3);
-                    backprop.run(ind, d, params);
-                    }         
+                    LOG("Running backprop on " + ind.get_eqn(), 3);
+                    backprop->run(ind, d, params, bp_seeds.at(i-start));
                 }
                 bool pass = true;
 
-                logger.log("Running ind " + to_string(i) 
+                LOG("Running ind " + to_string(i) 
                         + ", id: " + to_string(ind.id), 3);
 
                 shared_ptr<CLabels> yhat =  ind.fit(d,params,pass); 
                 // assign F and aggregate fitness
-                logger.log("Assigning fitness to ind " + to_string(i) 
+                LOG("Assigning fitness to ind " + to_string(i) 
                         + ", eqn: " + ind.get_eqn(), 3);
 
                 if (!pass)
@@ -193,10 +206,125 @@ namespace FT{
                 ind.error = loss;
             }
                 
-            logger.log("ind " + std::to_string(ind.id) + " fitness: " 
+            LOG("ind " + std::to_string(ind.id) + " fitness: " 
                     + std::to_string(ind.fitness),3);
         }
 
+        void Evaluation::downsample(vector<Individual>& individuals, 
+                const Data& d, Data& ds, const Parameters& params)
+        {
+            /*!
+             * Individuals are refit and scored once on the sampled cases,
+             * which replaces their fitness and errors. Offspring are then 
+             * fit on ds as well, so the whole generation is compared by 
+             * its training loss on the same cases.
+             */
+            size_t N = d.y.size();
+            size_t n = std::max(size_t(1), size_t(params.downsample*N));
+
+            if (params.informed_downsample)
+                cases = informed_cases(individuals, d, params, n);
+            else
+            {
+                cases.resize(N);
+                std::iota(cases.begin(), cases.end(), 0);
+                r.shuffle(cases.begin(), cases.end());
+                cases.resize(n);
+            }
+            std::sort(cases.begin(), cases.end());
+
+            LOG("scoring population on " + to_string(n) + " of " 
+                    + to_string(N) + " cases", 3);
+            d.view_cases(ds, cases);
+
+            #pragma omp parallel for schedule(dynamic)
+            for (unsigned i = 0; i<individuals.size(); ++i)
+            {
+                Individual& ind = individuals.at(i);
+                bool pass = ind.fitness != MAX_FLT;
+                shared_ptr<CLabels> yhat;
+                if (pass)
+                    yhat = ind.fit(ds, params, pass);
+                if (!pass)
+                {
+                    ind.fitness = MAX_FLT;
+                    ind.error = MAX_FLT*VectorXf::Ones(n);
+                    continue;
+                }
+                assign_fit(ind, yhat, ds, params);
+            }
+        }
+
+        vector<size_t> Evaluation::informed_cases(
+                vector<Individual>& individuals, const Data& d, 
+                const Parameters& params, size_t n)
+        {
+            // number of individuals whose errors inform the sample
+            const size_t n_informers = 10;
+            // bound on candidates times chosen cases, which is the number
+            // of distances the traversal computes per informer
+            const size_t max_distances = size_t(1) << 24;
+
+            // candidate cases, drawn at random
+            size_t N = d.y.size();
+            size_t m = std::min(N, std::max(n, max_distances/n));
+            vector<size_t> candidates(N);
+            std::iota(candidates.begin(), candidates.end(), 0);
+            r.shuffle(candidates.begin(), candidates.end());
+            candidates.resize(m);
+            if (m == n)
+                return candidates;
+
+            vector<size_t> informers(individuals.size());
+            std::iota(informers.begin(), informers.end(), 0);
+            r.shuffle(informers.begin(), informers.end());
+            informers.resize(std::min(n_informers, informers.size()));
+
+            // errors of the informers on the candidates. failed and 
+            // non-finite losses count as MAX_FLT, so distances are never
+            // NaN.
+            MatrixXf X;
+            VectorXf y;
+            LongData Z;
+            Data dc(X, y, Z, d.classification);
+            d.view_cases(dc, candidates);
+            MatrixXf E = MatrixXf::Constant(informers.size(), m, MAX_FLT);
+            #pragma omp parallel for
+            for (unsigned j = 0; j<informers.size(); ++j)
+            {
+                Individual& ind = individuals.at(informers.at(j));
+                if (ind.fitness == MAX_FLT)
+                    continue;
+                shared_ptr<CLabels> yhat = ind.predict(dc);
+                VectorXf loss;
+                S.score(dc.y, yhat, loss, params.class_weights);
+                for (unsigned k = 0; k < m; ++k)
+                    if (std::isfinite(loss(k)))
+                        E(j,k) = loss(k);
+            }
+
+            // farthest-first traversal: each case is the one with the 
+            // largest distance to its nearest chosen case
+            vector<size_t> chosen;
+            vector<bool> taken(m, false);
+            ArrayXf dist = ArrayXf::Constant(m, 
+                    std::numeric_limits<float>::infinity());
+            size_t c = r.rnd_int(0, m-1);
+            while (chosen.size() < n)
+            {
+                chosen.push_back(candidates[c]);
+                taken[c] = true;
+                dist = dist.min((E.colwise() - E.col(c)).cwiseAbs()
+                                .colwise().sum().transpose().array());
+                size_t next = m;
+                for (size_t k = 0; k < m; ++k)
+                    if (!taken[k] && (next == m || dist(k) > dist(next)))
+                        next = k;
+                c = next;
+            }
+            return chosen;
+        }
+
         float Evaluation::marginal_fairness(VectorXf& loss, const Data& d, 
                 float base_score, bool use_alpha)
         {
@@ -212,10 +340,10 @@ namespace FT{
             {
                 for (const auto& lvl : pl.second)
                 {
-                    x_idx = (d.X.row(pl.first).array() == lvl);
+                    x_idx = (d.feature(pl.first) == lvl);
                     float len_g = x_idx.count();
                     if (use_alpha)
-                        alpha = len_g/d.X.cols();
+                        alpha = len_g/d.n_samples();
                     /* cout << "alpha = " << len_g << "/" 
                      * << d.X.cols() << endl; */
                     float Beta = fabs(base_score - 
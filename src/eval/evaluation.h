@@ -71,7 +71,25 @@ namespace FT{
                         const Data& d, 
                         const Parameters& params,bool val=false);       
 
+                /// draws a fraction params.downsample of the cases of d, 
+                /// makes ds a view of them, and refits and scores the 
+                /// individuals on ds. the generation is then fit and 
+                /// selected on ds.
+                void downsample(vector<Individual>& individuals, 
+                        const Data& d, Data& ds, const Parameters& params);
+
                 Scorer S;
+
+                /// samples of d in the last down-sample
+                vector<size_t> cases;
+
+            private:
+                /// cases chosen one at a time to be as far as possible 
+                /// from the ones before, by the errors of a few individuals
+                /// on a bounded pool of candidate cases
+                vector<size_t> informed_cases(
+                        vector<Individual>& individuals, const Data& d,
+                        const Parameters& params, size_t n);
         };
     }
 }
@@ -44,6 +44,16 @@ void Feat::init()
 }
 
 void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
+{
+    fit(X, y, Dat::flatten(Z));
+}
+
+void Feat::fit(MatrixXf& X, VectorXf& y, const string& z_path)
+{
+    fit(X, y, Util::load_longitudinal_records(z_path).by_index());
+}
+
+void Feat::fit(MatrixXf& X, VectorXf& y, Dat::LongVars Z)
 {
 
     /*! 
@@ -66,10 +76,69 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
      *	   7. select surviving individuals from parents and offspring
      */
     this->init();
+    params.init(X, y);       
+
+    // normalize data
+    if (params.normalize)
+    {
+        N.fit_normalize(X,params.dtypes);                   
+    }
+    LongData none;
+    Data data(X, y, none, params.classification, params.protected_groups);
+    data.set_longitudinal(std::move(Z));
+    fit_data(data);
+}
+
+void Feat::fit_columnar(const string& path, LongData& Z)
+{
+    fit_columnar(path, Dat::flatten(Z));
+}
+
+void Feat::fit_columnar(const string& path, const string& z_path)
+{
+    fit_columnar(path, Util::load_longitudinal_records(z_path).by_index());
+}
+
+void Feat::fit_columnar(const string& path, Dat::LongVars Z)
+{
+    this->init();
+    VectorXf y;
+    RowMatrixXf X_fm;
+    {
+        Util::ColumnarFile f(path);
+        if (!f.has_target())
+            THROW_INVALID_ARGUMENT(path + " has no target to fit");
+        y = f.y();
+        if (params.dtypes.empty())
+            params.dtypes = f.get_dtypes();
+        if (params.get_feature_names().empty())
+            params.set_feature_names(Util::ravel(f.get_names()));
+        // the columns are copied straight into the features of data, and
+        // the file is unmapped before training
+        f.read(X_fm, 0);
+    }
+    params.init(y);
+
+    if (params.normalize)
+        N.fit_normalize(X_fm, params.dtypes);
+    MatrixXf X;
+    LongData none;
+    Data data(X, y, none, params.classification, params.protected_groups);
+    data.set_features(std::move(X_fm));
+    data.set_longitudinal(std::move(Z));
+    fit_data(data);
+}
+
+void Feat::fit_columnar(const string& path)
+{
+    fit_columnar(path, Dat::LongVars());
+}
+
+void Feat::fit_data(Data& data)
+{
     std::ofstream log;                      ///< log file stream
     if (!logfile.empty())
         log.open(logfile, std::ofstream::app);
-    params.init(X, y);       
 
     string FEAT;
     if (params.verbosity == 1)
@@ -94,15 +163,15 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
 
     if (params.use_batch)
     {
-        if (params.bp.batch_size >= X.cols())
+        if (params.bp.batch_size >= data.n_samples())
         {
-            logger.log("turning off batch because X has fewer than " 
+            LOG("turning off batch because X has fewer than " 
                     + to_string(params.bp.batch_size) + " samples", 1);
             params.use_batch = false;
         }
         else
         {
-            logger.log("using batch with batch_size= " 
+            LOG("using batch with batch_size= " 
                     + to_string(params.bp.batch_size), 2);
         }
     }
@@ -119,15 +188,10 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
     // }
     
 
-    logger.log(FEAT,1);
+    LOG(FEAT,1);
     
     this->archive.set_objectives(params.objectives);
 
-    // normalize data
-    if (params.normalize)
-    {
-        N.fit_normalize(X,params.dtypes);                   
-    }
     this->pop = Population(params.pop_size);
     this->evaluator = Evaluation(params.scorer_);
 
@@ -140,19 +204,17 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
     /*     use_arch = true; */
     use_arch = false;
 
-    logger.log("scorer: " + params.scorer_, 1);
+    LOG("scorer: " + params.scorer_, 1);
 
     // split data into training and test sets
-    //Data data(X, y, Z, params.classification);
-    DataRef d(X, y, Z, params.classification, params.protected_groups);
-    //DataRef d;
-    //d.setOriginalData(&data);
+    DataRef d;
+    d.setOriginalData(&data);
     d.train_test_split(params.shuffle, params.split);
     // define terminals based on size of X
-    params.set_terminals(d.o->X.rows(), d.o->Z);        
+    params.set_terminals(d.o->n_features(), d.o->get_longitudinal());
 
     // initial model on raw input
-    logger.log("Setting up data", 2);
+    LOG("Setting up data", 2);
     float t0 =  timer.Elapsed().count();
     
     //data for batch training
@@ -176,29 +238,31 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
 
     // initialize population 
     ////////////////////////
-    logger.log("Initializing population", 2);
+    LOG("Initializing population", 2);
    
     bool random = selector.get_type() == "random";
 
     // initial model
     ////////////////
-    logger.log("Fitting initial model", 2);
+    LOG("Fitting initial model", 2);
     t0 =  timer.Elapsed().count();
     initial_model(d);  
-    logger.log("Initial fitting took " 
+    LOG("Initial fitting took " 
             + std::to_string(timer.Elapsed().count() - t0) + " seconds",2);
 
     // initialize population with initial model and/or starting pop
     pop.init(best_ind,params,random, this->starting_pop);
-    logger.log("Initial population:\n"+pop.print_eqns(),3);
+    LOG("Initial population:\n"+pop.print_eqns(),3);
 
     // evaluate initial population
-    logger.log("Evaluating initial population",2);
+    LOG("Evaluating initial population",2);
+    subtree_cache.set_budget(params.cache_size);
+    subtree_cache.set_data(*d.t);
     evaluator.fitness(pop.individuals,*d.t,params);
     evaluator.validation(pop.individuals,*d.v,params);
     
-    logger.log("Initial population done",2);
-    logger.log(std::to_string(timer.Elapsed().count()) + " seconds",2);
+    LOG("Initial population done",2);
+    LOG(std::to_string(timer.Elapsed().count()) + " seconds",2);
     
     vector<size_t> survivors;
     
@@ -233,6 +297,9 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
             if (params.classification)
                 params.set_sample_weights(dbr.t->y); 
 
+            // cached outputs belong to the previous batch
+            subtree_cache.set_data(*dbr.t);
+
             run_generation(g, survivors, dbr, log, fraction, stall_count);
         }
         else
@@ -243,16 +310,18 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
         g++;
     }
     // =====================
+    subtree_cache.clear();
+
     if ( params.max_stall != 0 && stall_count >= params.max_stall)
-        logger.log("learning stalled",2);
+        LOG("learning stalled",2);
     else if ( g >= params.gens) 
-        logger.log("generation limit reached",2);
+        LOG("generation limit reached",2);
     else
-        logger.log("max time reached",2);
+        LOG("max time reached",2);
 
-    logger.log("train score: " + std::to_string(this->min_loss), 2);
-    logger.log("validation score: " + std::to_string(min_loss_v), 2);
-    logger.log("fitting final model to all training data...",2);
+    LOG("train score: " + std::to_string(this->min_loss), 2);
+    LOG("validation score: " + std::to_string(min_loss_v), 2);
+    LOG("fitting final model to all training data...",2);
 
 
     // simplify the final model
@@ -283,11 +352,11 @@ void Feat::fit(MatrixXf& X, VectorXf& y, LongData& Z)
         log.close();
 
     set_is_fitted(true);
-    logger.log("Run Completed. Total time taken is " 
+    LOG("Run Completed. Total time taken is " 
             + std::to_string(timer.Elapsed().count()) + " seconds", 1);
-    logger.log("best model: " + this->get_eqn(),1);
-    logger.log("tabular model:\n" + this->get_model(),2);
-    logger.log("/// ----------------------------------------------------------------- \\\\\\",
+    LOG("best model: " + this->get_eqn(),1);
+    LOG("tabular model:\n" + this->get_model(),2);
+    LOG("/// ----------------------------------------------------------------- \\\\\\",
             1);
 
 }
@@ -578,17 +647,10 @@ int Feat::get_complexity(){
 /// return the number of nodes in the best model
 int Feat::get_n_nodes(){ return best_ind.program.size(); }
 
-///return population as string
-vector<json> Feat::get_archive(bool front)
+vector<Individual*> Feat::archive_models(bool front)
 {
-    /* TODO: maybe this should just return the to_json call of
-     * the underlying population / archive. I guess the problem
-     * is that we don't have to_json defined for vector<Individual>.
-     */
     vector<Individual>* printed_pop = NULL; 
 
-    string r = "";
-
     vector<size_t> idx;
     bool subset = false;
     if (front)  // only return individuals on the Pareto front
@@ -616,20 +678,12 @@ vector<json> Feat::get_archive(bool front)
 
     bool includes_best_ind = false;
 
-    vector<json> json_archive;
-
+    vector<Individual*> models;
     for (int i = 0; i < idx.size(); ++i)
     {
         Individual& ind = printed_pop->at(idx[i]); 
+        models.push_back(&ind);
 
-        json j;
-        to_json(j, ind);
-
-        // r += j.dump();
-        json_archive.push_back(j);
-
-        if (i < idx.size() -1)
-            r += "\n";
         // check if best_ind is in here
         if (ind.id == best_ind.id)
             includes_best_ind = true;
@@ -637,19 +691,46 @@ vector<json> Feat::get_archive(bool front)
 
     // add best_ind, if it is not included
     if (!includes_best_ind) 
+        models.push_back(&best_ind);
+
+    return models;
+}
+
+///return population as string
+vector<json> Feat::get_archive(bool front)
+{
+    vector<json> json_archive;
+
+    for (const auto& ind : archive_models(front))
     {
         json j;
-        to_json(j, best_ind);
+        to_json(j, *ind);
         json_archive.push_back(j);
     }
-
-    // delete pop pointer
-    printed_pop = NULL;
-    delete printed_pop;
     
     return json_archive;
 }
 
+vector<unsigned> Feat::get_archive_ids(bool front)
+{
+    vector<unsigned> ids;
+    for (const auto& ind : archive_models(front))
+        ids.push_back(ind->id);
+    return ids;
+}
+
+Pop::Predictor Feat::get_predictor()
+{
+    return Pop::Predictor(best_ind, params.num_features,
+                          params.normalize ? &N : nullptr);
+}
+
+string Feat::export_cpp(const string& name)
+{
+    return best_ind.export_cpp(params.num_features,
+                               params.normalize ? &N : nullptr, name);
+}
+
 /// return the coefficients or importance scores of the best model. 
 ArrayXf Feat::get_coefs()
 {
@@ -672,8 +753,7 @@ std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf>>> Feat::get_Z(string
             
 void Feat::fit(MatrixXf& X, VectorXf& y)
 {
-    auto Z = LongData();
-    fit(X,y,Z);
+    fit(X, y, Dat::LongVars());
 }
 
 
@@ -688,38 +768,57 @@ void Feat::run_generation(unsigned int g,
 
     params.set_current_gen(g);
 
+    // draw this generation's cases for lexicase selection. the population
+    // is scored, selected and fit on a view of them. fair lexicase 
+    // selects on groups of samples, so it always uses all of them.
+    MatrixXf Xs;
+    VectorXf ys;
+    LongData Zs;
+    Data ds(Xs, ys, Zs, d.t->classification, d.t->protect);
+    const Data* dt = d.t;
+    string sel = selector.get_type();
+    if (params.downsample < 1 && sel.find("lexicase") != string::npos 
+            && sel != "fair_lexicase")
+    {
+        LOG("down-sampling cases...", 2);
+        evaluator.downsample(pop.individuals, *d.t, ds, params);
+        dt = &ds;
+        if (params.classification)
+            params.set_sample_weights(ds.y); 
+    }
+
     // select parents
-    logger.log("selection..", 2);
-    vector<size_t> parents = selector.select(pop, params, *d.t);
-    logger.log("parents:\n"+pop.print_eqns(), 3);          
+    LOG("selection..", 2);
+    vector<size_t> parents = selector.select(pop, params, *dt);
+    LOG("parents:\n"+pop.print_eqns(), 3);          
     
     // variation to produce offspring
-    logger.log("variation...", 2);
-    variator.vary(pop, parents, params,*d.t);
-    logger.log("offspring:\n" + pop.print_eqns(true), 3);
+    LOG("variation...", 2);
+    variator.vary(pop, parents, params,*dt);
+    LOG("offspring:\n" + pop.print_eqns(true), 3);
 
     // evaluate offspring
-    logger.log("evaluating offspring...", 2);
-    evaluator.fitness(pop.individuals, *d.t, params, true);
+    LOG("evaluating offspring...", 2);
+    evaluator.fitness(pop.individuals, *dt, params, true);
     evaluator.validation(pop.individuals, *d.v, params, true);
 
     // select survivors from combined pool of parents and offspring
-    logger.log("survival...", 2);
-    survivors = survivor.survive(pop, params, *d.t);
+    LOG("survival...", 2);
+    survivors = survivor.survive(pop, params, *dt);
    
     // reduce population to survivors
-    logger.log("shrinking pop to survivors...",2);
+    LOG("shrinking pop to survivors...",2);
     pop.update(survivors);
-    logger.log("survivors:\n" + pop.print_eqns(), 3);
+    LOG("survivors:\n" + pop.print_eqns(), 3);
     
     // we need to update best, so min_loss_v is updated inside stats
-    logger.log("update best...",2);
+    LOG("update best...",2);
     bool updated_best = update_best(d);
 
     if (params.max_stall > 0)
         update_stall_count(stall_count, updated_best);
 
-    logger.log("update objectives...",2);
+    LOG("update objectives...",2);
     if ( (use_arch || params.verbosity>1) || !logfile.empty()) {
         // set objectives to make sure they are reported in log/verbose/arch
         #pragma omp parallel for
@@ -727,10 +826,10 @@ void Feat::run_generation(unsigned int g,
             pop.individuals.at(i).set_obj(params.objectives);
     }
 
-    logger.log("calculate stats...",2);
+    LOG("calculate stats...",2);
     calculate_stats(d);
 
-    logger.log("update archive...",2);
+    LOG("update archive...",2);
     if (use_arch) 
         archive.update(pop,params);
     
@@ -751,10 +850,10 @@ void Feat::run_generation(unsigned int g,
     {
         params.bp.learning_rate = \
             (1-1/(1+float(params.gens)))*params.bp.learning_rate;
-        logger.log("learning rate: " 
+        LOG("learning rate: " 
                 + std::to_string(params.bp.learning_rate),3);
     }
-    logger.log("finished with generation...",2);
+    LOG("finished with generation...",2);
 
 }
 
@@ -770,7 +869,7 @@ void Feat::update_stall_count(unsigned& stall_count, bool best_updated)
         ++stall_count;
     }
 
-    logger.log("stall count: " + std::to_string(stall_count), 2);
+    LOG("stall count: " + std::to_string(stall_count), 2);
 }
 
 
@@ -787,7 +886,7 @@ void Feat::final_model(DataRef& d)
     /* params.set_sample_weights(y);   // need to set new sample weights for y, */ 
                                     // which is probably from a validation set
     float score = evaluator.S.score(d.o->y,yhat,tmp,params.class_weights);
-    logger.log("final_model score: " + std::to_string(score),2);
+    LOG("final_model score: " + std::to_string(score),2);
 }
 
 void Feat::simplify_model(DataRef& d, Individual& ind)
@@ -810,8 +909,8 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
     vector<size_t> roots = tmp_ind.program.roots();
     vector<size_t> idx_to_remove;
 
-    logger.log("\n=========\ndoing pattern pruning...",2);
-    logger.log("simplify: " + to_string(this->simplify), 2);
+    LOG("\n=========\ndoing pattern pruning...",2);
+    LOG("simplify: " + to_string(this->simplify), 2);
 
     for (auto r : roots)
     {
@@ -849,14 +948,15 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
         /*     << " at " << idx << "\n"; */
         tmp_ind.program.erase(tmp_ind.program.begin()+idx);
     }
+    tmp_ind.program.update_structure();
     int end_size = tmp_ind.size();
-    logger.log("pattern pruning reduced best model size by " 
+    LOG("pattern pruning reduced best model size by " 
             + to_string(starting_size - end_size)
             + " nodes\n=========\n", 2);
     if (tmp_ind.size() < ind.size())
     {
         ind = tmp_ind;
-        logger.log("new model:" + this->get_ind_eqn(false, ind),2);
+        LOG("new model:" + this->get_ind_eqn(false, ind),2);
     }
 
     ///////////////////
@@ -864,7 +964,7 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
     ///////////////////
     /* set_verbosity(3); */
     int iterations = ind.get_dim();
-    logger.log("\n=========\ndoing correlation deletion mutations...",2);
+    LOG("\n=========\ndoing correlation deletion mutations...",2);
     starting_size = ind.size();
     VectorXf original_yhat;
     if (params.classification && params.n_classes==2)
@@ -896,19 +996,19 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
                 <= this->simplify ) 
                 or perfect_correlation)
         {
-            logger.log("\ndelete dimension mutation success: went from "
+            LOG("\ndelete dimension mutation success: went from "
                 + to_string(ind.size()) + " to " 
                 + to_string(tmp_ind.size()) + " nodes. Output changed by " 
                  + to_string(100*(original_yhat
                         -new_yhat).norm()/(original_yhat.norm()))
                  + " %", 2); 
             if (perfect_correlation)
-                logger.log("perfect correlation",2);
+                LOG("perfect correlation",2);
             ind = tmp_ind;
         }
         else
         {
-            logger.log("\ndelete dimension mutation failure. Output changed by " 
+            LOG("\ndelete dimension mutation failure. Output changed by " 
                  + to_string(100*(original_yhat
                         -new_yhat).norm()/(original_yhat.norm()))
                  + " %", 2);
@@ -919,17 +1019,17 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
 
     }
     end_size = ind.size();
-    logger.log("correlation pruning reduced best model size by " 
+    LOG("correlation pruning reduced best model size by " 
             + to_string(starting_size - end_size)
             + " nodes\n=========\n", 2);
     if (end_size < starting_size)
-        logger.log("new model:" + this->get_ind_eqn(false, ind),2);
+        LOG("new model:" + this->get_ind_eqn(false, ind),2);
 
     /////////////////
     // prune subtrees
     /////////////////
     iterations = 1000;
-    logger.log("\n=========\ndoing subtree deletion mutations...", 2);
+    LOG("\n=========\ndoing subtree deletion mutations...", 2);
     starting_size = ind.size();
     for (int i = 0; i < iterations; ++i)
     {
@@ -949,7 +1049,7 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
         if ((original_yhat - new_yhat).norm()/original_yhat.norm() 
                 <= this->simplify )
         {
-            logger.log("\ndelete mutation success: went from "
+            LOG("\ndelete mutation success: went from "
                 + to_string(ind.size()) + " to " 
                 + to_string(tmp_ind.size()) + " nodes. Output changed by " 
                  + to_string(100*(original_yhat
@@ -959,7 +1059,7 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
         }
         else
         {
-            logger.log("\ndelete mutation failure. Output changed by " 
+            LOG("\ndelete mutation failure. Output changed by " 
                  + to_string(100*(original_yhat
                         -new_yhat).norm()/(original_yhat.norm()))
                  + " %", 2);
@@ -970,7 +1070,7 @@ void Feat::simplify_model(DataRef& d, Individual& ind)
 
     }
     end_size = ind.size();
-    logger.log("subtree deletion reduced best model size by " 
+    LOG("subtree deletion reduced best model size by " 
             + to_string( starting_size - end_size )
             + " nodes", 2);
     VectorXf new_yhat;
@@ -996,24 +1096,25 @@ vector<float> Feat::univariate_initial_model(DataRef &d, int n_feats)
      * 4) construct a program of dimensionality n_feats using 
      * the largest magnitude coefficients
      */
-    vector<float> univariate_weights(d.t->X.rows() + d.t->Z.size(),0.0);
-    int N = d.t->X.cols();
+    vector<float> univariate_weights(
+            d.t->n_features() + d.t->get_longitudinal().size(),0.0);
+    int N = d.t->n_samples();
 
     MatrixXf predictor(1,N);    
     string ml_type = this->params.classification? 
         "LR" : "LinearRidgeRegression";
     
-    ML ml = ML(ml_type,params.normalize,params.classification,params.n_classes);
+    ML ml(ml_type,params.normalize,params.classification,params.n_classes);
 
     bool pass = true;
 
-    logger.log("univariate_initial_model",2);
-    logger.log("N: " + to_string(N),2); 
-    logger.log("n_feats: " + to_string(n_feats),2);
+    LOG("univariate_initial_model",2);
+    LOG("N: " + to_string(N),2); 
+    LOG("n_feats: " + to_string(n_feats),2);
 
-    for (unsigned i =0; i<d.t->X.rows(); ++i)
+    for (unsigned i =0; i<d.t->n_features(); ++i)
     {
-        predictor.row(0) = d.t->X.row(i);
+        predictor.row(0) = d.t->feature(i).matrix().transpose();
         /* float b =  (covariance(predictor,d.t->y) / */ 
         /*             variance(predictor)); */
         pass = true;
@@ -1024,11 +1125,11 @@ vector<float> Feat::univariate_initial_model(DataRef &d, int n_feats)
         else
             univariate_weights.at(i) = 0;
     }
-    int j = d.t->X.rows();
-    for (const auto& val: d.t->Z)
+    int j = d.t->n_features();
+    for (const auto& val: d.t->get_longitudinal())
     {
         for (int k = 0; k<N; ++k)
-            predictor(k) = median(val.second.second.at(k));
+            predictor(k) = median(val.second.time(k));
 
         /* float b =  (covariance(predictor,d.t->y) / */ 
         /*             variance(predictor)); */
@@ -1056,8 +1157,8 @@ void Feat::initial_model(DataRef &d)
     best_ind = Individual();
     best_ind.set_id(0);
     int j; 
-    int n_x = d.t->X.rows();
-    int n_z = d.t->Z.size();
+    int n_x = d.t->n_features();
+    int n_z = d.t->get_longitudinal().size();
     int n_feats = std::min(params.max_dim, unsigned(n_x+ n_z));
     /* int n_long_feats = std::min(params.max_dim - n_feats, */ 
     /*         unsigned(d.t->Z.size())); */
@@ -1104,6 +1205,7 @@ void Feat::initial_model(DataRef &d)
                     std::unique_ptr<Node>(new NodeMedian()));
         }
     }
+    best_ind.program.update_structure();
     // fit model
 
     shared_ptr<CLabels> yhat;
@@ -1141,9 +1243,9 @@ void Feat::initial_model(DataRef &d)
     
     this->best_complexity = best_ind.get_complexity();
 
-    logger.log("initial model: " + this->get_eqn(), 2);
-    logger.log("initial training score: " +std::to_string(min_loss),2);
-    logger.log("initial validation score: " +std::to_string(this->min_loss_v),2);
+    LOG("initial model: " + this->get_eqn(), 2);
+    LOG("initial training score: " +std::to_string(min_loss),2);
+    LOG("initial validation score: " +std::to_string(this->min_loss_v),2);
 }
 
 MatrixXf Feat::transform(MatrixXf& X)
@@ -1273,6 +1375,116 @@ ArrayXXf Feat::predict_proba_archive(int id, MatrixXf& X, LongData& Z)
     return ArrayXXf();
     
 }
+/// outputs of each of models on d. the programs are compiled into one 
+/// bytecode, so subtrees the models share are evaluated once. the outputs
+/// are empty if the programs can't be compiled.
+static vector<MatrixXf> archive_outputs(const vector<Individual*>& models,
+                                        const Data& d)
+{
+    NodeVector programs;
+    vector<int> n_roots;
+    for (const auto m : models)
+    {
+        for (const auto& n : m->program)
+        {
+            programs.push_back(n->clone());
+            if (n->isNodeTrain())
+                dynamic_cast<NodeTrain*>(programs.back().get())->train = false;
+        }
+        n_roots.push_back(m->program.root_types().size());
+    }
+
+    vector<MatrixXf> Phi(models.size());
+    Bytecode bc(programs, false);
+    if (!bc.compiled)
+        return Phi;
+    // Phi holds the roots in program order, so each model's are adjacent
+    MatrixXf all = bc.run(d);
+    for (size_t i = 0, row = 0; i < models.size(); row += n_roots[i++])
+        Phi[i] = all.middleRows(row, n_roots[i]);
+    return Phi;
+}
+
+/// runs f(i) for each of n models in parallel. exceptions can't leave an
+/// omp region, so the first one is rethrown afterward.
+template<class F>
+static void for_each_model(size_t n, F f)
+{
+    string error;
+    #pragma omp parallel for schedule(dynamic)
+    for (unsigned i = 0; i < n; ++i)
+    {
+        try
+        {
+            f(i);
+        }
+        catch (const std::exception& e)
+        {
+            #pragma omp critical
+            if (error.empty())
+                error = e.what();
+        }
+    }
+
+    if (!error.empty())
+        THROW_RUNTIME_ERROR(error);
+}
+
+MatrixXf Feat::predict_archive_batch(MatrixXf& X, bool front)
+{
+    LongData Z;
+    return predict_archive_batch(X, Z, front);
+}
+
+MatrixXf Feat::predict_archive_batch(MatrixXf& X, LongData& Z, bool front)
+{
+    if (params.normalize)
+        N.normalize(X);       
+    VectorXf empty_y;
+    Data tmp_data(X,empty_y,Z);
+
+    vector<Individual*> models = archive_models(front);
+    vector<MatrixXf> Phi = archive_outputs(models, tmp_data);
+    MatrixXf predictions(models.size(), X.cols());
+
+    for_each_model(models.size(), 
+            [&](unsigned i){ 
+                predictions.row(i) = Phi[i].size() 
+                    ? models[i]->ml->predict_vector(Phi[i])
+                    : models[i]->predict_vector(tmp_data); 
+            });
+
+    return predictions;
+}
+
+vector<ArrayXXf> Feat::predict_proba_archive_batch(MatrixXf& X, bool front)
+{
+    LongData Z;
+    return predict_proba_archive_batch(X, Z, front);
+}
+
+vector<ArrayXXf> Feat::predict_proba_archive_batch(MatrixXf& X, LongData& Z,
+        bool front)
+{
+    if (params.normalize)
+        N.normalize(X);       
+    VectorXf empty_y;
+    Data tmp_data(X,empty_y,Z);
+
+    vector<Individual*> models = archive_models(front);
+    vector<MatrixXf> Phi = archive_outputs(models, tmp_data);
+    vector<ArrayXXf> probabilities(models.size());
+
+    for_each_model(models.size(), 
+            [&](unsigned i){ 
+                probabilities[i] = Phi[i].size() 
+                    ? models[i]->ml->predict_proba(Phi[i])
+                    : models[i]->predict_proba(tmp_data); 
+            });
+
+    return probabilities;
+}
+
 shared_ptr<CLabels> Feat::predict_labels(MatrixXf& X, LongData Z)
 {        
     /* MatrixXf Phi = transform(X, Z); */
@@ -1300,6 +1512,153 @@ ArrayXXf Feat::predict_proba(MatrixXf& X)
 }
 
 
+/// reads chunks with read and hands eval's result on each to write, in order.
+/// up to one chunk per thread is read and then evaluated in parallel, or
+/// one at a time if eval isn't thread safe.
+template<class R, class Eval, class Write>
+static void stream_chunks(const ChunkReader& read, size_t chunk_size,
+                          bool parallel, Eval eval, Write write)
+{
+    if (chunk_size == 0)
+        THROW_INVALID_ARGUMENT("chunk_size must be positive");
+
+    const int T = parallel ? omp_get_max_threads() : 1;
+    vector<MatrixXf> X(T);
+    vector<LongData> Z(T);
+    vector<R> out(T);
+
+    for (bool done = false; !done; )
+    {
+        int k = 0;
+        for (; k < T; ++k)
+        {
+            Z.at(k).clear();
+            size_t n = read(X.at(k), Z.at(k), chunk_size);
+            if (n == 0)
+            {
+                done = true;
+                break;
+            }
+            if (n > chunk_size || X.at(k).cols() != n)
+                THROW_LENGTH_ERROR("the reader returned " 
+                        + to_string(X.at(k).cols()) + " samples for a chunk "
+                        "of " + to_string(n) + " (at most " 
+                        + to_string(chunk_size) + ")");
+        }
+
+        string error;
+        #pragma omp parallel for if(k > 1)
+        for (int i = 0; i < k; ++i)
+        {
+            try
+            {
+                out.at(i) = eval(X.at(i), Z.at(i));
+            }
+            catch (const std::exception& e)
+            {
+                #pragma omp critical
+                if (error.empty())
+                    error = e.what();
+            }
+        }
+        if (!error.empty())
+            THROW_RUNTIME_ERROR(error);
+
+        for (int i = 0; i < k; ++i)
+            write(out.at(i));
+    }
+}
+
+void Feat::predict_stream(const ChunkReader& read, 
+        const std::function<void(const VectorXf&)>& write, size_t chunk_size)
+{
+    // the flattened predictor is immutable, so chunks can share it. 
+    // programs it can't hold go through predict(), one chunk at a time.
+    Pop::Predictor predictor;
+    bool flat = true;
+    try { predictor = get_predictor(); }
+    catch (const std::exception&) { flat = false; }
+
+    stream_chunks<VectorXf>(read, chunk_size, flat, 
+            [&](MatrixXf& X, LongData& Z){ 
+                return flat ? predictor.predict(X) : predict(X, Z); },
+            write);
+}
+
+void Feat::predict_proba_stream(const ChunkReader& read, 
+        const std::function<void(const ArrayXXf&)>& write, size_t chunk_size)
+{
+    Pop::Predictor predictor;
+    bool flat = true;
+    try { predictor = get_predictor(); }
+    catch (const std::exception&) { flat = false; }
+    flat = flat && predictor.has_probabilities();
+
+    stream_chunks<ArrayXXf>(read, chunk_size, flat, 
+            [&](MatrixXf& X, LongData& Z) -> ArrayXXf { 
+                if (flat)
+                    return predictor.predict_proba(X).transpose().array();
+                return predict_proba(X, Z); },
+            write);
+}
+
+void Feat::transform_stream(const ChunkReader& read, 
+        const std::function<void(const MatrixXf&)>& write, size_t chunk_size)
+{
+    if (best_ind.program.size()==0)
+        THROW_RUNTIME_ERROR("You need to train a model using fit() "
+                "before making predictions.");
+
+    // compiled programs only read the bytecode, so chunks run in parallel
+    Bytecode bc(best_ind.program);
+
+    stream_chunks<MatrixXf>(read, chunk_size, bc.compiled, 
+            [&](MatrixXf& X, LongData& Z) -> MatrixXf { 
+                if (!bc.compiled)
+                    return transform(X, Z);
+                if (params.normalize)
+                    N.normalize(X);       
+                VectorXf y;
+                Data d(X, y, Z, get_classification());
+                return bc.run(d).transpose(); },
+            write);
+}
+
+void Feat::predict_file(const string& path, const string& out_path,
+        size_t chunk_size, char sep)
+{
+    // columnar files are read in place, csv files line by line
+    unique_ptr<Util::ColumnarFile> columns;
+    unique_ptr<Util::CSVReader> csv;
+    size_t next = 0;
+    if (Util::is_columnar(path))
+        columns.reset(new Util::ColumnarFile(path));
+    else
+        csv.reset(new Util::CSVReader(path, sep));
+
+    size_t F = columns ? columns->n_features() : csv->get_names().size();
+    if (F != params.num_features)
+        THROW_LENGTH_ERROR(path + " has " + to_string(F) + " features, not " 
+                + to_string(params.num_features));
+
+    std::ofstream out(out_path);
+    if (!out.good())
+        THROW_INVALID_ARGUMENT("Invalid output file " + out_path + "\n"); 
+    out.precision(std::numeric_limits<float>::max_digits10);
+
+    predict_stream(
+            [&](MatrixXf& X, LongData&, size_t n){ 
+                if (!columns)
+                    return csv->read(X, n);
+                n = columns->read(X, next, n);
+                next += n;
+                return n; },
+            [&](const VectorXf& y){ 
+                for (int i = 0; i < y.size(); ++i)
+                    out << y(i) << "\n"; },
+            chunk_size);
+}
+
 bool Feat::update_best(const DataRef& d, bool validation)
 {
     float f; 
@@ -1323,11 +1682,11 @@ bool Feat::update_best(const DataRef& d, bool validation)
                 /* ind.clone(best_ind); */
                 this->best_complexity = ind.get_complexity();
                 updated = true;
-                logger.log("better model found!", 2);
+                LOG("better model found!", 2);
             }
         }
     }
-    logger.log("current best model: " + this->get_eqn(), 2);
+    LOG("current best model: " + this->get_eqn(), 2);
 
     return updated;
 }
@@ -1500,7 +1859,10 @@ void Feat::calculate_stats(const DataRef& d)
                  max_tests_used,
                  min_threshold,
                  med_threshold,
-                 max_threshold);
+                 max_threshold,
+                 subtree_cache.hits(),
+                 subtree_cache.misses());
+    subtree_cache.reset_counters();
 }
 
 void Feat::print_stats(std::ofstream& log, float fraction)
@@ -1541,6 +1903,9 @@ void Feat::print_stats(std::ofstream& log, float fraction)
               << stats.min_loss_v.back() << " (" << stats.med_loss_v.back() << ")\n"
               << "Median Size (Max): " 
               << stats.med_size.back() << " (" << max_size << ")\n"
+              << "Cache Hits (Misses): " 
+              << stats.cache_hits.back() << " (" 
+              << stats.cache_misses.back() << ")\n"
               << "Time (s): "   << timer << "\n";
     std::cout << "Representation Pareto Front--------------------------------------\n";
     std::cout << "Rank\t"; //Complexity\tLoss\tRepresentation\n";
@@ -1636,7 +2001,9 @@ void Feat::log_stats(std::ofstream& log)
             << "min_threshold"  << sep
             << "med_threshold"  << sep
             << "max_threshold"  << sep
-            << "med_dim"        << "\n";
+            << "med_dim"        << sep
+            << "cache_hits"     << sep
+            << "cache_misses"   << "\n";
     }
     log << params.current_gen          << sep
         << timer.Elapsed().count()     << sep
@@ -1653,7 +2020,9 @@ void Feat::log_stats(std::ofstream& log)
         << stats.min_threshold.back()  << sep
         << stats.med_threshold.back()  << sep
         << stats.max_threshold.back()  << sep
-        << stats.med_dim.back()        << "\n"; 
+        << stats.med_dim.back()        << sep
+        << stats.cache_hits.back()     << sep
+        << stats.cache_misses.back()   << "\n"; 
 }
 
 //TODO: replace these with json
@@ -1700,7 +2069,7 @@ void Feat::load_from_file(string filename)
 
     this->load(line);
 
-    logger.log("Loaded Feat state from " + filename,1);
+    LOG("Loaded Feat state from " + filename,1);
 
     indata.close();
 }
@@ -1715,5 +2084,5 @@ void Feat::save_to_file(string filename)
 
     out << this->save();
     out.close();
-    logger.log("Saved Feat to file " + filename, 1);
+    LOG("Saved Feat to file " + filename, 1);
 }
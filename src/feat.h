@@ -9,6 +9,7 @@ license: GNU/GPL v3
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <functional>
 #include <shogun/base/init.h>
  
 // internal includes
@@ -17,6 +18,7 @@ license: GNU/GPL v3
 #include "util/logger.h"
 #include "util/utils.h"
 #include "util/io.h"
+#include "util/columnar.h"
 #include "params.h"
 #include "pop/population.h"
 #include "sel/selection.h"
@@ -25,6 +27,8 @@ license: GNU/GPL v3
 #include "model/ml.h"
 #include "pop/op/node.h"
 #include "pop/archive.h" 
+#include "pop/predictor.h"
+#include "pop/cache.h"
 #include "pop/op/longitudinal/n_median.h"
 
 #ifdef USE_CUDA
@@ -60,6 +64,10 @@ using namespace Vary;
 
 ////////////////////////////////////////////////////////////////// Declarations
 
+/// fills X with up to n samples, one per column, and Z with their 
+/// longitudinal data. returns the number of samples read; 0 ends the stream.
+typedef std::function<size_t(MatrixXf& X, LongData& Z, size_t n)> ChunkReader;
+
 /*!
  * @class Feat
  * @brief main class for the Feat learner.
@@ -292,6 +300,20 @@ class Feat
         bool get_tune_final(){ return this->params.tune_final;};
         void set_tune_final(bool in){ this->params.tune_final = in;};
 
+        /// size of the subtree output cache in bytes. 0 turns it off.
+        size_t get_cache_size(){ return this->params.cache_size;};
+        void set_cache_size(size_t in){ this->params.cache_size = in;};
+
+        /// fraction of training cases lexicase selects on each generation
+        float get_downsample(){ return this->params.downsample;};
+        void set_downsample(float in){ this->params.downsample = in;};
+
+        /// pick down-sampled cases that rank individuals differently
+        bool get_informed_downsample(){ 
+            return this->params.informed_downsample;};
+        void set_informed_downsample(bool in){ 
+            this->params.informed_downsample = in;};
+
         /// get objectives for multi-objective search
         auto get_objectives(){return params.get_objectives(); };  
         /// set objectives for multi-objective search
@@ -328,6 +350,8 @@ class Feat
         int get_complexity();
         ///return population as string
         vector<nl::json> get_archive(bool front);
+        /// return the ids of the models in get_archive(front), in order
+        vector<unsigned> get_archive_ids(bool front);
         /// return the coefficients or importance scores of the best model. 
         ArrayXf get_coefs();
         /// return the number of nodes in the best model
@@ -341,6 +365,21 @@ class Feat
         /// train a model.             
         void fit(MatrixXf& X, VectorXf& y);
         void fit(MatrixXf& X, VectorXf& y, LongData& Z);
+        /// train a model with longitudinal variables stored flat. the 
+        /// LongData overload flattens Z and calls this one.
+        void fit(MatrixXf& X, VectorXf& y, Dat::LongVars Z);
+        /// train a model with the longitudinal variables of the file at
+        /// z_path, whose ids are 0 ... n-1 (see load_longitudinal()). 
+        /// they are read straight into flat storage.
+        void fit(MatrixXf& X, VectorXf& y, const string& z_path);
+
+        /// train a model on a columnar file (see csv_to_columnar()). its 
+        /// columns are copied straight into feature-major order, without 
+        /// an n_features x n_samples matrix in between.
+        void fit_columnar(const string& path);
+        void fit_columnar(const string& path, LongData& Z);
+        void fit_columnar(const string& path, Dat::LongVars Z);
+        void fit_columnar(const string& path, const string& z_path);
                         
         void run_generation(unsigned int g,
                         vector<size_t> survivors,
@@ -359,6 +398,39 @@ class Feat
         ArrayXXf predict_proba_archive(int id, MatrixXf& X, LongData& Z);
         ArrayXXf predict_proba_archive(int id, MatrixXf& X);
 
+        /// predict on unseen data from every model in get_archive(front).
+        /// X is normalized once, and the programs are compiled into one 
+        /// bytecode so that subtrees shared by the models, at any depth, 
+        /// are evaluated once. returns n_models x n_samples.
+        MatrixXf predict_archive_batch(MatrixXf& X, bool front=false);
+        MatrixXf predict_archive_batch(MatrixXf& X, LongData& Z, 
+                bool front=false);
+        /// probabilities of every model in get_archive(front), as in 
+        /// predict_proba_archive()
+        vector<ArrayXXf> predict_proba_archive_batch(MatrixXf& X, 
+                bool front=false);
+        vector<ArrayXXf> predict_proba_archive_batch(MatrixXf& X, 
+                LongData& Z, bool front=false);
+
+        /// predict on a stream of samples read chunk_size at a time. chunks 
+        /// are evaluated in parallel and the predictions handed to write in 
+        /// order, so memory stays bounded by a chunk per thread.
+        void predict_stream(const ChunkReader& read, 
+                const std::function<void(const VectorXf&)>& write,
+                size_t chunk_size=65536);
+        /// predict_proba() on a stream of samples, as in predict_stream()
+        void predict_proba_stream(const ChunkReader& read, 
+                const std::function<void(const ArrayXXf&)>& write,
+                size_t chunk_size=65536);
+        /// transform() on a stream of samples, as in predict_stream()
+        void transform_stream(const ChunkReader& read, 
+                const std::function<void(const MatrixXf&)>& write,
+                size_t chunk_size=65536);
+        /// predict on the samples of a csv file laid out as for fitting, or
+        /// of a columnar file, writing one prediction per line to out_path
+        void predict_file(const string& path, const string& out_path,
+                size_t chunk_size=65536, char sep=',');
+
         /// predict on unseen data. return CLabels.
         shared_ptr<CLabels> predict_labels(MatrixXf& X, LongData Z = LongData());  
 
@@ -366,6 +438,14 @@ class Feat
         ArrayXXf predict_proba(MatrixXf& X, LongData& Z);  
         ArrayXXf predict_proba(MatrixXf& X);
 
+        /// export the best model for low latency inference. the predictor
+        /// normalizes raw samples itself. longitudinal data isn't supported.
+        Pop::Predictor get_predictor();
+
+        /// C++ header source that computes predict() for single samples
+        /// and batches without depending on Feat.
+        string export_cpp(const string& name="feat_model");
+
         /// transform an input matrix using a program.                          
         MatrixXf transform(MatrixXf& X);
         MatrixXf transform(MatrixXf& X, LongData& Z);
@@ -407,6 +487,7 @@ class Feat
         Variation variator;  	///< variation operators
         Selection survivor;       	///< survival algorithm
         Archive archive;          ///< pareto front archive
+        SubtreeCache subtree_cache; ///< subtree outputs on the data in use
         bool use_arch;         ///< internal control over use of archive
         string survival;                        ///< stores survival mode
         Normalizer N;                           ///< scales training data.
@@ -425,6 +506,13 @@ class Feat
         Log_Stats stats; ///< runtime stats
 
         /* functions */
+        /// trains on data, once params are set up and its features are 
+        /// normalized
+        void fit_data(Data& data);
+
+        /// the models returned by get_archive(front)
+        vector<Individual*> archive_models(bool front);
+
         /// updates best score
         bool update_best(const DataRef& d, bool validation=false);    
         
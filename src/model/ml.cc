@@ -63,7 +63,7 @@ ML::ML(string ml, bool norm, bool classification, int n_classes)
        )
     {
         this->normalize = true;
-        logger.log("Using ML normalization since a linear method was specified",
+        LOG("Using ML normalization since a linear method was specified",
                    3);
     }
 }
@@ -335,7 +335,7 @@ shared_ptr<CLabels> ML::fit(const MatrixXf& X, const VectorXf& y,
     if(_X.isZero(0.0001))
     {
 
-        logger.log("Setting labels to zero since features are zero\n", 
+        LOG("Setting labels to zero since features are zero\n", 
                 3);
 
         shared_ptr<CLabels> labels;
@@ -386,7 +386,7 @@ shared_ptr<CLabels> ML::fit(const MatrixXf& X, const VectorXf& y,
                     SGVector<float64_t>(_y)));
     
     // train ml
-    logger.log("ML training on thread " 
+    LOG("ML training on thread " 
                + std::to_string(omp_get_thread_num()) + "...",3," ");
     // *** Train the model ***  
     try
@@ -395,16 +395,16 @@ shared_ptr<CLabels> ML::fit(const MatrixXf& X, const VectorXf& y,
     }
     catch (...)
     {
-        logger.log("Shogun failed to train",3);
+        LOG("Shogun failed to train",3);
     }
 
-    logger.log("done!",3);
+    LOG("done!",3);
    
     // transpose features back
     if (ml_type == L1_LR && this->prob_type==PT_BINARY)
         features = features->get_transposed();
 
-    logger.log("exiting ml::fit",3); 
+    LOG("exiting ml::fit",3); 
     auto y_pred = this->retrieve_labels(features, true, pass);
     features->free_features();
     return y_pred; 
@@ -422,18 +422,18 @@ VectorXf ML::fit_vector(const MatrixXf& X, const VectorXf& y,
 
 shared_ptr<CLabels> ML::predict(const MatrixXf& X, bool print)
 {
-    logger.log("ML::predict...",3);
+    LOG("ML::predict...",3);
     shared_ptr<CLabels> labels;
-    logger.log("X size: " + to_string(X.rows()) + "x" + to_string(X.cols()),3);
+    LOG("X size: " + to_string(X.rows()) + "x" + to_string(X.cols()),3);
     MatrixXd _X = X.template cast<double>();
-    logger.log("cast X to double",3);
+    LOG("cast X to double",3);
 
     /* Make sure the model fit() method passed by
      * looking for empty weights.
      * If the weights are empty, assign dummy labels. */
     if (get_weights().empty())
     {
-        logger.log("weight empty; returning zeros",3); 
+        LOG("weight empty; returning zeros",3); 
         if (this->prob_type==PT_BINARY) 
         {
             labels = std::shared_ptr<CLabels>(
@@ -476,7 +476,10 @@ shared_ptr<CLabels> ML::predict(const MatrixXf& X, bool print)
     }
 
     /* Otherwise, apply normalization and retrieve labels
-     * from the model. */
+     * from the model. shogun machines hold on to the features they are 
+     * applied to, so copies of an individual sharing this model take 
+     * turns. */
+    std::lock_guard<std::mutex> lock(predict_mutex);
     if (normalize)
         N.normalize(_X);
     
@@ -614,7 +617,7 @@ void ML::set_bias(float b)
 shared_ptr<CLabels> ML::retrieve_labels(CDenseFeatures<float64_t>* features, 
                                    bool proba, bool& pass)
 {
-    logger.log("ML::get_labels",3);
+    LOG("ML::get_labels",3);
     shared_ptr<CLabels> labels;
     SGVector<double> y_pred; 
 
@@ -677,7 +680,7 @@ shared_ptr<CLabels> ML::fit_tune(MatrixXf& X, VectorXf& y,
         const Parameters& params, bool& pass, const vector<char>& dtypes, 
         bool set_default)
 {
-    logger.log("tuning C...",2);
+    LOG("tuning C...",2);
     LongData Z;
     DataRef d_cv(X, y, Z, params.classification, 
             params.protected_groups);
@@ -706,17 +709,19 @@ shared_ptr<CLabels> ML::fit_tune(MatrixXf& X, VectorXf& y,
 
         for (int i = 0; i < n_splits; ++i)
         {
-            logger.log("split " + to_string(i) + "...",3);
+            LOG("split " + to_string(i) + "...",3);
             d_cv.train_test_split(true, 0.8);
+            MatrixXf X_t = d_cv.t->matrix();
+            MatrixXf X_v = d_cv.v->matrix();
 
             for (int j = 0; j< Cs.size(); ++j)
             {
                 this->C = Cs.at(j);
-                this->fit(d_cv.t->X, d_cv.t->y, 
+                this->fit(X_t, d_cv.t->y, 
                         params, pass, this->dtypes);
 
                 losses(j,i) = S.score(d_cv.v->y, 
-                                    this->predict(d_cv.v->X), 
+                                    this->predict(X_v), 
                                     dummy, params.class_weights);
             }
         }
@@ -731,13 +736,13 @@ shared_ptr<CLabels> ML::fit_tune(MatrixXf& X, VectorXf& y,
         float min_loss = mean_loss.minCoeff(&min_index);
         float best_C = Cs.at(min_index);
         cv_report += "best C: " + to_string(best_C) + "\n" ;
-        logger.log(cv_report, 2);
+        LOG(cv_report, 2);
         // set best C and fit a final model to all data with it
         this->C = best_C;
         if (set_default)
         {
             C_DEFAULT.at(this->ml_type) = best_C;
-            logger.log("changing C_DEFAULT: " 
+            LOG("changing C_DEFAULT: " 
                     + to_string(C_DEFAULT[ml_type]), 2);
         }
         return this->fit(X, y, params, pass, dtypes);
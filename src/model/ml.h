@@ -26,6 +26,7 @@ license: GNU/GPL v3
 #include <shogun/machine/LinearMulticlassMachine.h>
 #pragma GCC diagnostic pop
 #include <cmath>
+#include <mutex>
 // internal includes
 #include "shogun/MyCARTree.h"
 #include "shogun/MulticlassLogisticRegression.h"
@@ -147,6 +148,7 @@ class ML
 
     private:
         vector<char> dtypes; 
+        std::mutex predict_mutex;   ///< serializes predictions
 };
 //serialization
 void to_json(json& j, const shared_ptr<ML>& ml);
@@ -1611,6 +1611,56 @@ void CMyCARTree::get_importance(bnode_t* node, vector<double>& importances)
        SG_UNREF(right);
    }
 }
+void CMyCARTree::flatten(std::vector<FlatCARTNode>& nodes, 
+                         std::vector<float64_t>& values)
+{
+    nodes.clear();
+    values.clear();
+
+    bnode_t* root=dynamic_cast<bnode_t*>(get_root());
+    REQUIRE(root, "Tree machine not yet trained.\n");
+    flatten_node(root, nodes, values);
+    SG_UNREF(root);
+}
+
+void CMyCARTree::flatten_node(bnode_t* node, std::vector<FlatCARTNode>& nodes,
+                              std::vector<float64_t>& values)
+{
+    // same certainty as apply_from_current_node()
+    FlatCARTNode n;
+    n.attribute = -1;
+    n.nominal = false;
+    n.right = -1;
+    n.begin = n.end = values.size();
+    n.label = node->data.node_label;
+    n.certainty = (node->data.total_weight-node->data.weight_minus_node)/
+                  node->data.total_weight;
+
+    size_t k = nodes.size();
+    nodes.push_back(n);
+    if (node->data.num_leaves==1)
+        return;
+
+    bnode_t* left=node->left();
+    bnode_t* right=node->right();
+
+    nodes[k].attribute = node->data.attribute_id;
+    nodes[k].nominal = m_nominal[node->data.attribute_id];
+    SGVector<float64_t> comp=left->data.transit_into_values;
+    if (nodes[k].nominal)
+        values.insert(values.end(), comp.vector, comp.vector+comp.vlen);
+    else
+        values.push_back(comp[0]);
+    nodes[k].end = values.size();
+
+    flatten_node(left, nodes, values);
+    nodes[k].right = nodes.size();
+    flatten_node(right, nodes, values);
+
+    SG_UNREF(left);
+    SG_UNREF(right);
+}
+
 // WGL: updated definitions to allow probabilities to be calculated
 void CMyCARTree::set_probabilities(CLabels* labels, CFeatures* data)
 {
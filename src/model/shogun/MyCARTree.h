@@ -43,6 +43,21 @@ using std::vector;
 namespace shogun
 {
 
+    /** WGL: a node of a CART stored in an array, so that the tree can be 
+     * evaluated without shogun. the left child of a split follows it.
+     */
+    struct FlatCARTNode
+    {
+        int32_t attribute;      ///< attribute split on, or -1 at leaves
+        bool nominal;           ///< true if the attribute is nominal
+        int32_t right;          ///< index of the right child
+        /// range of the values in the value pool sending samples left:
+        /// the values of nominal attributes, or the threshold of others
+        int32_t begin, end;
+        float64_t label;        ///< node label
+        float64_t certainty;    ///< fraction of the node weight with its label
+    };
+
 
     class CMyCARTree : public CTreeMachine<MyCARTreeNodeData>
     {
@@ -251,6 +266,12 @@ namespace shogun
         /** WGL: sets the probabilities on each label according to m_certainty
          */
         void set_probabilities(CLabels* labels, CFeatures* data=NULL);  
+
+        /** WGL: copies the tree to nodes, depth first, with the values of
+         * the splits in values
+         */
+        void flatten(std::vector<FlatCARTNode>& nodes, 
+                     std::vector<float64_t>& values);
     protected:
 	    /** train machine - build CART from training data
 	     * @param data training data
@@ -434,6 +455,11 @@ namespace shogun
         /** WGL: recursive function for getting node importance 
          */
         void get_importance(bnode_t* node, vector<double>& importances);
+
+        /** WGL: recursive function for flattening the tree 
+         */
+        void flatten_node(bnode_t* node, std::vector<FlatCARTNode>& nodes, 
+                          std::vector<float64_t>& values);
         
         
     public:
@@ -157,6 +157,15 @@ std::vector<double> CMyRandomForest::feature_importances()
      return importances;
 }
 
+void CMyRandomForest::flatten(int32_t i, std::vector<FlatCARTNode>& nodes, 
+                              std::vector<float64_t>& values)
+{
+    REQUIRE(i>=0 && i<m_num_bags, "no tree %d in the forest\n", i);
+    CMyRandomCARTree* m = dynamic_cast<CMyRandomCARTree*>(m_bags->get_element(i));
+    m->flatten(nodes, values);
+    SG_UNREF(m);
+}
+
 void CMyRandomForest::set_probabilities(CLabels* labels, CFeatures* data)
 {
     SGMatrix<float64_t> output = apply_outputs_without_combination(data);
@@ -33,6 +33,7 @@
 
 #include <shogun/lib/config.h>
 #include <shogun/machine/BaggingMachine.h>
+#include "MyCARTree.h"
 
 #include <vector>
 
@@ -112,6 +113,11 @@ public:
      */
     std::vector<double> feature_importances();
     
+    /** WGL: copies tree i to nodes, as in CMyCARTree::flatten()
+     */
+    void flatten(int32_t i, std::vector<FlatCARTNode>& nodes, 
+                 std::vector<float64_t>& values);
+
     /** WGL: sets the probabilities on each label according to m_certainty
      */
     void set_probabilities(CLabels* labels, CFeatures* data=NULL);  
@@ -39,7 +39,7 @@ namespace FT {
 		    this->a = a;
 	    }
 
-	    void AutoBackProp::print_weights(NodeVector& program) {
+	    void AutoBackProp::print_weights(NodeVector& program) const {
 	        for (const auto& p : program) 
             {
 		        cout << "( " << p->name;
@@ -58,15 +58,24 @@ namespace FT {
         }
 
         void AutoBackProp::run(Individual& ind, const Data& d,
-                                const Parameters& params)
+                                const Parameters& params, unsigned seed) const
         {
             vector<size_t> roots = ind.program.roots();
             float min_loss;
             float current_loss, current_val_loss;
             vector<vector<float>> best_weights;
-            // split up the data so we have a validation set
-            DataRef BP_data(d.X, d.y, d.Z, d.classification);
-            BP_data.train_test_split(true, 0.5);
+            // split up the data so we have a validation set. the folds 
+            // and batches are views of d, so no samples are copied up front.
+            MatrixXf X_t, X_v;
+            VectorXf y_t, y_v;
+            LongData Z_t, Z_v;
+            Data train(X_t, y_t, Z_t, d.classification);
+            Data val(X_v, y_v, Z_v, d.classification);
+            vector<size_t> t_idx, v_idx;
+            std::mt19937 gen(seed);
+            d.split_cases(t_idx, v_idx, 0.5, true, &gen);
+            d.view_cases(train, t_idx);
+            d.view_cases(val, v_idx);
             // set up batch data
             MatrixXf Xb, Xb_v;
             VectorXf yb, yb_v;
@@ -78,28 +87,28 @@ namespace FT {
             /* db_val.set_validation();    // make this a validation set */
             // if batch size is 0, set batch to 20% of training data
             int batch_size = params.bp.batch_size > 0? 
-                params.bp.batch_size : .2*BP_data.t->y.size(); 
+                params.bp.batch_size : .2*train.y.size(); 
             /* d.get_batch(db_val, );     // draw a batch for the validation data */
             // number of iterations to allow validation fitness to not improve
             int patience = 3;               
             int missteps = 0;
 
-            this->epk = n;  // starting learning rate
+            float epk = n;  // starting learning rate
             /* logger.log("running backprop on " + ind.get_eqn(), 2); */
             /* cout << ind.get_eqn() << endl; */
-            logger.log("=========================",4);
-            logger.log("Iteration,Train Loss,Val Loss,Weights",4);
-            logger.log("=========================",4);
+            LOG("=========================",4);
+            LOG("Iteration,Train Loss,Val Loss,Weights",4);
+            LOG("=========================",4);
             for (int x = 0; x < this->iters; x++)
             {
-                logger.log("get batch",3);
+                LOG("get batch",3);
                 // get batch data for training
-                BP_data.t->get_batch(batch_data, batch_size); 
+                train.get_batch(batch_data, batch_size); 
                 /* cout << "batch_data.y: " */ 
                 /*      << batch_data.y.transpose() << "\n"; */ 
                 // Evaluate forward pass
                 MatrixXf Phi; 
-                logger.log("forward pass",3);
+                LOG("forward pass",3);
                 vector<Trace> stack_trace = forward_prop(ind, batch_data, 
                         Phi, params);
                 // Evaluate ML model on Phi
@@ -107,7 +116,7 @@ namespace FT {
                 auto ml = std::make_shared<ML>(params.ml, true, 
                         params.classification, params.n_classes);
 
-                logger.log("ml fit",3);
+                LOG("ml fit",3);
                 shared_ptr<CLabels> yhat = ml->fit(Phi,
                         batch_data.y,params,pass,ind.dtypes);
                 
@@ -135,17 +144,17 @@ namespace FT {
                     backprop(stack_trace.at(i), ind.program, 
                             ind.program.subtree(roots.at(s)), 
                             roots.at(s), Beta.at(s), // /ml->N.scale.at(s), 
-                            yhat, batch_data, params.class_weights);
+                            yhat, batch_data, params.class_weights, epk);
                 }
 
                 // check validation fitness for early stopping
-                MatrixXf Phival = ind.out((*BP_data.v));
-                logger.log("checking validation fitness",3);
+                MatrixXf Phival = ind.out(val);
+                LOG("checking validation fitness",3);
                 /* cout << "Phival: " << Phival.rows() 
                  * << " x " << Phival.cols() << "\n"; */
                 /* cout << "y_val\n"; */
                 shared_ptr<CLabels> y_val = ml->predict(Phival);
-                current_val_loss = this->cost_func(BP_data.v->y, y_val, 
+                current_val_loss = this->cost_func(val.y, y_val, 
                         params.class_weights).mean();
                 if (x==0 || current_val_loss < min_loss)
                 {
@@ -156,7 +165,7 @@ namespace FT {
                 {
                     ++missteps;
                     /* cout << "missteps: " << missteps << "\n"; */
-                    logger.log("",3);           // update learning rate
+                    LOG("",3);           // update learning rate
                 }
                 // early stopping trigger
                 if (missteps == patience 
@@ -165,13 +174,13 @@ namespace FT {
                         || min_loss <= NEAR_ZERO)       
                     break;
                 else
-                    logger.log("min loss: " + std::to_string(min_loss), 3);
+                    LOG("min loss: " + std::to_string(min_loss), 3);
 
                 float alpha = float(x)/float(iters);
 
-                this->epk = (1 - alpha)*this->epk + alpha*this->epT;  
-                /* this->epk = this->epk + this->epT; */ 
-                /* cout << "epk: " << this->epk << "\n"; */
+                epk = (1 - alpha)*epk + alpha*this->epT;  
+                /* epk = epk + this->epT; */ 
+                /* cout << "epk: " << epk << "\n"; */
                 if (params.verbosity>3)
                 {
                     cout << x << "," 
@@ -180,16 +189,17 @@ namespace FT {
                      print_weights(ind.program);
                 }
             }
-            logger.log("",4);
-            logger.log("=========================",4);
-            logger.log("done=====================",4);
-            logger.log("=========================",4);
+            LOG("",4);
+            LOG("=========================",4);
+            LOG("done=====================",4);
+            LOG("=========================",4);
             ind.program.set_weights(best_weights);
         }
         
         // forward pass
         vector<Trace> AutoBackProp::forward_prop(Individual& ind, const Data& d,
-                                                 MatrixXf& Phi, const Parameters& params) 
+                                                 MatrixXf& Phi, 
+                                                 const Parameters& params) const
         {
             /* cout << "Forward pass\n"; */
             // Iterate through all the nodes evaluating and tracking ouputs
@@ -202,7 +212,7 @@ namespace FT {
         }   
         // Updates stacks to have proper value on top
         void AutoBackProp::next_branch(vector<BP_NODE>& executing, vector<Node*>& bp_program, 
-                                       vector<ArrayXf>& derivatives) 
+                                       vector<ArrayXf>& derivatives) const
         {
             // While there are still nodes with branches to explore
             if(!executing.empty()) {
@@ -235,7 +245,7 @@ namespace FT {
         void AutoBackProp::backprop(Trace& stack, NodeVector& program, int start, int end, 
                                     float Beta, shared_ptr<CLabels>& yhat, 
                                     const Data& d,
-                                    vector<float> sw)    
+                                    vector<float> sw, float epk) const
         {
             /* cout << "Backward pass \n"; */
             vector<ArrayXf> derivatives;
@@ -273,7 +283,7 @@ namespace FT {
                         dNode->derivative(n_derivatives, stack, i);
                     }
                     /* cout << "updating derivatives\n"; */
-                    dNode->update(derivatives, stack, this->epk, this->a);
+                    dNode->update(derivatives, stack, epk, this->a);
                     // dNode->print_weight();
                     /* cout << "popping input arguments\n"; */
                     // Get rid of the input arguments for the node
@@ -73,9 +73,12 @@ namespace FT {
                     
             AutoBackProp(string scorer, int iters=1000, float n=0.1, float a=0.9); 
 
-            /// adapt weights
+            /// adapt weights. run() only changes ind, so individuals can 
+            /// be adapted in parallel. the data split draws from a 
+            /// generator seeded with seed, so results don't depend on 
+            /// the thread doing the work.
 		    void run(Individual& ind, const Data& d,
-                     const Parameters& params);
+                     const Parameters& params, unsigned seed) const;
 
             /* ~AutoBackProp() */
             /* { */
@@ -91,24 +94,24 @@ namespace FT {
             callback cost_func;         //< cost function pointer
             
             int iters;                  //< iterations
-            float epk;                 //< current learning rate 
             float epT;                  //< min learning rate
 
-		    void print_weights(NodeVector& program);
+		    void print_weights(NodeVector& program) const;
 		
 		    /// Return the f_stack
 		    vector<Trace> forward_prop(Individual& ind, const Data& d,
-                                   MatrixXf& Phi, const Parameters& params);
+                                   MatrixXf& Phi, 
+                                   const Parameters& params) const;
 
 		    /// Updates stacks to have proper value on top
 		    void next_branch(vector<BP_NODE>& executing, vector<Node*>& bp_program, 
-                             vector<ArrayXf>& derivatives);
+                             vector<ArrayXf>& derivatives) const;
 
-            /// Compute gradients and update weights 
+            /// Compute gradients and update weights with learning rate epk
             void backprop(Trace& f_stack, NodeVector& program, int start, int end, 
                                     float Beta, shared_ptr<CLabels>& yhat, 
                                     const Data& d,
-                                   vector<float> sw);
+                                   vector<float> sw, float epk) const;
                                    
             /// Compute gradients and update weights 
             void backprop2(Trace& f_stack, NodeVector& program, int start, int end, 
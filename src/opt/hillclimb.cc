@@ -24,7 +24,7 @@ namespace FT {
 
         }
         
-        shared_ptr<CLabels> HillClimb::run(Individual& ind, Data d,
+        shared_ptr<CLabels> HillClimb::run(Individual& ind, const Data& d,
                      const Parameters& params, bool& updated)
         {
             updated = false;    // keep track of whether we update this individual
@@ -54,7 +54,7 @@ namespace FT {
                 if (!anychanges)    // then there are no weighted nodes, so break
                     break;
                 // evaluate perturbed program 
-                logger.log("Generating output for " + tmp.get_eqn(), 3);
+                LOG("Generating output for " + tmp.get_eqn(), 3);
 
                 bool pass = true;
 
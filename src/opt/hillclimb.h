@@ -42,7 +42,7 @@ namespace FT {
             HillClimb(string scorer, int iters=1, float step=0.1);
 
             /// adapt weights
-		    shared_ptr<CLabels> run(Individual& ind, Data d,
+		    shared_ptr<CLabels> run(Individual& ind, const Data& d,
                      const Parameters& params, bool& updated);
 
         private:
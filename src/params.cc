@@ -80,10 +80,17 @@ Parameters::Parameters()
  *  for classification, check clases and find number.
  */
 void Parameters::init(const MatrixXf& X, const VectorXf& y)
+{
+    if (this->dtypes.size()==0)    // set feature types if not set
+        this->dtypes = find_dtypes(X);
+    init(y);
+}
+
+void Parameters::init(const VectorXf& y)
 {
     if (ml == "LinearRidgeRegression" && classification)
     {
-        logger.log("Setting ML type to LR",2);
+        LOG("Setting ML type to LR",2);
         ml = "LR";            
     }
     if (this->classification)  // setup classification endpoint
@@ -91,8 +98,6 @@ void Parameters::init(const MatrixXf& X, const VectorXf& y)
        this->set_classes(y);       
     } 
     
-    if (this->dtypes.size()==0)    // set feature types if not set
-        this->dtypes = find_dtypes(X);
     if (this->verbosity >= 2)
     {
         cout << "X data types: ";
@@ -103,6 +108,10 @@ void Parameters::init(const MatrixXf& X, const VectorXf& y)
         cout << "\n";
     }
     this->set_scorer("", true);
+
+    if (this->downsample <= 0 || this->downsample > 1)
+        THROW_INVALID_ARGUMENT("downsample must be in (0, 1]; got " 
+                + std::to_string(this->downsample));
 }
 
 /// sets current generation
@@ -137,7 +146,7 @@ void Parameters::set_scorer(string sc, bool initialized)
         scorer_ = sc;
 
     if (tmp != this->scorer_)
-        logger.log("scorer changed to " + scorer_,2);
+        LOG("scorer changed to " + scorer_,2);
 }
 
 /// sets weights for terminals. 
@@ -197,7 +206,7 @@ void Parameters::set_term_weights(const vector<float>& w)
                     + "], "); 
         }
         weights += "\n";
-        logger.log(weights, 2);
+        LOG(weights, 2);
     }
 }
 
@@ -248,7 +257,7 @@ void Parameters::set_otypes(bool terminals_set)
             // if terminals are all boolean, remove floating point functions
             if (ttypes.size()==1 && ttypes.at(0)=='b')
             {
-                logger.log(string("otypes is size 1 and otypes[0]==b\n") 
+                LOG(string("otypes is size 1 and otypes[0]==b\n") 
                         + string("setting otypes to boolean...\n"),
                         2);
                 /* size_t n = functions.size(); */
@@ -276,7 +285,7 @@ void Parameters::set_otypes(bool terminals_set)
                 }
                 if (only_floating_ops == functions.size())
                 {
-                    logger.log(string("all terminal and function types are float") 
+                    LOG(string("all terminal and function types are float") 
                         + string("setting otype='f'...\n"),
                         2);
                     otype='f';
@@ -403,7 +412,7 @@ void Parameters::set_protected_groups(string pg)
         for (auto pg : protected_groups)
             msg += pg + ",";
         msg += "\n";
-        logger.log(msg,2);
+        LOG(msg,2);
     }
 }
 string Parameters::get_protected_groups()
@@ -657,6 +666,22 @@ void Parameters::set_op_weights()
 }
 
 void Parameters::set_terminals(int nf, const LongData& Z)
+{
+    vector<string> names;
+    for (const auto &val : Z)
+        names.push_back(val.first);
+    set_terminals(nf, names);
+}
+
+void Parameters::set_terminals(int nf, const Dat::LongVars& Z)
+{
+    vector<string> names;
+    for (const auto &val : Z)
+        names.push_back(val.first);
+    set_terminals(nf, names);
+}
+
+void Parameters::set_terminals(int nf, const vector<string>& longitudinal)
 {
     terminals.clear();
     num_features = nf; 
@@ -674,10 +699,10 @@ void Parameters::set_terminals(int nf, const LongData& Z)
         }        
     }
 
-    for (const auto &val : Z)
+    for (const auto &name : longitudinal)
     {
-        longitudinalMap.push_back(val.first);
-        terminals.push_back(createNode(string("z"), 0, 0, 0, val.first));
+        longitudinalMap.push_back(name);
+        terminals.push_back(createNode(string("z"), 0, 0, 0, name));
     }
     // reset output types
     set_ttypes();
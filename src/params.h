@@ -79,6 +79,11 @@ struct Parameters
     ///< string of comma-delimited operator names, used to choose functions
     string fn_str;      
     int n_jobs = 1; ///< number of parallel jobs
+    size_t cache_size = 1 << 28; ///< bytes of subtree outputs to cache
+    /// fraction of the training cases lexicase selects on each generation
+    float downsample = 1.0;
+    /// pick down-sampled cases that rank individuals differently
+    bool informed_downsample = false;
 
     struct BP 
     {
@@ -119,6 +124,9 @@ struct Parameters
      *  for classification, check clases and find number.
      */
     void init(const MatrixXf& X, const VectorXf& y);
+
+    /// as init(X, y), when dtypes are already set
+    void init(const VectorXf& y);
   
     /// sets current generation
     void set_current_gen(int g);
@@ -152,7 +160,10 @@ struct Parameters
     
     /// set the terminals with longitudinal data
     void set_terminals(int nf, const LongData& Z);
+    void set_terminals(int nf, const Dat::LongVars& Z);
     void set_terminals(int nf){LongData Z; set_terminals(nf,Z); };
+    /// set the terminals with the named longitudinal variables
+    void set_terminals(int nf, const vector<string>& longitudinal);
 
     void set_feature_names(string fn); 
     string get_feature_names();
@@ -232,7 +243,10 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Parameters,
     normalize,                             
     protected_groups,          
     tune_initial, 
-    tune_final 
+    tune_final,
+    cache_size,
+    downsample,
+    informed_downsample
     );
 } // FT
 #endif
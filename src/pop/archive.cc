@@ -9,7 +9,7 @@ namespace FT{
 
     namespace Pop{
 
-        Archive::Archive():  selector(true) {};
+        Archive::Archive() {};
 
         void Archive::set_objectives(vector<string> objectives)
         {
@@ -39,64 +39,79 @@ namespace FT{
         bool Archive::sameObjectives(const Individual& lhs, 
                 const Individual& rhs)
         {
-            for (const auto& o_lhs : lhs.obj)
-            {
-                for (const auto& o_rhs : rhs.obj)
-                {
-                    if (o_lhs != o_rhs)
-                        return false;
-                    
-                }
-            }
-            return true;
+            return lhs.obj == rhs.obj;
         }
         
+        /// copy of ind without its training outputs (Phi, yhat, error),
+        /// which archived programs don't use
+        static Individual handle(const Individual& ind)
+        {
+            Individual h;
+            h.program = ind.program;
+            h.ml = ind.ml;
+            h.fitness = ind.fitness;
+            h.fitness_v = ind.fitness_v;
+            h.fairness = ind.fairness;
+            h.fairness_v = ind.fairness_v;
+            h.w = ind.w;
+            h.p = ind.p;
+            h.dim = ind.dim;
+            h.obj = ind.obj;
+            h.crowd_dist = ind.crowd_dist;
+            h.complexity = ind.complexity;
+            h.dtypes = ind.dtypes;
+            h.id = ind.id;
+            h.parent_id = ind.parent_id;
+            h.eqn = ind.eqn;
+            h.set_rank(1);
+            h.set_complexity();
+            return h;
+        }
+
         void Archive::init(Population& pop) 
         {
-           auto tmp = pop.individuals;
-           selector.fast_nds(tmp); 
-           /* vector<size_t> front = this->sorted_front(); */
-           for (const auto& t : tmp )
-           {
-               if (t.rank ==1){
-                   individuals.push_back(t);
-                   individuals.at(individuals.size()-1).set_complexity();
-               }
-           } 
-           cout << "intializing archive with " << individuals.size() << " inds\n"; 
-           if (this->sort_complexity)
-               std::sort(individuals.begin(),individuals.end(), &sortComplexity); 
-           else
-               std::sort(individuals.begin(),individuals.end(), &sortObj1); 
+           for (const auto& i : nd_front(objectives(pop.individuals)))
+               insert(pop.individuals.at(i));
 
+           cout << "intializing archive with " << individuals.size() << " inds\n"; 
+           sort();
         }
 
         void Archive::update(const Population& pop, const Parameters& params)
         {
-                        
-            vector<Individual> tmp = pop.individuals;
-
-            for (const auto& p : individuals)
-                tmp.push_back(p);
-
-            selector.fast_nds(tmp);
-            
-            vector<int> pf = selector.front.at(0);
-          
-            individuals.resize(0);  // clear archive
-            for (const auto& i : pf)   // refill archive with new pareto front
+            // only the population's own front can enter the archive
+            for (const auto& i : nd_front(objectives(pop.individuals)))
+                insert(pop.individuals.at(i));
+
+            sort();
+        }
+
+        bool Archive::insert(const Individual& ind)
+        {
+            for (const auto& a : individuals)
             {
-                individuals.push_back(tmp.at(i));
-                individuals.at(individuals.size()-1).set_complexity();
+                if (a.obj.size() != ind.obj.size())
+                    THROW_LENGTH_ERROR("archive and population have "
+                            "different numbers of objectives");
+                if (a.check_dominance(ind) == 1 || sameObjectives(a, ind))
+                    return false;
             }
+
+            auto it = std::remove_if(individuals.begin(), individuals.end(),
+                    [&](const Individual& a){ 
+                        return ind.check_dominance(a) == 1; });
+            individuals.erase(it, individuals.end());
+
+            individuals.push_back(handle(ind));
+            return true;
+        }
+
+        void Archive::sort()
+        {
             if (this->sort_complexity)
                 std::sort(individuals.begin(),individuals.end(),&sortComplexity); 
             else
                 std::sort(individuals.begin(),individuals.end(), &sortObj1); 
-            /* auto it = std::unique(individuals.begin(),individuals.end(), &sameFitComplexity); */
-            auto it = std::unique(individuals.begin(),individuals.end(), 
-                    &sameObjectives);
-            individuals.resize(std::distance(individuals.begin(),it));
         }
     }
 }
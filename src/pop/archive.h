@@ -7,7 +7,8 @@ license: GNU/GPL v3
 
 //#include "node.h" // including node.h since definition of node is in the header
 #include "individual.h"
-#include "../sel/nsga2.h"
+#include "population.h"
+#include "../sel/nd_sort.h"
 using std::vector;
 using std::string;
 using Eigen::Map;
@@ -19,6 +20,10 @@ using namespace Sel;
 /*!
  * @class Archive 
  * @brief Defines a Pareto archive of programs.
+ *
+ * The archive only holds non-dominated programs. Candidates are checked
+ * against it one at a time, so programs that don't make it are never
+ * copied.
  */
      
 namespace Pop{
@@ -28,8 +33,6 @@ struct Archive
     vector<Individual> individuals; ///< individual programs in the archive
     bool sort_complexity;    ///< whether to sort archive by complexity
 
-    NSGA2 selector; ///< nsga2 selection operator for getting the front
-
     Archive();
 
     void set_objectives(vector<string> objectives);
@@ -47,7 +50,19 @@ struct Archive
 
     void init(Population& pop);
 
+    /// merges the Pareto front of pop into the archive
     void update(const Population& pop, const Parameters& params);
+
+    /*!
+     * adds ind to the archive, unless an archived program dominates it or
+     * has the same objectives, and drops the programs it dominates.
+     * only the parts of ind needed to report and predict are copied.
+     * @return true if ind was added
+     */
+    bool insert(const Individual& ind);
+   
+    /// sorts the archive by complexity or by first objective
+    void sort();
    
 };
 
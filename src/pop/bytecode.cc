@@ -0,0 +1,651 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "bytecode.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace FT{
+
+namespace Pop{
+
+/// bytes of registers that should fit in cache while evaluating a tile
+static const int TILE_BYTES = 1 << 18;
+
+static const int WORD_BITS = 64;
+
+/// number of words holding n bits
+static inline int n_words(int n){ return (n + WORD_BITS - 1)/WORD_BITS; }
+
+/// returns bit i of w
+static inline bool get_bit(const Word* w, int i)
+{
+    return (w[i/WORD_BITS] >> (i%WORD_BITS)) & 1;
+}
+
+/// writes cond(i) for the first n samples into the bits of w, one word at
+/// a time, without going through a byte array
+template <class F>
+static void pack(Word* w, int n, F cond)
+{
+    for (int k = 0; k < n_words(n); ++k)
+    {
+        int m = std::min(WORD_BITS, n - k*WORD_BITS);
+        const int base = k*WORD_BITS;
+        Word x = 0;
+        for (int j = 0; j < m; ++j)
+            x |= Word(cond(base + j)) << j;
+        w[k] = x;
+    }
+}
+
+/// writes the first n bits of w to out as 0s and 1s
+static void unpack(const Word* w, int n, float* out)
+{
+    for (int i = 0; i < n; ++i)
+        out[i] = get_bit(w, i);
+}
+
+/// returns the threshold of a split node, which is a template on its input
+template <class T>
+static bool split_threshold(Node* n, float& threshold)
+{
+    if (auto s = dynamic_cast<NodeSplit<T>*>(n))
+        threshold = s->threshold;
+    else if (auto s = dynamic_cast<NodeFuzzySplit<T>*>(n))
+        threshold = s->threshold;
+    else if (auto s = dynamic_cast<NodeFuzzyFixedSplit<T>*>(n))
+        threshold = s->threshold;
+    else
+        return false;
+    return true;
+}
+
+/// returns the feature index of a variable node
+static size_t variable_loc(Node* n)
+{
+    if (auto v = dynamic_cast<NodeVariable<float>*>(n))
+        return v->loc;
+    if (auto v = dynamic_cast<NodeVariable<bool>*>(n))
+        return v->loc;
+    return dynamic_cast<NodeVariable<int>*>(n)->loc;
+}
+
+/// looks up the opcode for n in the OpTable. returns false if n can't be
+/// evaluated on tiles.
+static bool get_opcode(Node* n, OpCode& op)
+{
+    const OpInfo* info = OpTable::get().find(n->name, n->otype);
+    if (!info || !info->tiled)
+        return false;
+    op = info->opcode;
+    return true;
+}
+
+/// appends the bytes of x to key
+template <class T>
+static void append(string& key, const T& x)
+{
+    key.append(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+Bytecode::Bytecode(){ compiled = false; cache = nullptr; }
+
+Bytecode::Bytecode(NodeVector& program, bool train, SubtreeCache* cache)
+{
+    compile(program, train, cache);
+}
+
+void Bytecode::compile(NodeVector& program, bool train, SubtreeCache* cache)
+{
+    /*!
+     * Simulates the program's stacks with value numbers. Nodes that compute
+     * a value already on record are skipped, so repeated subtrees are
+     * evaluated once. If a cache is given, the largest subtrees with
+     * cached outputs are replaced by loads and everything below them is
+     * dropped, and the remaining roots are marked to be stored. Registers
+     * are then assigned by a linear scan that frees a register after the
+     * last instruction reading it.
+     */
+    code.clear();
+    outputs.clear();
+    otypes.clear();
+    loads.clear();
+    n_regs = {{'f', 0}, {'b', 0}, {'c', 0}};
+    stypes.clear();
+    skeys.clear();
+    compiled = false;
+    this->cache = cache;
+
+    std::map<char, vector<int>> stacks = {{'f', {}}, {'b', {}}, {'c', {}}};
+    std::unordered_map<string, int> values;   // signature -> value number
+    vector<char> vtype;                        // type of each value
+    vector<vector<int>> args;                  // arguments of each value
+    vector<string> canon;                      // canonical form of each value
+
+    for (const auto& n : program)
+    {
+        OpCode op;
+        if (!get_opcode(n.get(), op))
+            return;
+        if (n->isNodeTrain() && train)
+            return;
+        if (n->arity.find('z') != n->arity.end() && n->arity.at('z') > 0)
+            return;
+
+        Instruction ins;
+        ins.op = op;
+        ins.src[0] = ins.src[1] = ins.src[2] = -1;
+        ins.w[0] = ins.w[1] = 0;
+        ins.value = 0;
+        ins.loc = 0;
+        ins.store = -1;
+        ins.otype = n->otype;
+
+        if (n->isNodeDx())
+        {
+            const auto& W = dynamic_cast<NodeDx*>(n.get())->W;
+            for (unsigned i = 0; i < W.size() && i < 2; ++i)
+                ins.w[i] = W.at(i);
+        }
+        if (op == OP_VAR_F || op == OP_VAR_B || op == OP_VAR_C)
+            ins.loc = variable_loc(n.get());
+        else if (op == OP_CONST_F || op == OP_CONST_B)
+        {
+            auto k = dynamic_cast<NodeConstant*>(n.get());
+            if (op == OP_CONST_F)
+                ins.value = Node::limited(ArrayXf::Constant(1, k->d_value))(0);
+            else
+                ins.value = k->b_value;
+        }
+        else if (op == OP_SPLIT_F)
+            split_threshold<float>(n.get(), ins.value);
+        else if (op == OP_SPLIT_C)
+            split_threshold<int>(n.get(), ins.value);
+
+        // pop arguments: floats, then booleans, then categoricals
+        vector<int> a;
+        for (char t : {'f', 'b', 'c'})
+        {
+            unsigned ar = n->arity.find(t) == n->arity.end() ? 0
+                                                            : n->arity.at(t);
+            if (stacks.at(t).size() < ar)
+                THROW_RUNTIME_ERROR("node " + n->name
+                        + " failed arity check");
+            for (unsigned i = 0; i < ar; ++i)
+            {
+                a.push_back(stacks.at(t).back());
+                stacks.at(t).pop_back();
+            }
+        }
+
+        // nodes are equal if they compute the same value numbers
+        string node;
+        append(node, ins.op);
+        append(node, ins.w);
+        append(node, ins.value);
+        append(node, ins.loc);
+        string key = node;
+        for (int v : a)
+            append(key, v);
+
+        auto it = values.find(key);
+        if (it != values.end())
+        {
+            stacks.at(n->otype).push_back(it->second);
+            continue;
+        }
+        int v = code.size();
+        values[key] = v;
+        vtype.push_back(n->otype);
+        args.push_back(a);
+        code.push_back(ins);
+        stacks.at(n->otype).push_back(v);
+        if (cache)
+        {
+            // the canonical form is the prefix order of the subtree; each
+            // opcode has a fixed arity, so it can't be read two ways
+            for (int u : a)
+                node += canon.at(u);
+            canon.push_back(std::move(node));
+        }
+    }
+
+    // outputs follow the order of the roots in the program
+    std::map<char, int> count = {{'f', 0}, {'b', 0}, {'c', 0}};
+    vector<int> out_values;
+    for (auto r : program.roots())
+    {
+        char t = program.at(r)->otype;
+        out_values.push_back(stacks.at(t).at(count.at(t)++));
+        otypes.push_back(t);
+    }
+
+    if (cache)
+    {
+        // look up subtrees from the roots down, loading the first cached
+        // output found on each path
+        vector<bool> live(code.size(), false);
+        vector<int> todo = out_values;
+        while (!todo.empty())
+        {
+            int v = todo.back();
+            todo.pop_back();
+            if (live.at(v))
+                continue;
+            live.at(v) = true;
+            if (args.at(v).empty())
+                continue;
+
+            auto cached = cache->get(canon.at(v));
+            if (cached)
+            {
+                auto& ins = code.at(v);
+                ins.op = vtype.at(v) == 'f' ? OP_LOAD_F
+                         : vtype.at(v) == 'b' ? OP_LOAD_B : OP_LOAD_C;
+                ins.loc = loads.size();
+                loads.push_back(cached);
+                args.at(v).clear();
+            }
+            else
+                todo.insert(todo.end(), args.at(v).begin(), args.at(v).end());
+        }
+
+        // drop values only needed by loaded subtrees
+        vector<int> renumber(code.size(), -1);
+        int n_live = 0;
+        for (int v = 0; v < code.size(); ++v)
+        {
+            if (!live.at(v))
+                continue;
+            renumber.at(v) = n_live;
+            code.at(n_live) = code.at(v);
+            vtype.at(n_live) = vtype.at(v);
+            args.at(n_live) = args.at(v);
+            if (n_live != v)
+                canon.at(n_live) = std::move(canon.at(v));
+            for (auto& a : args.at(n_live))
+                a = renumber.at(a);
+            ++n_live;
+        }
+        code.resize(n_live);
+        vtype.resize(n_live);
+        args.resize(n_live);
+        canon.resize(n_live);
+        for (auto& v : out_values)
+            v = renumber.at(v);
+
+        // save the outputs of evaluated roots that fit in the budget
+        size_t budget = cache->get_budget();
+        for (int v : out_values)
+        {
+            auto& ins = code.at(v);
+            if (args.at(v).empty() || ins.store >= 0 
+                || (stypes.size()+1)*cache->output_bytes() > budget)
+                continue;
+            ins.store = stypes.size();
+            stypes.push_back(vtype.at(v));
+            skeys.push_back(canon.at(v));
+        }
+    }
+
+    // register allocation
+    vector<int> last_use(code.size(), -1);
+    for (int i = 0; i < code.size(); ++i)
+        for (int v : args.at(i))
+            last_use.at(v) = i;
+    for (int v : out_values)
+        last_use.at(v) = INT_MAX;
+
+    vector<int> reg(code.size(), -1);
+    std::map<char, vector<int>> free_regs = {{'f', {}}, {'b', {}}, {'c', {}}};
+    for (int i = 0; i < code.size(); ++i)
+    {
+        const auto& a = args.at(i);
+        for (int j = 0; j < a.size(); ++j)
+        {
+            code.at(i).src[j] = reg.at(a.at(j));
+            if (last_use.at(a.at(j)) == i
+                && std::find(a.begin(), a.begin()+j, a.at(j)) == a.begin()+j)
+                free_regs.at(vtype.at(a.at(j))).push_back(reg.at(a.at(j)));
+        }
+        auto& pool = free_regs.at(vtype.at(i));
+        if (pool.empty())
+            reg.at(i) = n_regs.at(vtype.at(i))++;
+        else
+        {
+            reg.at(i) = pool.back();
+            pool.pop_back();
+        }
+        code.at(i).dst = reg.at(i);
+    }
+    for (int v : out_values)
+        outputs.push_back(reg.at(v));
+
+    compiled = true;
+}
+
+int Bytecode::default_tile_size() const
+{
+    // boolean registers take a bit per sample
+    int bytes = sizeof(float)*(n_regs.at('f') + n_regs.at('c'))
+                + (n_regs.at('b') + 7)/8;
+    int tile = TILE_BYTES / std::max(bytes, 1);
+    tile -= tile % 64;
+    return std::min(std::max(tile, 256), 4096);
+}
+
+void Bytecode::execute(const Instruction& ins, Registers& r)
+{
+    const int len = r.len;
+    const float* W = ins.w;
+    const int* s = ins.src;
+    const int nw = n_words(len);
+
+    float* o = ins.otype == 'f' ? r.F + ins.dst*r.f_stride : nullptr;
+    auto x = [&](int i){ return r.fp[i]; };
+    auto f = [&](int i){ return Map<const ArrayXf>(r.fp[i], len); };
+    auto fw = [&](){ return Map<ArrayXf>(o, len); };
+    auto b = [&](int i){ return r.B + i*r.b_stride; };
+    auto c = [&](int i){ return Map<ArrayXi>(r.C + i*r.c_stride, len); };
+
+    // word-parallel logic on boolean registers
+    auto logic = [&](auto op){
+        Word* out = b(ins.dst);
+        const Word* u = b(s[0]);
+        const Word* v = b(s[1]);
+        for (int k = 0; k < nw; ++k)
+            out[k] = op(u[k], v[k]);
+    };
+    // comparison of float registers, written straight to bits
+    auto compare = [&](auto op){
+        const float* u = x(s[0]);
+        const float* v = x(s[1]);
+        pack(b(ins.dst), len, [&](int i){ return op(u[i], v[i]); });
+    };
+
+    switch (ins.op)
+    {
+    case OP_VAR_F:
+    case OP_VAR_B:
+    case OP_VAR_C:
+    case OP_LOAD_F:
+    case OP_LOAD_B:
+    case OP_LOAD_C:
+        // read by the caller
+        return;
+    case OP_CONST_F:
+        fw().setConstant(ins.value);
+        break;
+    case OP_CONST_B:
+        std::fill(b(ins.dst), b(ins.dst) + nw,
+                  ins.value != 0 ? ~Word(0) : Word(0));
+        break;
+    case OP_ADD:
+        fw() = Node::limited(W[0]*f(s[0]) + W[1]*f(s[1]));
+        break;
+    case OP_SUB:
+        fw() = Node::limited(W[0]*f(s[0]) - W[1]*f(s[1]));
+        break;
+    case OP_MUL:
+        fw() = Node::limited(W[0]*f(s[0]) * W[1]*f(s[1]));
+        break;
+    case OP_DIV:
+        fw() = Node::limited((W[0] * f(s[0])) / (W[1] * f(s[1])));
+        break;
+    case OP_EXPONENT:
+        CPU_Exponent(o, x(s[0]), x(s[1]), len, W[0], W[1]);
+        break;
+    case OP_EXP:
+        CPU_Exp(o, x(s[0]), len, W[0]);
+        break;
+    case OP_LOG:
+        CPU_Log(o, x(s[0]), len, W[0]);
+        break;
+    case OP_LOGIT:
+        CPU_Logit(o, x(s[0]), len, W[0]);
+        break;
+    case OP_SIN:
+        CPU_Sin(o, x(s[0]), len, W[0]);
+        break;
+    case OP_COS:
+        CPU_Cos(o, x(s[0]), len, W[0]);
+        break;
+    case OP_TANH:
+        CPU_Tanh(o, x(s[0]), len, W[0]);
+        break;
+    case OP_SQUARE:
+        fw() = Node::limited(pow(W[0]*f(s[0]), 2));
+        break;
+    case OP_CUBE:
+        fw() = Node::limited(pow(W[0] * f(s[0]), 3));
+        break;
+    case OP_SQRT:
+        fw() = sqrt(W[0]*f(s[0]).abs());
+        break;
+    case OP_GAUSS:
+        CPU_Gaussian(o, x(s[0]), len, W[0]);
+        break;
+    case OP_RELU:
+        fw() = (W[0] * f(s[0]) > 0).select(W[0]*f(s[0]), 0.01f);
+        break;
+    case OP_SIGN:
+        fw() = (f(s[0]) > 0).select(ArrayXf::Ones(len),
+                        (f(s[0]) == 0).select(ArrayXf::Zero(len),
+                                              -ArrayXf::Ones(len)));
+        break;
+    case OP_STEP:
+        fw() = (f(s[0]) > 0).select(ArrayXf::Ones(len), ArrayXf::Zero(len));
+        break;
+    case OP_B2F:
+        unpack(b(s[0]), len, o);
+        break;
+    case OP_C2F:
+        fw() = c(s[0]).cast<float>();
+        break;
+    case OP_IF:
+    {
+        const float* u = x(s[0]);
+        const Word* m = b(s[1]);
+        for (int i = 0; i < len; ++i)
+            o[i] = get_bit(m, i) ? u[i] : 0;
+        fw() = Node::limited(fw());
+        break;
+    }
+    case OP_ITE:
+    {
+        const float* u = x(s[0]);
+        const float* v = x(s[1]);
+        const Word* m = b(s[2]);
+        for (int i = 0; i < len; ++i)
+            o[i] = get_bit(m, i) ? u[i] : v[i];
+        fw() = Node::limited(fw());
+        break;
+    }
+    case OP_AND:
+        logic(std::bit_and<Word>());
+        break;
+    case OP_OR:
+        logic(std::bit_or<Word>());
+        break;
+    case OP_NOT:
+    {
+        Word* out = b(ins.dst);
+        const Word* u = b(s[0]);
+        for (int k = 0; k < nw; ++k)
+            out[k] = ~u[k];
+        break;
+    }
+    case OP_XOR:
+        logic(std::bit_xor<Word>());
+        break;
+    case OP_EQ:
+        compare(std::equal_to<float>());
+        break;
+    case OP_GT:
+        compare(std::greater<float>());
+        break;
+    case OP_GEQ:
+        compare(std::greater_equal<float>());
+        break;
+    case OP_LT:
+        compare(std::less<float>());
+        break;
+    case OP_LEQ:
+        compare(std::less_equal<float>());
+        break;
+    case OP_SPLIT_F:
+    {
+        const float* u = x(s[0]);
+        const float t = ins.value;
+        pack(b(ins.dst), len, [&](int i){ return u[i] < t; });
+        break;
+    }
+    case OP_SPLIT_C:
+    {
+        const int* u = c(s[0]).data();
+        const float t = ins.value;
+        pack(b(ins.dst), len, [&](int i){ return float(u[i]) == t; });
+        break;
+    }
+    }
+
+    if (o)
+        r.fp[ins.dst] = o;
+}
+
+MatrixXf Bytecode::run(const Data& d, int tile_size) const
+{
+    /*!
+     * @param d: Data structure
+     * @param tile_size: number of samples evaluated at once, or 0 to use
+     *  default_tile_size()
+     * @return Phi: n_features x n_samples transformation
+     */
+    if (!compiled)
+        THROW_RUNTIME_ERROR("Bytecode::run() called on a program that "
+                "was not compiled");
+    if ((!loads.empty() || !stypes.empty()) 
+            && (d.cache != cache || !cache->bound_to(d)))
+        THROW_RUNTIME_ERROR("Bytecode::run() called on data its cache "
+                "isn't bound to");
+
+    int N = d.n_samples();
+    int T = tile_size > 0 ? tile_size : default_tile_size();
+    T = std::max(std::min(T, N), 1);
+
+    // register files are kept per thread and only grow
+    static thread_local Eigen::ArrayXXf F;
+    static thread_local Eigen::Array<Word, Dynamic, Dynamic> B;
+    static thread_local Eigen::ArrayXXi C;
+    if (F.rows() != T || F.cols() < n_regs.at('f'))
+        F.resize(T, n_regs.at('f'));
+    if (B.rows() != n_words(T) || B.cols() < n_regs.at('b'))
+        B.resize(n_words(T), n_regs.at('b'));
+    if (C.rows() != T || C.cols() < n_regs.at('c'))
+        C.resize(T, n_regs.at('c'));
+
+    Matrix<float,Dynamic,Dynamic,RowMajor> Phi(outputs.size(), N);
+
+    // outputs of evaluated roots, added to the cache once complete
+    vector<std::shared_ptr<ArrayXf>> stores(stypes.size());
+    for (auto& o : stores)
+        o = std::make_shared<ArrayXf>(N);
+
+    vector<const float*> fp(n_regs.at('f'));
+    Registers r = {0, fp.data(), F.data(), int(F.rows()), B.data(),
+                   int(B.rows()), C.data(), int(C.rows())};
+
+    for (int start = 0; start < N; start += T)
+    {
+        int len = std::min(T, N - start);
+        r.len = len;
+        auto f = [&](int i){ return Map<const ArrayXf>(fp.at(i), len); };
+        auto b = [&](int i){ return B.col(i).data(); };
+        auto c = [&](int i){ return C.col(i).head(len); };
+
+        for (const auto& ins : code)
+        {
+            switch (ins.op)
+            {
+            case OP_VAR_F:
+                fp.at(ins.dst) = d.feature(ins.loc).data() + start;
+                break;
+            case OP_VAR_B:
+            {
+                const float* x = d.feature(ins.loc).data() + start;
+                pack(b(ins.dst), len, [&](int i){ return x[i] != 0; });
+                break;
+            }
+            case OP_VAR_C:
+                c(ins.dst) = d.feature(ins.loc).segment(start, len)
+                                .cast<int>();
+                break;
+            case OP_LOAD_F:
+                F.col(ins.dst).head(len) = 
+                    loads.at(ins.loc)->segment(start, len);
+                fp.at(ins.dst) = F.col(ins.dst).data();
+                break;
+            case OP_LOAD_B:
+            {
+                const float* x = loads.at(ins.loc)->data() + start;
+                pack(b(ins.dst), len, [&](int i){ return x[i] != 0; });
+                break;
+            }
+            case OP_LOAD_C:
+                c(ins.dst) = loads.at(ins.loc)->segment(start, len).cast<int>();
+                break;
+            default:
+                execute(ins, r);
+            }
+
+            if (ins.store >= 0)
+            {
+                auto seg = stores.at(ins.store)->segment(start, len);
+                switch (stypes.at(ins.store))
+                {
+                case 'f':
+                    seg = f(ins.dst);
+                    break;
+                case 'c':
+                    seg = c(ins.dst).cast<float>();
+                    break;
+                case 'b':
+                    unpack(b(ins.dst), len, seg.data());
+                    break;
+                }
+            }
+        }
+
+        // copy outputs to Phi, removing nans and infs
+        for (int i = 0; i < outputs.size(); ++i)
+        {
+            auto row = Phi.row(i).segment(start, len);
+            switch (otypes.at(i))
+            {
+            case 'f':
+                row = Node::limited(f(outputs.at(i))).matrix().transpose();
+                break;
+            case 'c':
+                row = c(outputs.at(i)).cast<float>().matrix().transpose();
+                break;
+            case 'b':
+                unpack(b(outputs.at(i)), len, row.data());
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < stores.size(); ++i)
+        cache->put(skeys.at(i), stores.at(i));
+
+    return Phi;
+}
+
+}
+}
@@ -0,0 +1,117 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include "optable.h"
+#include "cache.h"
+
+namespace FT{
+
+    namespace Pop{
+
+        ////////////////////////////////////////////////////////////////////////////////// Declarations
+
+        /*!
+         * @class Instruction
+         * @brief a single register-to-register operation. weights, feature
+         * locations and thresholds are copied out of the node at compile
+         * time.
+         */
+        struct Instruction
+        {
+            OpCode op;
+            char otype;             ///< output type
+            int dst;                ///< destination register
+            int src[3];             ///< argument registers, in pop order
+            float w[2];             ///< node weights
+            float value;            ///< constant value or split threshold
+            size_t loc;             ///< feature index of variables, or
+                                    ///< index of a cached output
+            int store;              ///< slot the output is saved to for 
+                                    ///< the cache, or -1
+        };
+
+        /// boolean registers hold one bit per sample, packed into words
+        typedef uint64_t Word;
+
+        /*!
+         * @class Registers
+         * @brief the registers of one tile of samples. float registers are
+         * read through pointers, so that variables can be read in place;
+         * the others are read and written in the register arrays.
+         */
+        struct Registers
+        {
+            int len;                ///< samples in the tile
+            const float** fp;       ///< where each float register is read
+            float* F;               ///< float registers, f_stride apart
+            int f_stride;
+            Word* B;                ///< boolean registers, b_stride apart
+            int b_stride;
+            int* C;                 ///< categorical registers, c_stride apart
+            int c_stride;
+        };
+
+        /*!
+         * @class Bytecode
+         * @brief a program lowered to a flat list of register instructions.
+         *
+         * Identical subtrees (same node types, weights, features and
+         * thresholds) are evaluated once, and registers are recycled as soon
+         * as their last consumer has run. run() evaluates the instructions
+         * one tile of samples at a time so that intermediate results stay in
+         * cache. Float variables are read in place from the feature-major
+         * copy of X rather than copied into registers. Boolean registers
+         * are packed 64 samples to a word; logic runs word-parallel and
+         * comparisons write bits directly.
+         * When compiled with a cache, subtrees whose outputs are cached are
+         * loaded instead of evaluated, and the outputs of evaluated roots
+         * are added to the cache while they fit in its budget. Roots are
+         * the subtrees offspring most often inherit whole; storing every
+         * internal node would cost a full-length output per node.
+         * Programs that use operators needing all samples at once
+         * (longitudinal aggregates, 2d gaussians, splits being trained) are
+         * not compiled; compiled is false and the program should be
+         * interpreted instead.
+         */
+        struct Bytecode
+        {
+            vector<Instruction> code;   ///< instructions in execution order
+            vector<int> outputs;        ///< registers holding the program roots
+            vector<char> otypes;        ///< types of the program roots
+            std::map<char, int> n_regs; ///< number of registers of each type
+            bool compiled;              ///< false if the program must be interpreted
+            vector<char> stypes;        ///< types of outputs saved to the cache
+            vector<string> skeys;       ///< canonical forms of saved outputs
+            SubtreeCache* cache;        ///< cache of subtree outputs, if any
+            /// cached outputs read by load instructions
+            vector<std::shared_ptr<const ArrayXf>> loads;
+
+            Bytecode();
+
+            /// compiles program. if train is true, learning nodes are
+            /// fit during evaluation and the program is not compiled.
+            /// the program must then be run on the data cache is bound to.
+            Bytecode(NodeVector& program, bool train=false,
+                     SubtreeCache* cache=nullptr);
+
+            void compile(NodeVector& program, bool train=false,
+                         SubtreeCache* cache=nullptr);
+
+            /// evaluates the program on d, returning n_roots x n_samples
+            MatrixXf run(const Data& d, int tile_size=0) const;
+
+            /// number of samples evaluated at once by default
+            int default_tile_size() const;
+
+            /// runs ins on the tile in r. variables and loads read values
+            /// the registers don't hold and are left to the caller.
+            static void execute(const Instruction& ins, Registers& r);
+        };
+    }
+}
+#endif
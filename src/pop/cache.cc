@@ -0,0 +1,125 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "cache.h"
+
+namespace FT{
+
+namespace Pop{
+
+SubtreeCache::SubtreeCache(size_t budget)
+{
+    this->budget = budget;
+    bytes = 0;
+    data = NULL;
+    n = 0;
+    n_hits = 0;
+    n_misses = 0;
+}
+
+SubtreeCache::SubtreeCache(const SubtreeCache& other)
+    : SubtreeCache(other.budget)
+{
+}
+
+SubtreeCache& SubtreeCache::operator=(const SubtreeCache& other)
+{
+    // the data bound to this cache may be gone, so it is not touched.
+    // with n = 0, nothing is stored for it anymore.
+    if (this != &other)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        drop();
+        budget = other.budget;
+        data = NULL;
+        n = 0;
+    }
+    return *this;
+}
+
+void SubtreeCache::drop()
+{
+    entries.clear();
+    index.clear();
+    bytes = 0;
+}
+
+void SubtreeCache::set_budget(size_t b)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    budget = b;
+    while (bytes > budget)
+    {
+        bytes -= entries.back().second->size()*sizeof(float);
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+void SubtreeCache::set_data(const Data& d)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    drop();
+    // the previous data may be gone, so it is not touched. if it isn't, 
+    // bound_to() keeps it from using outputs on d.
+    data = &d;
+    n = d.n_samples();
+    d.cache = budget > 0 ? this : NULL;
+}
+
+void SubtreeCache::clear()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    drop();
+    if (data && data->cache == this)
+        data->cache = NULL;
+    data = NULL;
+    n = 0;
+}
+
+std::shared_ptr<const ArrayXf> SubtreeCache::get(const string& key)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = index.find(key);
+    if (it == index.end())
+    {
+        ++n_misses;
+        return nullptr;
+    }
+    ++n_hits;
+    // move to front
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+}
+
+void SubtreeCache::put(const string& key,
+                       std::shared_ptr<const ArrayXf> value)
+{
+    size_t b = value->size()*sizeof(float);
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (b > budget || value->size() != n || index.find(key) != index.end())
+        return;
+
+    entries.emplace_front(key, value);
+    index[key] = entries.begin();
+    bytes += b;
+    // evict least recently used outputs
+    while (bytes > budget)
+    {
+        bytes -= entries.back().second->size()*sizeof(float);
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+size_t SubtreeCache::size_bytes()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return bytes;
+}
+
+}
+}
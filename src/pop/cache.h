@@ -0,0 +1,108 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include "../dat/data.h"
+
+namespace FT{
+
+    using namespace Dat;
+
+    namespace Pop{
+
+        ////////////////////////////////////////////////////////////////////////////////// Declarations
+
+        /*!
+         * @class SubtreeCache
+         * @brief thread-safe LRU cache of subtree outputs on one Data.
+         *
+         * Outputs are keyed by the canonical form of the subtree (node
+         * types, features, weights and thresholds of every node in it), so
+         * offspring can reuse the outputs of subtrees they share with other
+         * individuals, and a hit is always the same subtree. Each Feat owns
+         * its cache and binds it to the Data being evaluated with
+         * set_data(); programs run on that Data find the cache through
+         * Data::cache. The least recently used outputs are evicted once the
+         * cache holds more than its byte budget.
+         */
+        class SubtreeCache
+        {
+            public:
+
+                SubtreeCache(size_t budget=0);
+
+                /// copies start empty and unbound, with the same budget
+                SubtreeCache(const SubtreeCache& other);
+
+                SubtreeCache& operator=(const SubtreeCache& other);
+
+                /// sets the memory budget in bytes. 0 disables the cache.
+                void set_budget(size_t bytes);
+
+                size_t get_budget(){ return budget; }
+
+                /// drops stored outputs and binds the cache to d. d must
+                /// not change while it is bound.
+                void set_data(const Data& d);
+
+                /// drops stored outputs and unbinds the cache from its data
+                void clear();
+
+                /// true if the cache holds outputs on d. data bound before
+                /// keeps pointing at the cache after it is rebound, so 
+                /// Data::cache alone doesn't say that.
+                bool bound_to(const Data& d) const 
+                { 
+                    return data == &d && n == d.n_samples(); 
+                }
+
+                /// bytes taken by the output of one subtree on the data
+                size_t output_bytes() const { return n*sizeof(float); }
+
+                /// returns the output of the subtree with canonical form
+                /// key, or nullptr if it isn't stored
+                std::shared_ptr<const ArrayXf> get(const string& key);
+
+                /// stores the output of the subtree with canonical form key
+                void put(const string& key,
+                         std::shared_ptr<const ArrayXf> value);
+
+                /// bytes currently held
+                size_t size_bytes();
+
+                size_t hits(){ return n_hits; }
+
+                size_t misses(){ return n_misses; }
+
+                void reset_counters(){ n_hits = 0; n_misses = 0; }
+
+            private:
+
+                typedef std::pair<string, std::shared_ptr<const ArrayXf>>
+                    Entry;
+
+                /// drops stored outputs. lock must be held.
+                void drop();
+
+                std::list<Entry> entries;   ///< most recently used first
+                std::unordered_map<string, std::list<Entry>::iterator> index;
+                std::mutex lock;
+
+                size_t budget;              ///< maximum bytes held
+                size_t bytes;               ///< bytes held
+                const Data* data;           ///< data the outputs belong to
+                long n;                     ///< number of samples in data
+                std::atomic<size_t> n_hits;
+                std::atomic<size_t> n_misses;
+        };
+    }
+}
+#endif
@@ -0,0 +1,376 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "compact.h"
+#include <cstring>
+
+namespace FT{
+
+namespace Pop{
+
+/// copies the threshold and flags of a split of type S into g
+template <class S>
+static bool encode_split(Node* n, Gene& g, vector<float>& pool)
+{
+    auto s = dynamic_cast<S*>(n);
+    if (!s)
+        return false;
+    g.w = pool.size();
+    g.n = 1;
+    pool.push_back(s->threshold);
+    g.flag = s->train ? FLAG_ON : 0;
+    return true;
+}
+
+template <class T>
+static bool encode_variable(Node* n, Gene& g, string& name)
+{
+    auto v = dynamic_cast<NodeVariable<T>*>(n);
+    if (!v)
+        return false;
+    g.loc = v->loc;
+    name = v->variable_name;
+    return true;
+}
+
+template <class S>
+static bool decode_split(Node* n, const Gene& g, const vector<float>& pool)
+{
+    auto s = dynamic_cast<S*>(n);
+    if (!s)
+        return false;
+    s->threshold = pool.at(g.w);
+    s->train = g.flag & FLAG_ON;
+    return true;
+}
+
+template <class T>
+static bool decode_variable(Node* n, const Gene& g, const string& name,
+                            char otype)
+{
+    auto v = dynamic_cast<NodeVariable<T>*>(n);
+    if (!v)
+        return false;
+    v->loc = g.loc;
+    v->variable_name = name;
+    v->otype = otype;
+    return true;
+}
+
+CompactProgram::CompactProgram() = default;
+
+CompactProgram::CompactProgram(const NodeVector& program)
+{
+    const OpTable& T = OpTable::get();
+    vector<string> vnames;
+
+    genes.reserve(program.size());
+    for (const auto& p : program)
+    {
+        Node* n = p.get();
+        Gene g;
+        std::memset(&g, 0, sizeof(g));
+        g.op = T.code(n->name, n->otype);
+        string vname;
+
+        switch (T.at(g.op).kind)
+        {
+            case KIND_WEIGHTED:
+            {
+                const vector<float>& W = dynamic_cast<NodeDx*>(n)->W;
+                g.w = pool.size();
+                g.n = W.size();
+                pool.insert(pool.end(), W.begin(), W.end());
+                break;
+            }
+            case KIND_VARIABLE:
+                encode_variable<float>(n, g, vname)
+                    || encode_variable<bool>(n, g, vname)
+                    || encode_variable<int>(n, g, vname);
+                if (vnames.size() <= g.loc)
+                    vnames.resize(g.loc+1);
+                vnames.at(g.loc) = vname;
+                break;
+            case KIND_CONSTANT:
+            {
+                auto k = dynamic_cast<NodeConstant*>(n);
+                g.w = pool.size();
+                g.n = 1;
+                pool.push_back(k->d_value);
+                g.flag = k->b_value ? FLAG_ON : 0;
+                break;
+            }
+            case KIND_SPLIT:
+                encode_split<NodeSplit<float>>(n, g, pool)
+                    || encode_split<NodeSplit<int>>(n, g, pool)
+                    || encode_split<NodeFuzzySplit<float>>(n, g, pool)
+                    || encode_split<NodeFuzzySplit<int>>(n, g, pool);
+                break;
+            case KIND_FIXED_SPLIT:
+                encode_split<NodeFuzzyFixedSplit<float>>(n, g, pool)
+                    || encode_split<NodeFuzzyFixedSplit<int>>(n, g, pool);
+                if (auto s = dynamic_cast<NodeFuzzyFixedSplit<float>*>(n))
+                    g.flag |= s->threshold_set ? FLAG_SET : 0;
+                else if (auto s = dynamic_cast<NodeFuzzyFixedSplit<int>*>(n))
+                    g.flag |= s->threshold_set ? FLAG_SET : 0;
+                break;
+            default:
+                break;
+        }
+        genes.push_back(g);
+    }
+    if (!vnames.empty())
+        names = std::make_shared<const vector<string>>(std::move(vnames));
+}
+
+const OpInfo& CompactProgram::info(size_t i) const
+{
+    return OpTable::get().at(genes.at(i).op);
+}
+
+string CompactProgram::variable_name(const Gene& g) const
+{
+    if (names && g.loc < names->size() && !names->at(g.loc).empty())
+        return names->at(g.loc);
+    return "x_" + std::to_string(g.loc);
+}
+
+NodeVector CompactProgram::decode() const
+{
+    const OpTable& T = OpTable::get();
+    NodeVector program;
+    program.reserve(genes.size());
+
+    for (const auto& g : genes)
+    {
+        const OpInfo& info = T.at(g.op);
+        std::unique_ptr<Node> n = info.node->clone();
+        Node* p = n.get();
+
+        switch (info.kind)
+        {
+            case KIND_WEIGHTED:
+            {
+                NodeDx* d = dynamic_cast<NodeDx*>(p);
+                d->W.assign(pool.begin()+g.w, pool.begin()+g.w+g.n);
+                d->V.clear();
+                break;
+            }
+            case KIND_VARIABLE:
+            {
+                string vname = variable_name(g);
+                decode_variable<float>(p, g, vname, info.otype)
+                    || decode_variable<bool>(p, g, vname, info.otype)
+                    || decode_variable<int>(p, g, vname, info.otype);
+                break;
+            }
+            case KIND_CONSTANT:
+            {
+                auto k = dynamic_cast<NodeConstant*>(p);
+                k->name = info.name;
+                k->otype = info.otype;
+                k->d_value = pool.at(g.w);
+                k->b_value = g.flag & FLAG_ON;
+                break;
+            }
+            case KIND_SPLIT:
+                decode_split<NodeSplit<float>>(p, g, pool)
+                    || decode_split<NodeSplit<int>>(p, g, pool)
+                    || decode_split<NodeFuzzySplit<float>>(p, g, pool)
+                    || decode_split<NodeFuzzySplit<int>>(p, g, pool);
+                break;
+            case KIND_FIXED_SPLIT:
+                decode_split<NodeFuzzyFixedSplit<float>>(p, g, pool)
+                    || decode_split<NodeFuzzyFixedSplit<int>>(p, g, pool);
+                if (auto s = dynamic_cast<NodeFuzzyFixedSplit<float>*>(p))
+                    s->threshold_set = g.flag & FLAG_SET;
+                else if (auto s = dynamic_cast<NodeFuzzyFixedSplit<int>*>(p))
+                    s->threshold_set = g.flag & FLAG_SET;
+                break;
+            default:
+                break;
+        }
+        n->visits = 0;
+        program.push_back(std::move(n));
+    }
+    program.update_structure();
+    return program;
+}
+
+bool CompactProgram::is_valid() const
+{
+    const OpTable& T = OpTable::get();
+    int stack[4] = {0, 0, 0, 0};
+    for (const auto& g : genes)
+    {
+        const OpInfo& info = T.at(g.op);
+        for (int t = 0; t < 4; ++t)
+        {
+            stack[t] -= info.arity[t];
+            if (stack[t] < 0)
+                return false;
+        }
+        ++stack[OpTable::slot(info.otype)];
+    }
+    return true;
+}
+
+unsigned CompactProgram::complexity() const
+{
+    /*! same recursion as Node::eval_complexity(), over a stack of
+     * complexities per type. */
+    const OpTable& T = OpTable::get();
+    vector<unsigned> stack[4];
+    for (const auto& g : genes)
+    {
+        const OpInfo& info = T.at(g.op);
+        unsigned c_args = 1;
+        for (int t = 0; t < 4; ++t)
+        {
+            for (unsigned i = 0; i < info.arity[t] && !stack[t].empty(); ++i)
+            {
+                c_args += stack[t].back();
+                stack[t].pop_back();
+            }
+        }
+        stack[OpTable::slot(info.otype)].push_back(info.complexity*c_args);
+    }
+    unsigned c = 0;
+    for (const auto& s : stack)
+        for (auto v : s)
+            c += v;
+    return c;
+}
+
+/// FNV-1a over n bytes, continuing from h
+static size_t hash_bytes(const void* data, size_t n, uint64_t h)
+{
+    const unsigned char* b = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; ++i)
+    {
+        h ^= b[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+size_t CompactProgram::hash() const
+{
+    uint64_t h = 14695981039346656037ULL;
+    h = hash_bytes(genes.data(), genes.size()*sizeof(Gene), h);
+    h = hash_bytes(pool.data(), pool.size()*sizeof(float), h);
+    return h;
+}
+
+bool CompactProgram::operator==(const CompactProgram& other) const
+{
+    // genes have no padding, so they compare as bytes
+    return genes.size() == other.genes.size()
+        && pool == other.pool
+        && std::memcmp(genes.data(), other.genes.data(),
+                       genes.size()*sizeof(Gene)) == 0;
+}
+
+void to_json(json& j, const CompactProgram& p)
+{
+    const OpTable& T = OpTable::get();
+    j = json::array();
+    for (const auto& g : p.genes)
+    {
+        const OpInfo& info = T.at(g.op);
+        json k;
+        k["name"] = info.name;
+        k["otype"] = info.otype;
+        k["arity"] = std::map<char, unsigned int>{
+            {'f', info.arity[0]}, {'b', info.arity[1]},
+            {'c', info.arity[2]}, {'z', info.arity[3]}};
+        k["complexity"] = info.complexity;
+        k["visits"] = 0;
+
+        switch (info.kind)
+        {
+            case KIND_WEIGHTED:
+                k["W"] = vector<float>(p.pool.begin()+g.w,
+                                       p.pool.begin()+g.w+g.n);
+                k["V"] = vector<float>();
+                break;
+            case KIND_VARIABLE:
+                k["loc"] = size_t(g.loc);
+                k["variable_name"] = p.variable_name(g);
+                break;
+            case KIND_CONSTANT:
+                k["d_value"] = p.pool.at(g.w);
+                k["b_value"] = bool(g.flag & FLAG_ON);
+                break;
+            case KIND_FIXED_SPLIT:
+                k["threshold_set"] = bool(g.flag & FLAG_SET);
+                // fall through
+            case KIND_SPLIT:
+                k["train"] = bool(g.flag & FLAG_ON);
+                k["threshold"] = p.pool.at(g.w);
+                break;
+            default:
+                break;
+        }
+        j.push_back(k);
+    }
+}
+
+void from_json(const json& j, CompactProgram& p)
+{
+    const OpTable& T = OpTable::get();
+    vector<string> vnames;
+    p.genes.clear();
+    p.pool.clear();
+
+    for (const auto& k : j)
+    {
+        Gene g;
+        std::memset(&g, 0, sizeof(g));
+        g.op = T.code(k.at("name").get<string>(), k.at("otype").get<char>());
+
+        switch (T.at(g.op).kind)
+        {
+            case KIND_WEIGHTED:
+            {
+                vector<float> W = k.at("W").get<vector<float>>();
+                g.w = p.pool.size();
+                g.n = W.size();
+                p.pool.insert(p.pool.end(), W.begin(), W.end());
+                break;
+            }
+            case KIND_VARIABLE:
+                g.loc = k.at("loc").get<size_t>();
+                if (vnames.size() <= g.loc)
+                    vnames.resize(g.loc+1);
+                vnames.at(g.loc) = k.at("variable_name").get<string>();
+                break;
+            case KIND_CONSTANT:
+                g.w = p.pool.size();
+                g.n = 1;
+                p.pool.push_back(k.at("d_value").get<float>());
+                g.flag = k.at("b_value").get<bool>() ? FLAG_ON : 0;
+                break;
+            case KIND_FIXED_SPLIT:
+                g.flag |= k.at("threshold_set").get<bool>() ? FLAG_SET : 0;
+                // fall through
+            case KIND_SPLIT:
+                g.flag |= k.at("train").get<bool>() ? FLAG_ON : 0;
+                g.w = p.pool.size();
+                g.n = 1;
+                p.pool.push_back(k.at("threshold").get<float>());
+                break;
+            default:
+                break;
+        }
+        p.genes.push_back(g);
+    }
+    p.names.reset();
+    if (!vnames.empty())
+        p.names = std::make_shared<const vector<string>>(std::move(vnames));
+}
+
+} // Pop
+} // FT
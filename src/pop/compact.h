@@ -0,0 +1,85 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <cstdint>
+#include "optable.h"
+
+namespace FT{
+
+    namespace Pop{
+
+        ////////////////////////////////////////////////////////////////////////////////// Declarations
+
+        /*!
+         * @class Gene
+         * @brief a node of a compact program. genes are plain data, so
+         * programs copy and hash as flat arrays.
+         */
+        struct Gene
+        {
+            uint16_t op;        ///< row in the OpTable
+            uint8_t flag;       ///< FLAG_* bits
+            uint8_t n;          ///< number of values in the pool
+            uint32_t loc;       ///< feature location of variables
+            uint32_t w;         ///< offset of the node's values in the pool
+        };
+
+        /// train flag of splits, or the value of boolean constants
+        static const uint8_t FLAG_ON = 1;
+        /// threshold_set of fixed fuzzy splits
+        static const uint8_t FLAG_SET = 2;
+
+        /*!
+         * @class CompactProgram
+         * @brief a program stored as an array of genes and a pool of
+         * weights, with node metadata taken from the OpTable.
+         *
+         * Variable names are kept in a list shared between copies.
+         * Backprop velocities and visit counts are not stored, since they
+         * only live during weight updates. Longitudinal variables are not
+         * in the NodeMap and can't be encoded, as with from_json().
+         */
+        struct CompactProgram
+        {
+            vector<Gene> genes;
+            vector<float> pool;     ///< weights, constants and thresholds
+            /// names of the features, by location
+            std::shared_ptr<const vector<string>> names;
+
+            CompactProgram();
+
+            /// encodes program
+            explicit CompactProgram(const NodeVector& program);
+
+            /// decodes into nodes
+            NodeVector decode() const;
+
+            size_t size() const { return genes.size(); }
+
+            const OpInfo& info(size_t i) const;
+
+            /// true if every node finds its arguments
+            bool is_valid() const;
+
+            /// complexity of the program, as in Individual::set_complexity()
+            unsigned complexity() const;
+
+            /// hash of the operators, locations and values
+            size_t hash() const;
+
+            bool operator==(const CompactProgram& other) const;
+
+            /// name of the variable in gene g
+            string variable_name(const Gene& g) const;
+        };
+
+        // serialization, in the format of NodeVector
+        void to_json(json& j, const CompactProgram& p);
+        void from_json(const json& j, CompactProgram& p);
+    }
+}
+#endif
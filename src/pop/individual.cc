@@ -4,6 +4,8 @@ license: GNU/GPL v3
 */
 
 #include "individual.h"
+#include "bytecode.h"
+#include "predictor.h"
 
 namespace FT{   
 namespace Pop{ 
@@ -181,37 +183,19 @@ float Individual::get_p(const size_t i, bool normalize) const
      *   should sum to 1.
      * @return weight associated with node */
         
-    vector<size_t> rts = program.roots();
-    size_t j = 0;
-    float size = rts.at(0)+1;
-    /* cout << "roots: "; */
-    /* for (auto root : rts) cout << root << ", "; */
-    /* cout << "\n"; */
-    /* cout << "size: " << size << "\n"; */
-    
-    while ( j < rts.size())
-    {
-        if (j > 1) 
-            size = rts.at(j) - rts.at(j-1);
-        
-        if (i <= rts.at(j))
-        {
-            float tmp = normalize ? p.at(j)/size : p.at(j) ;
-            /* cout << "returning " << tmp << endl; */ 
-            return normalize ? p.at(j)/size : p.at(j) ;    
-        }
-        else
-            ++j;
-    }
-    if (i >= rts.size() || j == rts.size()) 
+    if (i >= program.size()) 
     {
         cout << "WARN: bad root index attempt in get_p()\n";
         return 0.0;
     }
+    size_t j = program.root_of(i);
+    if (!normalize)
+        return p.at(j);
+    
     // normalize weight by size of subtree
-    float tmp = normalize ? p.at(j)/size : p.at(j) ;
-    /* cout << "returning " << tmp << endl; */ 
-    return tmp; 
+    vector<size_t> rts = program.roots();
+    float size = j > 0 ? rts.at(j) - rts.at(j-1) : rts.at(0)+1;
+    return p.at(j)/size; 
 }
 
 vector<float> Individual::get_p(const vector<size_t>& locs, 
@@ -235,10 +219,10 @@ shared_ptr<CLabels> Individual::fit(const Data& d,
         const Parameters& params, bool& pass)
 {
     // calculate program output matrix Phi
-    logger.log("Generating output for " + get_eqn(), 3);
+    LOG("Generating output for " + get_eqn(), 3);
     Phi = out(d, false);      
     // calculate ML model from Phi
-    logger.log("ML training on " + get_eqn(), 3);
+    LOG("ML training on " + get_eqn(), 3);
     this->ml = std::make_shared<ML>(params.ml, params.normalize, 
             params.classification, params.n_classes);
     
@@ -246,7 +230,7 @@ shared_ptr<CLabels> Individual::fit(const Data& d,
 
     if (pass)
     {
-        logger.log("Setting individual's weights...", 3);
+        LOG("Setting individual's weights...", 3);
         set_p(this->ml->get_weights(),params.feedback,
                 params.softmax_norm);
     }
@@ -271,20 +255,20 @@ shared_ptr<CLabels> Individual::fit(const Data& d,
 shared_ptr<CLabels> Individual::predict(const Data& d)
 {
     // calculate program output matrix Phi
-    logger.log("Generating output for " + get_eqn(), 3);
+    LOG("Generating output for " + get_eqn(), 3);
     // toggle validation
     MatrixXf Phi_pred = out(d, true);           
     // TODO: guarantee this is not changing nodes
 
     if (Phi_pred.size()==0)
     {
-        if (d.X.cols() == 0)
+        if (d.n_samples() == 0)
             THROW_LENGTH_ERROR("The prediction dataset has no data");
         else
             THROW_LENGTH_ERROR("Phi_pred is empty");
     }
     // calculate ML model from Phi
-    logger.log("ML predicting on " + get_eqn(), 3);
+    LOG("ML predicting on " + get_eqn(), 3);
     // assumes ML is already trained
     shared_ptr<CLabels> yhat = ml->predict(Phi_pred);
     return yhat;
@@ -293,7 +277,7 @@ shared_ptr<CLabels> Individual::predict(const Data& d)
 ArrayXXf Individual::predict_proba(const Data& d)
 {
     // calculate program output matrix Phi
-    logger.log("Generating output for " + get_eqn(), 3);
+    LOG("Generating output for " + get_eqn(), 3);
     // toggle validation
     MatrixXf Phi_pred = out(d, true);           
     // TODO: guarantee this is not changing nodes
@@ -302,7 +286,7 @@ ArrayXXf Individual::predict_proba(const Data& d)
         THROW_RUNTIME_ERROR("Phi_pred must be generated before "
                 "predict() is called\n");
     // calculate ML model from Phi
-    logger.log("ML predicting on " + get_eqn(), 3);
+    LOG("ML predicting on " + get_eqn(), 3);
     // assumes ML is already trained
     ArrayXXf yhat = ml->predict_proba(Phi_pred);
     return yhat;
@@ -318,13 +302,9 @@ MatrixXf Individual::state_to_phi(State& state)
     // we want to preserve the order of the outputs in the program 
     // in the order of the outputs in Phi. 
     // get root output types
-    this->dtypes.clear();
-    for (auto r : program.roots())
-    {
-        this->dtypes.push_back(program.at(r)->otype);
-    }
+    this->dtypes = program.root_types();
     // convert state_f to Phi
-    logger.log("converting State to Phi",3);
+    LOG("converting State to Phi",3);
     int cols;
     
     if (state.f.size()==0)
@@ -398,16 +378,39 @@ MatrixXf Individual::out(const Data& d,  bool predict)
      * @return Phi: n_features x n_samples transformation
      */
      
-    State state;
+    LOG("evaluating program " + get_eqn(),3);
+    LOG("program length: " + std::to_string(program.size()),3);
+    
+    // learning nodes are set for fit or predict mode. they are only 
+    // written when the mode changes, so predicting leaves fitted programs
+    // untouched.
+    for (const auto& n : program)
+        if (n->isNodeTrain())                     
+        {
+            NodeTrain* nt = dynamic_cast<NodeTrain*>(n.get());
+            if (nt->train == predict)
+                nt->train = !predict;
+        }
+    
+    // run the program as bytecode over tiles of samples when possible,
+    // reusing cached subtree outputs if d has a cache
+    SubtreeCache* cache = d.cache && d.cache->bound_to(d) ? d.cache : NULL;
+    Bytecode bc(program, !predict, cache);
+    if (bc.compiled)
+    {
+        this->dtypes = bc.otypes;
+        return bc.run(d);
+    }
+    
+    // each thread keeps one State whose stack slots are reused across 
+    // programs, so evaluation does not allocate once the slots are sized.
+    static thread_local State state;
+    state.clear();
+    state.allocate(get_max_state_size(), d.n_samples());
     
-    logger.log("evaluating program " + get_eqn(),3);
-    logger.log("program length: " + std::to_string(program.size()),3);
     // evaluate each node in program
     for (const auto& n : program)
     {
-        // learning nodes are set for fit or predict mode
-        if (n->isNodeTrain())                     
-            dynamic_cast<NodeTrain*>(n.get())->train = !predict;
         if(state.check(n->arity))
             n->evaluate(d, state);
         else
@@ -431,8 +434,8 @@ MatrixXf Individual::out(const Data& d, bool predict)
      */
 
     State state;
-    logger.log("evaluating program " + get_eqn(),3);
-    logger.log("program length: " + std::to_string(program.size()),3);
+    LOG("evaluating program " + get_eqn(),3);
+    LOG("program length: " + std::to_string(program.size()),3);
     // to minimize copying overhead, set the state size to the maximum 
     // it will reach for the program 
     std::map<char, size_t> state_size = get_max_state_size();
@@ -441,7 +444,7 @@ MatrixXf Individual::out(const Data& d, bool predict)
     
     // allocate memory for the state on the device
     /* std::cout << "X size: " << X.rows() << "x" << X.cols() << "\n"; */ 
-    state.allocate(state_size,d.X.cols());        
+    state.allocate(state_size,d.n_samples());        
     /* state.f.resize( */
     // evaluate each node in program
     for (const auto& n : program)
@@ -482,7 +485,7 @@ MatrixXf Individual::out(const Data& d, bool predict)
     /*     std::cout << "\n\n"; */
     /* } */
     // convert state to Phi
-    logger.log("converting State to Phi",3);
+    LOG("converting State to Phi",3);
     int cols;
     
     if (state.f.size()==0)
@@ -552,7 +555,7 @@ MatrixXf Individual::out_trace(const Data& d, vector<Trace>& state_trace)
      */
 
     State state;
-    logger.log("evaluating program " + program_str(),3);
+    LOG("evaluating program " + program_str(),3);
 
     vector<size_t> roots = program.roots();
     size_t root = 0;
@@ -627,7 +630,7 @@ MatrixXf Individual::out_trace(const Data& d, vector<Trace>& state_trace)
     // allocate memory for the state on the device
     /* std::cout << "X size: " << X.rows() << "x" 
      * << X.cols() << "\n"; */ 
-    state.allocate(state_size,d.X.cols());
+    state.allocate(state_size,d.n_samples());
 
     vector<size_t> roots = program.roots();
     size_t root = 0;
@@ -678,7 +681,7 @@ MatrixXf Individual::out_trace(const Data& d, vector<Trace>& state_trace)
     state.copy_to_host();
     
     // convert state_f to Phi
-    logger.log("converting State to Phi",3);
+    LOG("converting State to Phi",3);
     int cols;
     
     if (state.f.size()==0)
@@ -778,11 +781,7 @@ string Individual::get_eqn()
     }
     // tie state outputs together to return representation
     // order by root types
-    vector<char> root_types;
-    for (auto r : program.roots())
-    {
-        root_types.push_back(program.at(r)->otype);
-    }
+    vector<char> root_types = program.root_types();
     std::map<char,int> rows;
     rows['f']=0;
     rows['c']=0;
@@ -828,11 +827,7 @@ vector<string> Individual::get_features()
     }
     // tie state outputs together to return representation
     // order by root types
-    vector<char> root_types;
-    for (auto r : program.roots())
-    {
-        root_types.push_back(program.at(r)->otype);
-    }
+    vector<char> root_types = program.root_types();
     std::map<char,int> rows;
     rows['f']=0;
     rows['c']=0;
@@ -882,16 +877,7 @@ unsigned int Individual::get_dim()
      */
     // only calculate if dim hasn't been assigned
     if (dim == 0)        
-    {           
-        unsigned int ca=0;     // current arity
-        
-        for (unsigned int i = program.size(); i>0; --i)
-        {
-            ca += program.at(i-1)->total_arity();
-            if (ca == 0) ++dim;
-            else --ca;
-        }
-    }
+        dim = program.roots().size();
     return dim;   
 }
 
@@ -966,16 +952,7 @@ void Individual::set_obj(const vector<string>& objectives)
 
 unsigned int Individual::set_complexity()
 {
-    complexity = 0;
-    std::map<char, vector<unsigned int>> state_c; 
-    
-    for (const auto& n : program)
-        n->eval_complexity(state_c);
-
-    for (const auto& s : state_c)
-        for (const auto& t : s.second)
-            complexity += t;
-    
+    complexity = program.complexity();
     return complexity;
 }
 
@@ -992,6 +969,12 @@ string Individual::program_str() const
     return s;
 }
 
+string Individual::export_cpp(size_t n_features, const Normalizer* N,
+                              const string& name) const
+{
+    return Predictor(*this, n_features, N).to_cpp(name);
+}
+
 std::map<char, size_t> Individual::get_max_state_size()
 {
     // max stack size is calculated using node arities
@@ -1000,9 +983,11 @@ std::map<char, size_t> Individual::get_max_state_size()
     stack_size['f'] = 0;
     stack_size['c'] = 0; 
     stack_size['b'] = 0; 
+    stack_size['z'] = 0; 
     max_stack_size['f'] = 0;
     max_stack_size['c'] = 0;
     max_stack_size['b'] = 0;
+    max_stack_size['z'] = 0;
 
     for (const auto& n : program)   
     {   	
@@ -1020,10 +1005,10 @@ shared_ptr<CLabels> Individual::fit_tune(const Data& d,
         const Parameters& params, bool set_default)
 {
     // calculate program output matrix Phi
-    logger.log("Generating output for " + get_eqn(), 3);
+    LOG("Generating output for " + get_eqn(), 3);
     Phi = out(d, false);      
     // calculate ML model from Phi
-    logger.log("ML training on " + get_eqn(), 3);
+    LOG("ML training on " + get_eqn(), 3);
     this->ml = std::make_shared<ML>(params.ml, params.normalize, 
             params.classification, params.n_classes);
     bool pass = true; 
@@ -1032,7 +1017,7 @@ shared_ptr<CLabels> Individual::fit_tune(const Data& d,
 
     if (pass)
     {
-        logger.log("Setting individual's weights...", 3);
+        LOG("Setting individual's weights...", 3);
         set_p(this->ml->get_weights(),params.feedback,
                 params.softmax_norm);
     }
@@ -103,6 +103,12 @@ public:
     /// return program name list 
     string program_str() const;
 
+    /// C++ header source computing the predictions of this individual on
+    /// samples of n_features values, normalized with N if it is given.
+    /// see Predictor::to_cpp().
+    string export_cpp(size_t n_features, const Normalizer* N=nullptr,
+                      const string& name="feat_model") const;
+
     /// setting and getting from individuals vector
     /* const std::unique_ptr<Node> operator [](int i) const {return program.at(i);} */ 
     /* const std::unique_ptr<Node> & operator [](int i) {return program.at(i);} */
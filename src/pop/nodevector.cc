@@ -23,6 +23,7 @@ NodeVector::NodeVector(const NodeVector& other)
     this->resize(0);
     for (const auto& p : other)
         this->push_back(p->clone());
+    index = other.index;
 }
 
 NodeVector& NodeVector::operator=(NodeVector const& other)
@@ -32,8 +33,106 @@ NodeVector& NodeVector::operator=(NodeVector const& other)
     this->resize(0);
     for (const auto& p : other)
         this->push_back(p->clone());
+    index = other.index;
     return *this; 
 }
+
+void Structure::build(const vector<std::unique_ptr<Node>>& p)
+{
+    /*!
+     * walks the program once, keeping a stack of subtrees for each type the
+     * same way evaluation does. each node pops its arguments, which gives 
+     * the start of its subtree and its complexity, 
+     *
+     *  \f$ C(n) = c_n * (1 + \sum_{a=1}^k C(a)) \f$,
+     *
+     * as in Node::eval_complexity(). whatever is left on the stacks are the
+     * roots. depth and dimension are then passed down from each parent in a
+     * reverse pass.
+     */
+    size_t n = p.size();
+    const size_t none = size_t(-1);
+
+    start.resize(n);
+    complexity.resize(n);
+    depth.assign(n, 0);
+    dim.assign(n, 0);
+    roots.clear();
+    root_types.clear();
+    total_complexity = 0;
+
+    vector<size_t> parent(n, none);
+    std::map<char, vector<size_t>> stack;
+    
+    for (size_t i = 0; i < n; ++i)
+    {
+        start.at(i) = i;
+        unsigned c_args = 1;
+        for (const auto& a : p.at(i)->arity)
+        {
+            vector<size_t>& s = stack[a.first];
+            for (unsigned j = 0; j < a.second && !s.empty(); ++j)
+            {
+                size_t arg = s.back();
+                s.pop_back();
+                parent.at(arg) = i;
+                start.at(i) = std::min(start.at(i), start.at(arg));
+                c_args += complexity.at(arg);
+            }
+        }
+        complexity.at(i) = p.at(i)->complexity*c_args;
+        stack[p.at(i)->otype].push_back(i);
+    }
+
+    for (const auto& s : stack)
+        roots.insert(roots.end(), s.second.begin(), s.second.end());
+    std::sort(roots.begin(), roots.end());
+    
+    for (size_t j = 0; j < roots.size(); ++j)
+    {
+        dim.at(roots.at(j)) = j;
+        root_types.push_back(p.at(roots.at(j))->otype);
+        total_complexity += complexity.at(roots.at(j));
+    }
+    // arguments precede their parents
+    for (size_t i = n; i > 0; --i)
+    {
+        size_t par = parent.at(i-1);
+        if (par != none)
+        {
+            dim.at(i-1) = dim.at(par);
+            depth.at(i-1) = depth.at(par) + 1;
+        }
+    }
+}
+
+void NodeVector::update_structure() { index.build(*this); }
+
+bool NodeVector::indexed() const 
+{ 
+    if (index.start.size() != this->size())
+        return false;
+#ifndef NDEBUG
+    // an index of the right size can still describe a program that was 
+    // changed in place without calling update_structure()
+    Structure fresh;
+    fresh.build(*this);
+    assert(fresh.roots == index.roots 
+            && fresh.root_types == index.root_types
+            && fresh.start == index.start && fresh.depth == index.depth
+            && fresh.dim == index.dim && fresh.complexity == index.complexity
+            && " program changed without update_structure()");
+#endif
+    return true;
+}
+
+const Structure& NodeVector::structure(Structure& tmp) const
+{
+    if (indexed())
+        return index;
+    tmp.build(*this);
+    return tmp;
+}
         
 vector<Node*> NodeVector::get_data(int start,int end)
 {
@@ -54,6 +153,9 @@ vector<Node*> NodeVector::get_data(int start,int end)
 /// returns indices of root nodes 
 vector<size_t> NodeVector::roots() const
 {
+    if (indexed())
+        return index.roots;
+
     // find "root" nodes of program, where roots are final values that output 
     // something directly to the state
     // assumes a program's subtrees to be contiguous
@@ -77,6 +179,30 @@ vector<size_t> NodeVector::roots() const
     return indices; 
 }
 
+vector<char> NodeVector::root_types() const
+{
+    Structure tmp;
+    return structure(tmp).root_types;
+}
+
+size_t NodeVector::root_of(size_t i) const
+{
+    Structure tmp;
+    return structure(tmp).dim.at(i);
+}
+
+unsigned NodeVector::depth(size_t i) const
+{
+    Structure tmp;
+    return structure(tmp).depth.at(i);
+}
+
+unsigned NodeVector::complexity() const
+{
+    Structure tmp;
+    return structure(tmp).total_complexity;
+}
+
 size_t NodeVector::subtree(size_t i, char otype, string indent) const 
 {
 
@@ -99,6 +225,9 @@ size_t NodeVector::subtree(size_t i, char otype, string indent) const
        THROW_LENGTH_ERROR("Attempting got grab subtree with index " 
                + to_string(i) + " and program size " 
                + to_string(this->size()));
+
+   if (otype=='0' && indexed())
+       return index.start.at(i);
           
    /* cout << indent << "getting subtree(" << i << "," */ 
    /*     << otype << ") for " << this->at(i)->name */ 
@@ -381,6 +510,7 @@ void NodeVector::make_program(const NodeVector& functions,
     
     // reverse program so that it is post-fix notation
     std::reverse(begin(), end());
+    update_structure();
     assert(is_valid_program(terminals.size(), longitudinalMap));
     if (!is_valid_program(terminals.size(), longitudinalMap))
     {
@@ -504,6 +634,7 @@ void from_json(const json& j, NodeVector& nv)
     }
     json check;
     to_json(check, nv);
+    nv.update_structure();
 }
 
 } // Pop
@@ -16,6 +16,23 @@ namespace FT{
         using namespace Op;
         ////////////////////////////////////////////////////////////////////////////////// Declarations
 
+        /*!
+         * @class Structure
+         * @brief flat index of the trees in a program, built in one pass.
+         */
+        struct Structure {
+            vector<size_t> roots;          ///< root positions, ascending
+            vector<char> root_types;       ///< output type of each root
+            vector<size_t> start;          ///< first index of each node's subtree
+            vector<unsigned> depth;        ///< depth of each node below its root
+            vector<unsigned> dim;          ///< root (dimension) each node is in
+            vector<unsigned> complexity;   ///< complexity of each node's subtree
+            unsigned total_complexity = 0; ///< summed complexity of the roots
+
+            /// indexes program p
+            void build(const vector<std::unique_ptr<Node>>& p);
+        };
+
         /*!
          * @class NodeVector
          * @brief an extension of a vector of unique pointers to nodes 
@@ -45,7 +62,25 @@ namespace FT{
             /// returns indices of root nodes 
             vector<size_t> roots() const;
 
+            /// returns output types of the root nodes
+            vector<char> root_types() const;
+
             size_t subtree(size_t i, char otype='0', string indent="> ") const;
+
+            /// index of the root (i.e. dimension) whose subtree contains i
+            size_t root_of(size_t i) const;
+
+            /// depth of node i below its root
+            unsigned depth(size_t i) const;
+
+            /// complexity of the program
+            unsigned complexity() const;
+
+            /// rebuilds the structural index. call after changing the 
+            /// program, since the queries above only trust an index that 
+            /// matches the program size. debug builds assert that the 
+            /// index matches the program.
+            void update_structure();
             
             void set_weights(vector<vector<float>>& weights);
             
@@ -66,6 +101,16 @@ namespace FT{
                               const vector<float>& op_weights, 
                               int dim, char otype, 
                               vector<string> longitudinalMap, const vector<char>& term_types);
+
+            private:
+                Structure index;    ///< cached roots, extents and complexity
+
+                /// true if the cached index describes this program
+                bool indexed() const;
+
+                /// returns the cached index, or builds a copy into tmp if 
+                /// the cache is out of date
+                const Structure& structure(Structure& tmp) const;
             
         }; //NodeVector
         // serializatoin
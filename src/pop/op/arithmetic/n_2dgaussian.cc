@@ -32,11 +32,12 @@ namespace FT{
             #ifndef USE_CUDA
             void Node2dGaussian::evaluate(const Data& data, State& state)
             {
-                ArrayXf x1 = state.pop<float>();
-                ArrayXf x2 = state.pop<float>();
+                ArrayXf& x1 = state.pop<float>();
+                ArrayXf& x2 = state.get<float>().top();
                 
-                state.push<float>(limited(exp(-1*(pow(W[0]*(x1-x1.mean()), 2)/(2*variance(x1)) 
-                              + pow(W[1]*(x2 - x2.mean()), 2)/variance(x2)))));
+                CPU_Gaussian2D(x2.data(), x1.data(), x2.data(), x2.size(),
+                               x1.mean(), variance(x1), x2.mean(), variance(x2),
+                               W[0], W[1]);
             }
             #else
             /// Evaluates the node and updates the state states. 
@@ -30,7 +30,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeCos::evaluate(const Data& data, State& state)
             {
-                state.push<float>(limited(cos(W[0] * state.pop<float>())));
+                ArrayXf& x = state.get<float>().top();
+                CPU_Cos(x.data(), x.data(), x.size(), W[0]);
             }
             #else
             void NodeCos::evaluate(const Data& data, State& state)
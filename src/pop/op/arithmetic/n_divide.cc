@@ -31,12 +31,10 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeDivide::evaluate(const Data& data, State& state)
             {
-                ArrayXf x1 = state.pop<float>();
-                ArrayXf x2 = state.pop<float>();
+                ArrayXf& x1 = state.pop<float>();
+                ArrayXf& x2 = state.pop<float>();
                 // safe division returns x1/x2 if x2 != 0, and MAX_FLT otherwise               
-                ArrayXf ret = (this->W[0] * x1) / (this->W[1] * x2);
-                clean(ret);
-                state.push<float>(ret); 
+                state.push<float>(limited((this->W[0] * x1) / (this->W[1] * x2))); 
             }
             #else
             void NodeDivide::evaluate(const Data& data, State& state)
@@ -30,11 +30,11 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeExponent::evaluate(const Data& data, State& state)
             {
-	            ArrayXf x1 = state.pop<float>();
-                ArrayXf x2 = state.pop<float>();
+	            ArrayXf& x1 = state.pop<float>();
+                ArrayXf& x2 = state.get<float>().top();
 
-                state.push<float>(limited(pow(this->W[0] * x1, 
-                                               this->W[1] * x2)));
+                CPU_Exponent(x2.data(), x1.data(), x2.data(), x2.size(), 
+                             this->W[0], this->W[1]);
             }
             #else
             void NodeExponent::evaluate(const Data& data, State& state)
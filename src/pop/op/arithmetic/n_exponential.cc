@@ -31,7 +31,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeExponential::evaluate(const Data& data, State& state)
             {
-                state.push<float>(limited(exp(this->W[0] * state.pop<float>())));
+                ArrayXf& x = state.get<float>().top();
+                CPU_Exp(x.data(), x.data(), x.size(), W[0]);
             }
             #else
             void NodeExponential::evaluate(const Data& data, State& state)
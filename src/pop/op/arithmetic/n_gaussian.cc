@@ -31,7 +31,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeGaussian::evaluate(const Data& data, State& state)
             {
-                state.push<float>(limited(exp(-pow(W[0] - state.pop<float>(), 2))));
+                ArrayXf& x = state.get<float>().top();
+                CPU_Gaussian(x.data(), x.data(), x.size(), W[0]);
             }
             #else
             void NodeGaussian::evaluate(const Data& data, State& state)
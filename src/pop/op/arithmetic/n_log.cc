@@ -30,8 +30,8 @@ namespace FT{
             /// Safe log: pushes log(abs(x)) or MIN_FLT if x is near zero. 
             void NodeLog::evaluate(const Data& data, State& state)
             {
-	            ArrayXf x = state.pop<float>();
-                state.push<float>( (abs(x) > NEAR_ZERO).select(log(abs(W[0] * x)),MIN_FLT));
+                ArrayXf& x = state.get<float>().top();
+                CPU_Log(x.data(), x.data(), x.size(), W[0]);
             }
             #else
             void NodeLog::evaluate(const Data& data, State& state)
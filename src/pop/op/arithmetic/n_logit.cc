@@ -29,7 +29,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeLogit::evaluate(const Data& data, State& state)
             {
-                state.push<float>(1/(1+(limited(exp(-W[0]*state.pop<float>())))));
+                ArrayXf& x = state.get<float>().top();
+                CPU_Logit(x.data(), x.data(), x.size(), W[0]);
             }
             #else
             void NodeLogit::evaluate(const Data& data, State& state)
@@ -29,8 +29,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeMultiply::evaluate(const Data& data, State& state)
             {
-                ArrayXf x1 = state.pop<float>();
-                ArrayXf x2 = state.pop<float>();
+                ArrayXf& x1 = state.pop<float>();
+                ArrayXf& x2 = state.pop<float>();
                
                 state.push<float>(limited(W[0]*x1 * W[1]*x2));
             }
@@ -30,9 +30,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeRelu::evaluate(const Data& data, State& state)
             {
-                ArrayXf x = state.pop<float>();
-                ArrayXf res = (W[0] * x > 0).select(W[0]*x, ArrayXf::Zero(x.size())+0.01); 
-                state.push<float>(res);
+                ArrayXf& x = state.pop<float>();
+                state.push<float>((W[0] * x > 0).select(W[0]*x, 0.01f));
             }
             #else
             /// Evaluates the node and updates the state states. 
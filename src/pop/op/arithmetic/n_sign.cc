@@ -22,13 +22,10 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeSign::evaluate(const Data& data, State& state)
             {
-	            ArrayXf x = state.pop<float>();
-                ArrayXf ones = ArrayXf::Ones(x.size());
-
-	            ArrayXf res = ( x > 0).select(ones, 
-                                                    (x == 0).select(ArrayXf::Zero(x.size()), 
-                                                                    -1*ones)); 
-                state.push<float>(res);
+	            ArrayXf& x = state.pop<float>();
+                state.push<float>((x > 0).select(ArrayXf::Ones(x.size()), 
+                                            (x == 0).select(ArrayXf::Zero(x.size()), 
+                                                            -ArrayXf::Ones(x.size())))); 
             }
             #else
             void NodeSign::evaluate(const Data& data, State& state)
@@ -31,7 +31,8 @@ namespace FT{
             void NodeSin::evaluate(const Data& data, State& state)
             {
 
-                state.push<float>(limited(sin(W[0]*state.pop<float>())));
+                ArrayXf& x = state.get<float>().top();
+                CPU_Sin(x.data(), x.data(), x.size(), W[0]);
             }
             #else
             void NodeSin::evaluate(const Data& data, State& state)
@@ -22,9 +22,9 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeStep::evaluate(const Data& data, State& state)
             {
-	            ArrayXf x = state.pop<float>();
-	            ArrayXf res = (x > 0).select(ArrayXf::Ones(x.size()), ArrayXf::Zero(x.size())); 
-                state.push<float>(res);
+	            ArrayXf& x = state.pop<float>();
+                state.push<float>((x > 0).select(ArrayXf::Ones(x.size()), 
+                                                 ArrayXf::Zero(x.size()))); 
             }
             #else
             void NodeStep::evaluate(const Data& data, State& state)
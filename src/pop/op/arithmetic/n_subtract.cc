@@ -30,8 +30,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeSubtract::evaluate(const Data& data, State& state)
             {
-                ArrayXf x1 = state.pop<float>();
-                ArrayXf x2 = state.pop<float>();
+                ArrayXf& x1 = state.pop<float>();
+                ArrayXf& x2 = state.pop<float>();
                 state.push<float>(limited(this->W[0]*x1 - this->W[1]*x2));
             }
             #else
@@ -24,8 +24,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeIfThenElse::evaluate(const Data& data, State& state)
             {
-                ArrayXf f1 = state.pop<float>();
-                ArrayXf f2 = state.pop<float>();
+                ArrayXf& f1 = state.pop<float>();
+                ArrayXf& f2 = state.pop<float>();
                 state.push<float>(limited(state.pop<bool>().select(f1,f2)));
             }
             #else
@@ -0,0 +1,289 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "kernels.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include "../../init.h"
+
+// x86-64 Linux builds clone every kernel for AVX-512, AVX2 and the baseline
+// ISA, and the loader picks the clone for the running CPU. other platforms
+// get the baseline version only.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) \
+    && defined(__linux__)
+    #define KERNEL __attribute__((target_clones("avx512f","avx2","default")))
+#else
+    #define KERNEL
+#endif
+
+namespace FT{
+
+    namespace Pop{
+        namespace Op{
+
+            static const float HI = std::numeric_limits<float>::max();
+            static const float LO = std::numeric_limits<float>::lowest();
+            static const float INF = std::numeric_limits<float>::infinity();
+            static const float QNAN = std::numeric_limits<float>::quiet_NaN();
+
+            /// largest argument the sin/cos range reduction is accurate for
+            static const float TRIG_MAX = 8192.0f;
+
+            /*
+             * The functions below follow the single precision routines of
+             * the Cephes library. They are written without branches so that
+             * the loops calling them vectorize.
+             */
+
+            static inline int32_t as_int(float x)
+            {
+                int32_t i;
+                std::memcpy(&i, &x, sizeof(i));
+                return i;
+            }
+
+            static inline float as_float(int32_t i)
+            {
+                float x;
+                std::memcpy(&x, &i, sizeof(x));
+                return x;
+            }
+
+            /// same as Node::limited() on a single value
+            static inline float limit(float v)
+            {
+                v = std::isnan(v) ? 0.0f : v;
+                v = v < LO ? LO : v;
+                return v > HI ? HI : v;
+            }
+
+            static inline float exp_(float x)
+            {
+                // beyond these bounds the result is 0 or inf anyway
+                float xc = x < -104.0f ? -104.0f : x;
+                xc = xc > 89.0f ? 89.0f : xc;
+
+                // x = n*log(2) + r, |r| <= log(2)/2
+                float t = xc * 1.44269504088896341f;
+                int32_t n = int32_t(t + (t < 0 ? -0.5f : 0.5f));
+                float r = xc - n * 0.693359375f;
+                r = r - n * -2.12194440e-4f;
+
+                float p = 1.9875691500E-4f;
+                p = p * r + 1.3981999507E-3f;
+                p = p * r + 8.3334519073E-3f;
+                p = p * r + 4.1665795894E-2f;
+                p = p * r + 1.6666665459E-1f;
+                p = p * r + 5.0000001201E-1f;
+                p = p * r * r + r + 1.0f;
+
+                // scale by 2^n in two steps so that neither factor leaves
+                // the range of normal floats
+                int32_t n1 = n / 2;
+                int32_t n2 = n - n1;
+                p = p * as_float((n1 + 127) << 23) * as_float((n2 + 127) << 23);
+                return std::isnan(x) ? x : p;
+            }
+
+            /// natural log for x >= 0
+            static inline float log_(float x)
+            {
+                // bring denormals into the normal range
+                bool denormal = x < std::numeric_limits<float>::min();
+                float xs = denormal ? x * 8388608.0f : x;
+
+                // x = m * 2^e, m in [sqrt(2)/2, sqrt(2))
+                int32_t i = as_int(xs);
+                int32_t e = ((i >> 23) & 0xff) - 126 - (denormal ? 23 : 0);
+                float m = as_float((i & 0x007fffff) | 0x3f000000);
+                bool low = m < 0.707106781186547524f;
+                e = low ? e - 1 : e;
+                m = low ? m + m - 1.0f : m - 1.0f;
+
+                float z = m * m;
+                float p = 7.0376836292E-2f;
+                p = p * m - 1.1514610310E-1f;
+                p = p * m + 1.1676998740E-1f;
+                p = p * m - 1.2420140846E-1f;
+                p = p * m + 1.4249322787E-1f;
+                p = p * m - 1.6668057665E-1f;
+                p = p * m + 2.0000714765E-1f;
+                p = p * m - 2.4999993993E-1f;
+                p = p * m + 3.3333331174E-1f;
+                float y = p * m * z;
+                y += e * -2.12194440e-4f;
+                y += -0.5f * z;
+                float r = m + y + e * 0.693359375f;
+
+                r = x == 0 ? -INF : r;
+                r = x == INF ? INF : r;
+                return x < 0 || std::isnan(x) ? QNAN : r;
+            }
+
+            /// sin (cosine is false) or cos (cosine is true) of x, for
+            /// |x| <= TRIG_MAX
+            static inline float sincos_(float x, bool cosine)
+            {
+                float ax = x < 0 ? -x : x;
+
+                // reduce to [-pi/4, pi/4] around a multiple j of pi/4
+                int32_t j = int32_t(ax * 1.27323954473516f);
+                j = (j + 1) & ~1;
+                float y = float(j);
+                float r = ((ax - y * 0.78515625f)
+                           - y * 2.4187564849853515625e-4f)
+                          - y * 3.77489497744594108e-8f;
+                j &= 7;
+
+                bool negate = cosine ? (j > 3) != (j % 4 > 1)
+                                     : (j > 3) != (x < 0);
+                j &= 3;
+
+                float z = r * r;
+                float c = 2.443315711809948E-005f;
+                c = c * z - 1.388731625493765E-003f;
+                c = c * z + 4.166664568298827E-002f;
+                c = c * z * z - 0.5f * z + 1.0f;
+
+                float s = -1.9515295891E-4f;
+                s = s * z + 8.3321608736E-3f;
+                s = s * z - 1.6666654611E-1f;
+                s = s * z * r + r;
+
+                bool use_cos = (j == 1 || j == 2) != cosine;
+                float v = use_cos ? c : s;
+                return negate ? -v : v;
+            }
+
+            static inline float tanh_(float x)
+            {
+                float ax = x < 0 ? -x : x;
+
+                // small arguments use a polynomial, large ones exp
+                float z = x * x;
+                float p = -5.70498872745E-3f;
+                p = p * z + 2.06390887954E-2f;
+                p = p * z - 5.37397155531E-2f;
+                p = p * z + 1.33314422036E-1f;
+                p = p * z - 3.33332819422E-1f;
+                p = p * z * x + x;
+
+                float t = 1.0f - 2.0f / (exp_(2.0f * ax) + 1.0f);
+                t = x < 0 ? -t : t;
+                return ax < 0.625f ? p : t;
+            }
+
+            /// sin/cos are computed in place for arguments the reduction
+            /// handles; the others are stored as is and fixed up here with
+            /// the library call. valid outputs lie in [-1, 1].
+            static void trig_fixup(float * out, size_t N, float (*f)(float))
+            {
+                for (size_t i = 0; i < N; ++i)
+                    if (!(std::abs(out[i]) <= 2.0f))
+                        out[i] = limit(f(out[i]));
+            }
+
+            KERNEL
+            void CPU_Exp(float * out, const float * x, size_t N, float W0)
+            {
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                    out[i] = limit(exp_(W0 * x[i]));
+            }
+
+            KERNEL
+            void CPU_Log(float * out, const float * x, size_t N, float W0)
+            {
+                float nz = NEAR_ZERO;
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                {
+                    float a = std::abs(x[i]);
+                    out[i] = a > nz ? limit(log_(std::abs(W0 * x[i]))) : LO;
+                }
+            }
+
+            KERNEL
+            void CPU_Logit(float * out, const float * x, size_t N, float W0)
+            {
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                    out[i] = 1.0f / (1.0f + limit(exp_(-W0 * x[i])));
+            }
+
+            KERNEL
+            void CPU_Sin(float * out, const float * x, size_t N, float W0)
+            {
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                {
+                    float v = W0 * x[i];
+                    out[i] = std::abs(v) <= TRIG_MAX ? sincos_(v, false) : v;
+                }
+                trig_fixup(out, N, [](float v){ return std::sin(v); });
+            }
+
+            KERNEL
+            void CPU_Cos(float * out, const float * x, size_t N, float W0)
+            {
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                {
+                    float v = W0 * x[i];
+                    out[i] = std::abs(v) <= TRIG_MAX ? sincos_(v, true) : v;
+                }
+                trig_fixup(out, N, [](float v){ return std::cos(v); });
+            }
+
+            KERNEL
+            void CPU_Tanh(float * out, const float * x, size_t N, float W0)
+            {
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                    out[i] = limit(tanh_(W0 * x[i]));
+            }
+
+            KERNEL
+            void CPU_Gaussian(float * out, const float * x, size_t N, float W0)
+            {
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                {
+                    float d = W0 - x[i];
+                    out[i] = limit(exp_(-(d * d)));
+                }
+            }
+
+            KERNEL
+            void CPU_Gaussian2D(float * out, const float * x1, const float * x2,
+                                size_t N, float x1mean, float x1var,
+                                float x2mean, float x2var, float W0, float W1)
+            {
+                #pragma omp simd
+                for (size_t i = 0; i < N; ++i)
+                {
+                    float d1 = W0 * (x1[i] - x1mean);
+                    float d2 = W1 * (x2[i] - x2mean);
+                    out[i] = limit(exp_(-1 * (d1 * d1 / (2 * x1var)
+                                              + d2 * d2 / x2var)));
+                }
+            }
+
+            /// pow has no vectorized form here, since negative bases with
+            /// integer exponents must keep their sign; this only fuses the
+            /// weights and clamp into the library call.
+            void CPU_Exponent(float * out, const float * x1, const float * x2,
+                              size_t N, float W0, float W1)
+            {
+                for (size_t i = 0; i < N; ++i)
+                    out[i] = limit(std::pow(W0 * x1[i], W1 * x2[i]));
+            }
+        }
+    }
+}
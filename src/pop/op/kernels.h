@@ -0,0 +1,36 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+#ifndef CPU_KERNELS
+#define CPU_KERNELS
+
+#include <cstddef>
+
+namespace FT{
+    namespace Pop{
+        namespace Op{
+            /*
+             * Vectorized kernels for the transcendental operators. Each one
+             * applies the node weights, the function and the clamp of
+             * Node::limited() in a single pass, writing N values to out.
+             * out may be one of the inputs. The kernels are built for
+             * AVX-512, AVX2 and the baseline instruction set, and the
+             * version matching the CPU is chosen at load time.
+             */
+            void CPU_Exp(float * out, const float * x, size_t N, float W0);
+            void CPU_Log(float * out, const float * x, size_t N, float W0);
+            void CPU_Logit(float * out, const float * x, size_t N, float W0);
+            void CPU_Sin(float * out, const float * x, size_t N, float W0);
+            void CPU_Cos(float * out, const float * x, size_t N, float W0);
+            void CPU_Tanh(float * out, const float * x, size_t N, float W0);
+            void CPU_Gaussian(float * out, const float * x, size_t N, float W0);
+            void CPU_Gaussian2D(float * out, const float * x1, const float * x2,
+                                size_t N, float x1mean, float x1var,
+                                float x2mean, float x2var, float W0, float W1);
+            void CPU_Exponent(float * out, const float * x1, const float * x2,
+                              size_t N, float W0, float W1);
+        }
+    }
+}
+#endif
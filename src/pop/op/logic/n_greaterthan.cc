@@ -20,8 +20,8 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeGreaterThan::evaluate(const Data& data, State& state)
             {
-                ArrayXf x1 = state.pop<float>();
-                ArrayXf x2 = state.pop<float>();
+                ArrayXf& x1 = state.pop<float>();
+                ArrayXf& x2 = state.pop<float>();
                 state.push<bool>(x1 > x2);
             }
             #else
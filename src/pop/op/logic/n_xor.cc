@@ -22,12 +22,10 @@ namespace FT
             /// Evaluates the node and updates the state states. 
             void NodeXor::evaluate(const Data& data, State& state)
             {
-	            ArrayXb x1 = state.pop<bool>();
-                ArrayXb x2 = state.pop<bool>();
+	            ArrayXb& x1 = state.pop<bool>();
+                ArrayXb& x2 = state.pop<bool>();
 
-                ArrayXb res = (x1 != x2).select(ArrayXb::Ones(x1.size()), ArrayXb::Zero(x1.size()));
-
-                state.push<bool>(res);
+                state.push<bool>(x1 != x2);
                 
             }
             #else
@@ -24,15 +24,17 @@ namespace FT{
             {
                 try
                 {
-                    state.z.push(data.Z.at(zName));
+                    // a view: the samples stay where they are in data
+                    state.z.push(LongView(&data.longitudinal(zName)));
                 }
                 catch (const std::out_of_range& e) 
                 {
                     cout << "out of range error on ";
-                    cout << "state.z.push(data.Z.at(" << zName << "))\n";
-                    cout << "data.Z size: " << data.Z.size() << "\n";
+                    cout << "data.longitudinal(" << zName << ")\n";
+                    cout << "data.Z size: " 
+                         << data.get_longitudinal().size() << "\n";
                     cout << "data.Z keys:\n";
-                    for (const auto& keys : data.Z)
+                    for (const auto& keys : data.get_longitudinal())
                         cout << keys.first << ",";
                     cout << "\n";
                 }
@@ -20,28 +20,13 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeMax::evaluate(const Data& data, State& state)
             {
-                ArrayXf tmp(state.z.top().first.size());
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                    tmp(x) = limited(state.z.top().first[x]).maxCoeff();
-
-                state.z.pop();
-                
-                state.push<float>(tmp);
+                state.push<float>(state.z.pop().stats().max);
                 
             }
             #else
             void NodeMax::evaluate(const Data& data, State& state)
             {
-                
-                ArrayXf tmp(state.z.top().first.size());
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                    tmp(x) = limited(state.z.top().first[x]).maxCoeff();
-
-                state.z.pop();
+                ArrayXf tmp = state.z.pop().stats().max;
                 
                 GPU_Variable(state.dev_f, tmp.data(), state.idx[otype], state.N);
 
@@ -21,31 +21,14 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeMin::evaluate(const Data& data, State& state)
             {
-                ArrayXf tmp(state.z.top().first.size());
-                
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                    tmp(x) = limited(state.z.top().first[x]).minCoeff();
-                    
-                state.z.pop();
-
-                state.push<float>(tmp);
+                state.push<float>(state.z.pop().stats().min);
                 
             }
             #else
             void NodeMin::evaluate(const Data& data, State& state)
             {
+                ArrayXf tmp = state.z.pop().stats().min;
                 
-                ArrayXf tmp(state.z.top().first.size());
-                
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                    tmp(x) = limited(state.z.top().first[x]).minCoeff();
-                    
-                state.z.pop();
-
                 GPU_Variable(state.dev_f, tmp.data(), state.idx[otype], state.N);
 
                 
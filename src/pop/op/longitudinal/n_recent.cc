@@ -20,39 +20,13 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeRecent::evaluate(const Data& data, State& state)
             {
-                ArrayXf tmp(state.z.top().first.size());
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                {
-                    // find max time
-                    ArrayXf::Index maxIdx; 
-                    float maxtime = state.z.top().second[x].maxCoeff(&maxIdx);
-                    // return value at max time 
-                    tmp(x) = state.z.top().first[x](maxIdx);
-                }
-
-                state.z.pop();
-                
-                state.push<float>(tmp);
+                state.push<float>(state.z.pop().stats().recent);
                 
             }
             #else
             void NodeRecent::evaluate(const Data& data, State& state)
             {
-                ArrayXf tmp(state.z.top().first.size());
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                {
-                    // find max time
-                    ArrayXf::Index maxIdx; 
-                    float maxtime = state.z.top().second[x].maxCoeff(&maxIdx);
-                    // return value at max time 
-                    tmp(x) = state.z.top().first[x](maxIdx);
-                }
-
-                state.z.pop();
+                ArrayXf tmp = state.z.pop().stats().recent;
                 
                 GPU_Variable(state.dev_f, tmp.data(), state.idx[otype], state.N);
             }
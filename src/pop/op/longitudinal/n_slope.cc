@@ -22,34 +22,14 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeSlope::evaluate(const Data& data, State& state)
             {
-                ArrayXf tmp(state.z.top().first.size());
-                
-                for(int x = 0; x < state.z.top().first.size(); x++)                    
-                {
-                    /* cout << "x: " << x << "\n"; */
-                    /* cout << "value: " << state.z.top().first[x].transpose() << "\n"; */
-                    /* cout << "date: " << state.z.top().second[x].transpose() << "\n"; */
-                    tmp(x) = slope(limited(state.z.top().second[x]), 
-                                   limited(state.z.top().first[x]));
-                    /* cout << "slope: " << tmp(x) << "\n"; */
-                }
-                    
-                state.z.pop();
-
-                state.push<float>(tmp);
+                state.push<float>(state.z.pop().stats().slope);
                 
             }
             #else
             void NodeSlope::evaluate(const Data& data, State& state)
             {
+                ArrayXf tmp = state.z.pop().stats().slope;
                 
-                ArrayXf tmp(state.z.top().first.size());
-                
-                for(int x = 0; x < state.z.top().first.size(); x++)                    
-                    tmp(x) = slope(limited(state.z.top().first[x]), limited(state.z.top().second[x]));
-                    
-                state.z.pop();
-
                 GPU_Variable(state.dev_f, tmp.data(), state.idx[otype], state.N);
 
                 
@@ -22,31 +22,14 @@ namespace FT{
             /// Evaluates the node and updates the state states. 
             void NodeVar::evaluate(const Data& data, State& state)
             {
-                ArrayXf tmp(state.z.top().first.size());
-                
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                    tmp(x) = variance(limited(state.z.top().first[x]));
-                    
-                state.z.pop();
-
-                state.push<float>(tmp);
+                state.push<float>(state.z.pop().stats().variance);
                 
             }
             #else
             void NodeVar::evaluate(const Data& data, State& state)
             {
+                ArrayXf tmp = state.z.pop().stats().variance;
                 
-                ArrayXf tmp(state.z.top().first.size());
-                
-                int x;
-                
-                for(x = 0; x < state.z.top().first.size(); x++)
-                    tmp(x) = variance(limited(state.z.top().first[x]));
-                    
-                state.z.pop();
-
                 GPU_Variable(state.dev_f, tmp.data(), state.idx[otype], state.N);
                 
             }
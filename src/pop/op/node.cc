@@ -33,15 +33,6 @@ namespace FT{
                 return arity['f'] + arity['b'] + arity['c'] + arity['z'];
             }
 
-            /// limits node output to be between MIN_FLT and MAX_FLT
-            ArrayXf Node::limited(ArrayXf x)
-            {
-                x = (isnan(x)).select(0,x);
-                x = (x < MIN_FLT).select(MIN_FLT,x);
-                x = (x > MAX_FLT).select(MAX_FLT,x);
-                return x;
-            };
-
             /// evaluates complexity of this node in the context of its child nodes.
             void Node::eval_complexity(map<char, vector<unsigned int>>& cstate)
             {
@@ -31,8 +31,51 @@ typedef Eigen::Array<bool,Eigen::Dynamic,1> ArrayXb;
 
 #ifdef USE_CUDA
     #include "../cuda-op/kernels.h"
+#else
+    #include "kernels.h"
 #endif
 
+namespace FT{ namespace Pop{ namespace Op{
+    /// maps nans to 0 and clamps to [MIN_FLT, MAX_FLT]. it has a packet
+    /// version, so expressions wrapped in Node::limited() stay vectorized.
+    struct limit_op
+    {
+        float operator()(float v) const
+        {
+            if (std::isnan(v)) return 0.0f;
+            if (v < MIN_FLT) return MIN_FLT;
+            if (v > MAX_FLT) return MAX_FLT;
+            return v;
+        }
+
+        template <typename Packet>
+        Packet packetOp(const Packet& p) const
+        {
+            using namespace Eigen::internal;
+            // nan lanes fail p == p, so masking with it zeroes them
+            Packet x = pand(p, pcmp_eq(p, p));
+            return pmin(pmax(x, pset1<Packet>(MIN_FLT)), 
+                        pset1<Packet>(MAX_FLT));
+        }
+    };
+}}}
+
+namespace Eigen{ namespace internal{
+    template <> struct functor_traits<FT::Pop::Op::limit_op>
+    {
+        enum { 
+            Cost = 3*NumTraits<float>::AddCost,
+#if EIGEN_VERSION_AT_LEAST(3,4,0)
+            PacketAccess = packet_traits<float>::HasMin
+                           && packet_traits<float>::HasMax
+                           && packet_traits<float>::HasCmp
+#else
+            PacketAccess = false
+#endif
+        };
+    };
+}}
+
 
 namespace FT{
 
@@ -73,8 +116,14 @@ namespace Op{
             // total arity
             unsigned int total_arity();
 
-            /// limits node output to be between MIN_FLT and MAX_FLT
-            ArrayXf limited(ArrayXf x);
+            /// limits node output to be between MIN_FLT and MAX_FLT. 
+            /// returns an expression, so the clamp is fused with the
+            /// evaluation of x and written straight into the output.
+            template <typename Derived>
+            static auto limited(const Eigen::ArrayBase<Derived>& x)
+            {
+                return x.unaryExpr(limit_op());
+            }
 
             /// evaluates complexity of this node in the context of its child nodes.
             void eval_complexity(map<char, vector<unsigned int>>& cstate);
@@ -32,9 +32,9 @@ NodeConstant::NodeConstant(const float& v)
 void NodeConstant::evaluate(const Data& data, State& state)
 {
     if (otype == 'b')
-        state.push<bool>(ArrayXb::Constant(data.X.cols(),int(b_value)));
+        state.push<bool>(ArrayXb::Constant(data.n_samples(),int(b_value)));
     else 	
-        state.push<float>(limited(ArrayXf::Constant(data.X.cols(),d_value)));
+        state.push<float>(limited(ArrayXf::Constant(data.n_samples(),d_value)));
 }
 #else
 void NodeConstant::evaluate(const Data& data, State& state)
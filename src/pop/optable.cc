@@ -0,0 +1,193 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "optable.h"
+
+namespace FT{
+
+namespace Pop{
+
+/// the opcode table, in the order of OpCode. Bytecode::execute() computes
+/// the same outputs over tiles of samples.
+static const OpcodeInfo op_table[] = {
+    {"",    "$x"},                                          // OP_VAR_F
+    {"",    "$x != 0"},                                     // OP_VAR_B
+    {"",    "int($x)"},                                     // OP_VAR_C
+    {"",    "$v"},                                          // OP_CONST_F
+    {"",    "$v != 0"},                                     // OP_CONST_B
+    {"ff",  "limited($W0*$a + $W1*$b)"},                    // OP_ADD
+    {"ff",  "limited($W0*$a - $W1*$b)"},                    // OP_SUB
+    {"ff",  "limited($W0*$a * $W1*$b)"},                    // OP_MUL
+    {"ff",  "limited(($W0*$a) / ($W1*$b))"},                // OP_DIV
+    {"ff",  "limited(std::pow($W0*$a, $W1*$b))"},           // OP_EXPONENT
+    {"f",   "limited(std::exp($W0*$a))"},                   // OP_EXP
+    {"f",   "std::abs($a) > near_zero ? "
+            "limited(std::log(std::abs($W0*$a))) : "
+            "std::numeric_limits<float>::lowest()"},        // OP_LOG
+    {"f",   "1.0f/(1.0f + limited(std::exp(-($W0*$a))))"},  // OP_LOGIT
+    {"f",   "limited(std::sin($W0*$a))"},                   // OP_SIN
+    {"f",   "limited(std::cos($W0*$a))"},                   // OP_COS
+    {"f",   "limited(std::tanh($W0*$a))"},                  // OP_TANH
+    {"f",   "limited(std::pow($W0*$a, 2.0f))"},             // OP_SQUARE
+    {"f",   "limited(std::pow($W0*$a, 3.0f))"},             // OP_CUBE
+    {"f",   "std::sqrt($W0*std::abs($a))"},                 // OP_SQRT
+    {"f",   "limited(std::exp(-(($W0 - $a)*($W0 - $a))))"}, // OP_GAUSS
+    {"f",   "$W0*$a > 0 ? $W0*$a : 0.01f"},                 // OP_RELU
+    {"f",   "$a > 0 ? 1.0f : $a == 0 ? 0.0f : -1.0f"},      // OP_SIGN
+    {"f",   "$a > 0 ? 1.0f : 0.0f"},                        // OP_STEP
+    {"b",   "float($a)"},                                   // OP_B2F
+    {"c",   "float($a)"},                                   // OP_C2F
+    {"fb",  "limited($b ? $a : 0.0f)"},                     // OP_IF
+    {"ffb", "limited($c ? $a : $b)"},                       // OP_ITE
+    {"bb",  "$a && $b"},                                    // OP_AND
+    {"bb",  "$a || $b"},                                    // OP_OR
+    {"b",   "!$a"},                                         // OP_NOT
+    {"bb",  "$a != $b"},                                    // OP_XOR
+    {"ff",  "$a == $b"},                                    // OP_EQ
+    {"ff",  "$a > $b"},                                     // OP_GT
+    {"ff",  "$a >= $b"},                                    // OP_GEQ
+    {"ff",  "$a < $b"},                                     // OP_LT
+    {"ff",  "$a <= $b"},                                    // OP_LEQ
+    {"f",   "$a < $v"},                                     // OP_SPLIT_F
+    {"c",   "float($a) == $v"},                             // OP_SPLIT_C
+    {"",    nullptr},                                       // OP_LOAD_F
+    {"",    nullptr},                                       // OP_LOAD_B
+    {"",    nullptr}                                        // OP_LOAD_C
+};
+static_assert(sizeof(op_table)/sizeof(OpcodeInfo) == OP_LOAD_C + 1,
+              "the opcode table must have a row for each opcode");
+
+const OpcodeInfo& op_info(OpCode op)
+{
+    return op_table[op];
+}
+
+/// opcodes of the NodeMap entries the bytecode can run over tiles
+static const std::map<string, OpCode> opcodes = {
+    {"variable_f", OP_VAR_F}, {"variable_b", OP_VAR_B},
+    {"variable_c", OP_VAR_C}, {"constant_d", OP_CONST_F},
+    {"constant_b", OP_CONST_B}, {"+", OP_ADD}, {"-", OP_SUB},
+    {"*", OP_MUL}, {"/", OP_DIV}, {"^", OP_EXPONENT}, {"exp", OP_EXP},
+    {"log", OP_LOG}, {"logit", OP_LOGIT}, {"sin", OP_SIN},
+    {"cos", OP_COS}, {"tanh", OP_TANH}, {"^2", OP_SQUARE},
+    {"^3", OP_CUBE}, {"sqrt", OP_SQRT}, {"gauss", OP_GAUSS},
+    {"relu", OP_RELU}, {"sign", OP_SIGN}, {"step", OP_STEP},
+    {"b2f", OP_B2F}, {"c2f", OP_C2F}, {"if", OP_IF}, {"ite", OP_ITE},
+    {"and", OP_AND}, {"or", OP_OR}, {"not", OP_NOT}, {"xor", OP_XOR},
+    {"=", OP_EQ}, {">", OP_GT}, {">=", OP_GEQ}, {"<", OP_LT},
+    {"<=", OP_LEQ}, {"split", OP_SPLIT_F}, {"fuzzy_split", OP_SPLIT_F},
+    {"fuzzy_fixed_split", OP_SPLIT_F}, {"split_c", OP_SPLIT_C},
+    {"fuzzy_split_c", OP_SPLIT_C}, {"fuzzy_fixed_split_c", OP_SPLIT_C}
+};
+
+OpTable::OpTable()
+{
+    for (const auto& kv : NM.node_map)
+    {
+        Node* n = kv.second;
+        OpInfo info;
+        info.key = kv.first;
+        info.name = n->name;
+        info.total_arity = 0;
+        for (char t : {'f','b','c','z'})
+        {
+            auto it = n->arity.find(t);
+            info.arity[slot(t)] = it == n->arity.end() ? 0 : it->second;
+            info.total_arity += info.arity[slot(t)];
+        }
+        info.complexity = n->complexity;
+        info.node = n;
+
+        // variables and constants in the map don't carry their type, so it
+        // is read off their key
+        if (dynamic_cast<NodeVariable<float>*>(n)
+                || dynamic_cast<NodeVariable<bool>*>(n)
+                || dynamic_cast<NodeVariable<int>*>(n))
+        {
+            info.kind = KIND_VARIABLE;
+            info.otype = kv.first.back();
+        }
+        else if (dynamic_cast<NodeConstant*>(n))
+        {
+            info.kind = KIND_CONSTANT;
+            info.name = kv.first;
+            info.otype = kv.first == "constant_b" ? 'b' : 'f';
+        }
+        else 
+        {
+            info.otype = n->otype;
+            info.kind = KIND_PLAIN;
+        }
+
+        if (dynamic_cast<NodeFuzzyFixedSplit<float>*>(n)
+                || dynamic_cast<NodeFuzzyFixedSplit<int>*>(n))
+            info.kind = KIND_FIXED_SPLIT;
+        else if (dynamic_cast<NodeSplit<float>*>(n)
+                || dynamic_cast<NodeSplit<int>*>(n)
+                || dynamic_cast<NodeFuzzySplit<float>*>(n)
+                || dynamic_cast<NodeFuzzySplit<int>*>(n))
+            info.kind = KIND_SPLIT;
+        else if (n->isNodeDx())
+            info.kind = KIND_WEIGHTED;
+
+        auto op = opcodes.find(kv.first);
+        info.tiled = op != opcodes.end();
+        info.opcode = info.tiled ? op->second : OP_LOAD_F;
+        if (info.tiled)
+        {
+            // the bytecode pops the node's floats, then booleans, then
+            // categoricals
+            string args;
+            for (char t : {'f', 'b', 'c', 'z'})
+                args.append(info.arity[slot(t)], t);
+            if (args != op_info(info.opcode).args)
+                THROW_RUNTIME_ERROR("the opcode of " + kv.first
+                        + " doesn't take the node's arguments");
+        }
+
+        codes[kv.first] = ops.size();
+        ops.push_back(info);
+    }
+}
+
+const OpTable& OpTable::get()
+{
+    static const OpTable table;
+    return table;
+}
+
+int OpTable::slot(char t)
+{
+    switch (t)
+    {
+        case 'f': return 0;
+        case 'b': return 1;
+        case 'c': return 2;
+        case 'z': return 3;
+        default:
+            THROW_INVALID_ARGUMENT(string("unknown type ") + t);
+    }
+}
+
+uint16_t OpTable::code(const string& name, char otype) const
+{
+    const OpInfo* info = find(name, otype);
+    if (!info)
+        THROW_INVALID_ARGUMENT(name + " not found");
+    return info - ops.data();
+}
+
+const OpInfo* OpTable::find(const string& name, char otype) const
+{
+    auto it = codes.find(name);
+    if (it == codes.end())
+        it = codes.find(name + "_" + to_string(otype));
+    if (it == codes.end())
+        return nullptr;
+    return &ops[it->second];
+}
+
+} // Pop
+} // FT
@@ -0,0 +1,116 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+#ifndef OPTABLE_H
+#define OPTABLE_H
+
+#include <cstdint>
+#include "nodevector.h"
+
+namespace FT{
+
+    namespace Pop{
+
+        ////////////////////////////////////////////////////////////////////////////////// Declarations
+
+        /// operations the bytecode evaluator knows how to run over a tile
+        enum OpCode
+        {
+            OP_VAR_F, OP_VAR_B, OP_VAR_C, OP_CONST_F, OP_CONST_B,
+            OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_EXPONENT,
+            OP_EXP, OP_LOG, OP_LOGIT, OP_SIN, OP_COS, OP_TANH,
+            OP_SQUARE, OP_CUBE, OP_SQRT, OP_GAUSS, OP_RELU, OP_SIGN, OP_STEP,
+            OP_B2F, OP_C2F, OP_IF, OP_ITE,
+            OP_AND, OP_OR, OP_NOT, OP_XOR,
+            OP_EQ, OP_GT, OP_GEQ, OP_LT, OP_LEQ,
+            OP_SPLIT_F, OP_SPLIT_C,
+            OP_LOAD_F, OP_LOAD_B, OP_LOAD_C
+        };
+
+        /*!
+         * @class OpcodeInfo
+         * @brief the arguments of an opcode and what it computes for one
+         * sample, as C++. Predictor::to_cpp() emits programs from it.
+         */
+        struct OpcodeInfo
+        {
+            const char* args;   ///< types of the arguments, in the order
+                                ///< of Instruction::src
+            /// the output for one sample. $a, $b and $c are the arguments,
+            /// $W0 and $W1 the weights, $v the instruction value and $x the
+            /// normalized input of variables. the expression may call
+            /// limited() and read near_zero. nullptr if the opcode can't
+            /// be exported.
+            const char* cpp;
+        };
+
+        /// the row of op in the opcode table
+        const OpcodeInfo& op_info(OpCode op);
+
+        /// what, besides the operator, a gene has to store
+        enum OpKind
+        {
+            KIND_PLAIN,         ///< nothing
+            KIND_WEIGHTED,      ///< differentiable, with weights in the pool
+            KIND_VARIABLE,      ///< a feature location
+            KIND_CONSTANT,      ///< a value in the pool
+            KIND_SPLIT,         ///< a threshold in the pool and a train flag
+            KIND_FIXED_SPLIT    ///< a split whose threshold may be unset
+        };
+
+        /*!
+         * @class OpInfo
+         * @brief metadata shared by every use of an operator.
+         */
+        struct OpInfo
+        {
+            string key;             ///< name in the NodeMap
+            string name;            ///< node name
+            char otype;             ///< output type
+            unsigned arity[4];      ///< arity of f, b, c and z arguments
+            unsigned total_arity;
+            int complexity;
+            OpKind kind;
+            const Node* node;       ///< prototype in the NodeMap
+            bool tiled;             ///< true if the bytecode can run it
+            OpCode opcode;          ///< its bytecode opcode, if tiled
+        };
+
+        /*!
+         * @class OpTable
+         * @brief immutable table of the operators in the NodeMap, indexed
+         * by their position in it. positions follow the order of the
+         * NodeMap keys, so they are the same from run to run. Compact
+         * programs store positions in this table, and the bytecode looks
+         * up its opcodes here.
+         */
+        class OpTable
+        {
+            public:
+                static const OpTable& get();
+
+                const OpInfo& at(uint16_t op) const { return ops.at(op); }
+
+                size_t size() const { return ops.size(); }
+
+                /// position of the node with name and output type, looked
+                /// up the same way from_json() does
+                uint16_t code(const string& name, char otype) const;
+
+                /// as code(), but returns nullptr if the node isn't in
+                /// the NodeMap
+                const OpInfo* find(const string& name, char otype) const;
+
+                /// position of type t in OpInfo::arity
+                static int slot(char t);
+
+            private:
+                OpTable();
+
+                vector<OpInfo> ops;
+                std::map<string, uint16_t> codes;
+        };
+    }
+}
+#endif
@@ -30,6 +30,23 @@ void Population::resize(int pop_size)
 /// returns population size
 int Population::size(){ return individuals.size(); }
 
+void Population::update_errors()
+{
+    size_t N = individuals.empty()? 0 : individuals.at(0).error.size();
+    for (unsigned i = 0; i < individuals.size(); ++i)
+    {
+        if (individuals.at(i).error.size() != N)
+            THROW_LENGTH_ERROR("individual " + to_string(i) + " has "
+                    + to_string(individuals.at(i).error.size()) 
+                    + " errors; expected " + to_string(N));
+    }
+    errors.resize(individuals.size(), N);
+
+    #pragma omp parallel for
+    for (unsigned i = 0; i < individuals.size(); ++i)
+        errors.row(i) = individuals.at(i).error.transpose();
+}
+
 const Individual Population::operator [](size_t i) const {return individuals.at(i);}
 
 const Individual & Population::operator [](size_t i) {return individuals.at(i);}
@@ -159,7 +176,7 @@ void Population::save(string filename)
     to_json(j, *this);
     out << j ;
     out.close();
-    logger.log("Saved population to file " + filename, 1);
+    LOG("Saved population to file " + filename, 1);
 }
 
 void Population::load(string filename)
@@ -176,7 +193,7 @@ void Population::load(string filename)
     json j = json::parse(line);
     from_json(j, *this);
 
-    logger.log("Loaded population from " + filename + " of size = " 
+    LOG("Loaded population from " + filename + " of size = " 
             + to_string(this->size()),1);
 
     indata.close();
@@ -28,6 +28,10 @@ struct Population
 {
     vector<Individual> individuals;     ///< individual programs
 
+    /// errors of the individuals, P x N with one column per case, so the 
+    /// errors on a case are contiguous. filled by update_errors().
+    MatrixXf errors;
+
     Population(int p = 0);
     
     ~Population();
@@ -48,6 +52,9 @@ struct Population
     /// returns population size
     int size();
 
+    /// copies the individuals' errors into the error matrix. 
+    void update_errors();
+
     /// adds a program to the population. 
     void add(Individual&);
     
@@ -0,0 +1,675 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "predictor.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace FT{
+
+namespace Pop{
+
+/// samples evaluated at once. boolean registers hold one word.
+static const int TILE = 64;
+
+/// registers and outputs of the calling thread. they only grow, so
+/// predictions don't allocate once they are sized.
+struct Workspace
+{
+    vector<float> f;
+    vector<const float*> fp;
+    vector<int> c;
+    vector<Word> b;
+    vector<double> phi;
+    vector<double> votes;
+};
+static thread_local Workspace ws;
+
+template<class T>
+static inline void grow(vector<T>& v, size_t n)
+{
+    if (v.size() < n)
+        v.resize(n);
+}
+
+/// offset and scale Normalizer::normalize() applies to row i
+template<class T>
+static void normalization(const Normalizer& N, size_t i, T& offset, T& scale)
+{
+    offset = 0;
+    scale = 1;
+    if (std::isinf(N.scale.at(i)))
+        return;
+    if (N.scale_all || N.dtypes.at(i)=='f')
+    {
+        if (N.remove_offset)
+            offset = N.offset.at(i);
+        if (N.scale.at(i) > NEAR_ZERO)
+            scale = N.scale.at(i);
+    }
+}
+
+/// clean() for a single value
+static inline float clean_value(float x)
+{
+    if (std::isnan(x))
+        return 0;
+    if (std::isinf(x) && x > 0)
+        return MAX_FLT;
+    return x < MIN_FLT ? MIN_FLT : x;
+}
+
+Predictor::Predictor() : F(0), n_f(0), n_b(0), n_c(0), model(ZERO),
+    problem(REGRESSION), has_proba(false), logistic(false), forest(false) {}
+
+Predictor::Predictor(const Individual& ind, size_t n_features,
+                     const Normalizer* N) : F(n_features), forest(false)
+{
+    if (!ind.ml)
+        THROW_INVALID_ARGUMENT("Predictor: the individual has no fitted "
+                "model");
+
+    // the program
+    NodeVector program = ind.program;
+    Bytecode bc(program);
+    if (!bc.compiled)
+        THROW_INVALID_ARGUMENT("Predictor: " + ind.program_str()
+                + " uses operators that can't be exported");
+    code = bc.code;
+    outputs = bc.outputs;
+    otypes = bc.otypes;
+    n_f = bc.n_regs.at('f');
+    n_b = bc.n_regs.at('b');
+    n_c = bc.n_regs.at('c');
+
+    for (const auto& ins : code)
+        if ((ins.op == OP_VAR_F || ins.op == OP_VAR_B || ins.op == OP_VAR_C)
+                && ins.loc >= F)
+            THROW_LENGTH_ERROR("Predictor: the program reads feature "
+                    + to_string(ins.loc) + " of " + to_string(F));
+
+    // input normalization
+    x_offset.assign(F, 0);
+    x_scale.assign(F, 1);
+    if (N)
+    {
+        if (N->scale.size() != F)
+            THROW_LENGTH_ERROR("Predictor: the normalizer has "
+                    + to_string(N->scale.size()) + " features, not "
+                    + to_string(F));
+        for (size_t i = 0; i < F; ++i)
+            normalization(*N, i, x_offset.at(i), x_scale.at(i));
+    }
+
+    // the ML model
+    const ML& ml = *ind.ml;
+    const size_t D = outputs.size();
+
+    phi_offset.assign(D, 0);
+    phi_scale.assign(D, 1);
+    if (ml.normalize)
+    {
+        if (ml.N.scale.size() != D)
+            THROW_LENGTH_ERROR("Predictor: the model was fit on "
+                    + to_string(ml.N.scale.size()) + " features, not "
+                    + to_string(D));
+        for (size_t i = 0; i < D; ++i)
+            normalization(ml.N, i, phi_offset.at(i), phi_scale.at(i));
+    }
+
+    problem = ml.prob_type == sh::PT_REGRESSION ? REGRESSION
+              : ml.prob_type == sh::PT_BINARY ? BINARY : MULTICLASS;
+    logistic = in({LR, L1_LR}, ml.ml_type);
+
+    if (ml.get_weights().empty())
+        // ML::predict() returns zeros for models that failed to fit
+        model = ZERO;
+    else if (in({LARS, Ridge, SVM, LR, L1_LR}, ml.ml_type))
+    {
+        if (problem == MULTICLASS)
+        {
+            if (!logistic)
+                THROW_INVALID_ARGUMENT("Predictor: multiclass " + ml.ml_str
+                        + " models can't be exported");
+            auto lr = dynamic_pointer_cast<sh::CMulticlassLogisticRegression>(
+                    ml.p_est);
+            for (const auto& wk : lr->get_w())
+            {
+                if (wk.size() != D)
+                    THROW_LENGTH_ERROR("Predictor: weights don't match "
+                            "the program outputs");
+                w.insert(w.end(), wk.data(), wk.data() + wk.size());
+            }
+            b = lr->get_bias();
+            model = MULTICLASS_LINEAR;
+        }
+        else
+        {
+            auto lm = dynamic_pointer_cast<sh::CLinearMachine>(ml.p_est);
+            SGVector<double> wk = lm->get_w();
+            if (wk.size() != D)
+                THROW_LENGTH_ERROR("Predictor: weights don't match the "
+                        "program outputs");
+            w.assign(wk.data(), wk.data() + wk.size());
+            b = {lm->get_bias()};
+            model = LINEAR;
+        }
+    }
+    else
+    {
+        model = TREES;
+        vector<sh::FlatCARTNode> flat;
+        vector<double> vals;
+        auto add_tree = [&]()
+        {
+            const int n0 = nodes.size(), v0 = values.size();
+            roots.push_back(n0);
+            for (const auto& n : flat)
+            {
+                if (n.attribute >= int(D))
+                    THROW_LENGTH_ERROR("Predictor: the tree splits on an "
+                            "output the program doesn't have");
+                nodes.push_back({n.attribute, n.nominal,
+                                 n.right < 0 ? -1 : n.right + n0,
+                                 n.begin + v0, n.end + v0,
+                                 n.label, n.certainty});
+            }
+            values.insert(values.end(), vals.begin(), vals.end());
+        };
+
+        if (ml.ml_type == CART)
+        {
+            dynamic_pointer_cast<sh::CMyCARTree>(ml.p_est)->flatten(flat,
+                    vals);
+            add_tree();
+        }
+        else
+        {
+            forest = true;
+            auto rf = dynamic_pointer_cast<sh::CMyRandomForest>(ml.p_est);
+            for (int i = 0; i < rf->get_num_bags(); ++i)
+            {
+                rf->flatten(i, flat, vals);
+                add_tree();
+            }
+        }
+    }
+
+    has_proba = problem == BINARY && (model == ZERO
+                || (model == LINEAR && logistic)
+                || (model == TREES && !forest));
+}
+
+void Predictor::run(const float* X, int len, double* phi) const
+{
+    /*!
+     * Reads the variables of len samples into registers, normalized, and
+     * runs the other instructions with Bytecode::execute(). The outputs
+     * are then normalized for the ML model.
+     */
+    grow(ws.f, TILE*n_f);
+    grow(ws.c, TILE*n_c);
+    grow(ws.b, n_b);
+    grow(ws.fp, n_f);
+
+    Op::limit_op limited;
+    auto f = [&](int r){ return ws.f.data() + TILE*r; };
+    auto c = [&](int r){ return ws.c.data() + TILE*r; };
+    Word* bits = ws.b.data();
+    auto bit = [](Word w, int j){ return (w >> j) & 1; };
+    Registers regs = {len, ws.fp.data(), ws.f.data(), TILE, bits, 1,
+                      ws.c.data(), TILE};
+
+    for (const auto& ins : code)
+    {
+        const size_t loc = ins.loc;
+        auto x = [&](int j){ 
+            return (X[j*F + loc] - x_offset[loc]) / x_scale[loc]; 
+        };
+
+        switch (ins.op)
+        {
+        case OP_VAR_F:
+            for (int j = 0; j < len; ++j)
+                f(ins.dst)[j] = x(j);
+            ws.fp[ins.dst] = f(ins.dst);
+            break;
+        case OP_VAR_B:
+        {
+            Word m = 0;
+            for (int j = 0; j < len; ++j)
+                m |= Word(x(j) != 0) << j;
+            bits[ins.dst] = m;
+            break;
+        }
+        case OP_VAR_C:
+            for (int j = 0; j < len; ++j)
+                c(ins.dst)[j] = int(x(j));
+            break;
+        default:
+            // predictors are compiled without a cache, so there are no 
+            // loads
+            Bytecode::execute(ins, regs);
+        }
+    }
+
+    // Phi, without nans and infs, normalized as in ML::predict()
+    const size_t D = outputs.size();
+    for (size_t i = 0; i < D; ++i)
+    {
+        for (int j = 0; j < len; ++j)
+        {
+            float v;
+            switch (otypes[i])
+            {
+            case 'f':
+                v = limited(f(outputs[i])[j]);
+                break;
+            case 'c':
+                v = c(outputs[i])[j];
+                break;
+            default:
+                v = bit(bits[outputs[i]], j);
+            }
+            phi[j*D + i] = (double(v) - phi_offset[i]) / phi_scale[i];
+        }
+    }
+}
+
+const TreeNode& Predictor::leaf(int root, const double* phi) const
+{
+    // as in CMyCARTree::apply_from_current_node()
+    int k = root;
+    while (nodes[k].attribute >= 0)
+    {
+        const TreeNode& n = nodes[k];
+        const double x = phi[n.attribute];
+        bool left = false;
+        if (n.nominal)
+        {
+            for (int v = n.begin; v < n.end && !left; ++v)
+                left = values[v] == x;
+        }
+        else
+            left = x <= values[n.begin];
+        k = left ? k + 1 : n.right;
+    }
+    return nodes[k];
+}
+
+float Predictor::model_output(const double* phi, double* votes) const
+{
+    const size_t D = outputs.size();
+    // binary labels are +1 for outputs at or above the threshold
+    auto binary = [](double x, double threshold){
+        return x + threshold >= 0 ? 1.0 : -1.0; };
+
+    switch (model)
+    {
+    case ZERO:
+        return 0;
+    case LINEAR:
+    {
+        double y = 0;
+        for (size_t i = 0; i < D; ++i)
+            y += w[i]*phi[i];
+        y += b[0];
+        if (problem == BINARY)
+            return binary(y, 0) > 0 ? 1 : 0;
+        return clean_value(y);
+    }
+    case MULTICLASS_LINEAR:
+    {
+        // one versus rest
+        int best = 0;
+        double best_y = 0;
+        for (size_t k = 0; k < b.size(); ++k)
+        {
+            double y = 0;
+            for (size_t i = 0; i < D; ++i)
+                y += w[k*D + i]*phi[i];
+            y += b[k];
+            if (k == 0 || y > best_y)
+            {
+                best = k;
+                best_y = y;
+            }
+        }
+        return best;
+    }
+    case TREES:
+    {
+        if (!forest)
+        {
+            double y = leaf(roots[0], phi).label;
+            if (problem == BINARY)
+                return binary(y, 0.5) > 0 ? 1 : 0;
+            return clean_value(y);
+        }
+
+        const size_t T = roots.size();
+        for (size_t t = 0; t < T; ++t)
+        {
+            votes[t] = leaf(roots[t], phi).label;
+            if (problem == BINARY)
+                votes[t] = binary(votes[t], 0.5);
+        }
+        if (problem == REGRESSION)
+        {
+            double y = 0;
+            for (size_t t = 0; t < T; ++t)
+                y += votes[t];
+            return clean_value(y/T);
+        }
+        // majority vote, breaking ties toward the smallest label
+        std::sort(votes, votes + T);
+        double y = votes[0];
+        size_t best = 0;
+        for (size_t t = 0; t < T; )
+        {
+            size_t u = t;
+            while (u < T && votes[u] == votes[t])
+                ++u;
+            if (u - t > best)
+            {
+                best = u - t;
+                y = votes[t];
+            }
+            t = u;
+        }
+        if (problem == BINARY)
+            return binary(y, 0) > 0 ? 1 : 0;
+        return y;
+    }
+    }
+    return 0;
+}
+
+float Predictor::model_proba(const double* phi) const
+{
+    if (model == ZERO)
+        return 0;
+    if (model == LINEAR)
+    {
+        double y = b[0];
+        for (size_t i = 0; i < outputs.size(); ++i)
+            y += w[i]*phi[i];
+        return 1/(1+exp(-y));
+    }
+    // as in CMyCARTree::set_probabilities()
+    const TreeNode& n = leaf(roots[0], phi);
+    return n.label > 0 ? n.certainty : 1 - n.certainty;
+}
+
+template<class Out>
+void Predictor::for_tiles(const float* X, size_t n, Out out) const
+{
+    const size_t D = outputs.size();
+    grow(ws.phi, TILE*D);
+    grow(ws.votes, roots.size());
+
+    for (size_t start = 0; start < n; start += TILE)
+    {
+        int len = std::min<size_t>(TILE, n - start);
+        run(X + start*F, len, ws.phi.data());
+        for (int j = 0; j < len; ++j)
+            out(ws.phi.data() + j*D, ws.votes.data(), start + j);
+    }
+}
+
+float Predictor::predict(const float* x) const
+{
+    float y;
+    predict(x, 1, &y);
+    return y;
+}
+
+void Predictor::predict(const float* X, size_t n, float* y) const
+{
+    for_tiles(X, n, [&](const double* phi, double* votes, size_t i){
+            y[i] = model_output(phi, votes); });
+}
+
+VectorXf Predictor::predict(const MatrixXf& X) const
+{
+    if (X.rows() != F)
+        THROW_LENGTH_ERROR("Predictor: X has " + to_string(X.rows())
+                + " features, not " + to_string(F));
+    VectorXf y(X.cols());
+    predict(X.data(), X.cols(), y.data());
+    return y;
+}
+
+float Predictor::predict_proba(const float* x) const
+{
+    float y;
+    predict_proba(x, 1, &y);
+    return y;
+}
+
+void Predictor::predict_proba(const float* X, size_t n, float* y) const
+{
+    if (!has_proba)
+        THROW_INVALID_ARGUMENT("Predictor: probabilities are only "
+                "available for binary LR and CART models");
+    for_tiles(X, n, [&](const double* phi, double*, size_t i){
+            y[i] = model_proba(phi); });
+}
+
+VectorXf Predictor::predict_proba(const MatrixXf& X) const
+{
+    if (X.rows() != F)
+        THROW_LENGTH_ERROR("Predictor: X has " + to_string(X.rows())
+                + " features, not " + to_string(F));
+    VectorXf y(X.cols());
+    predict_proba(X.data(), X.cols(), y.data());
+    return y;
+}
+
+/// float literal that reads back as x
+static string lit(float x)
+{
+    std::ostringstream ss;
+    ss << std::scientific << std::setprecision(9) << x << "f";
+    return ss.str();
+}
+
+/// double literal that reads back as x
+static string lit(double x)
+{
+    std::ostringstream ss;
+    ss << std::scientific << std::setprecision(17) << x;
+    return ss.str();
+}
+
+/// replaces every $name in e with its value in vars
+static string substitute(string e, const std::map<string, string>& vars)
+{
+    for (size_t i = e.find('$'); i != string::npos; i = e.find('$', i))
+    {
+        size_t j = i + 1;
+        while (j < e.size() && std::isalnum(e[j]))
+            ++j;
+        const string& v = vars.at(e.substr(i + 1, j - i - 1));
+        e.replace(i, j - i, v);
+        i += v.size();
+    }
+    return e;
+}
+
+string Predictor::to_cpp(const string& name) const
+{
+    /*!
+     * Emits the bytecode from the opcode table as one loop per instruction
+     * over a tile of samples, reusing the registers of the bytecode, so
+     * that shared subtrees are computed once and the loops vectorize.
+     */
+    if (name.empty() || std::isdigit(name[0])
+            || !std::all_of(name.begin(), name.end(), [](char c){
+                return std::isalnum(c) || c == '_'; }))
+        THROW_INVALID_ARGUMENT("to_cpp: " + name + " is not an identifier");
+    if (model == TREES)
+        THROW_INVALID_ARGUMENT("to_cpp: only linear and logistic models "
+                "can be emitted as C++");
+
+    const size_t D = outputs.size();
+    const size_t P = std::max<size_t>(D, 1);
+    std::ostringstream os;
+    string guard = name;
+    std::transform(guard.begin(), guard.end(), guard.begin(), ::toupper);
+
+    os << "// generated by FEAT. do not edit.\n"
+       << "#ifndef " << guard << "_H\n"
+       << "#define " << guard << "_H\n\n"
+       << "#include <algorithm>\n#include <cmath>\n#include <cstddef>\n"
+       << "#include <limits>\n\n"
+       << "namespace " << name << "{\n\n"
+       << "/// number of values in a sample\n"
+       << "static const std::size_t n_features = " << F << ";\n\n"
+       << "/// number of samples evaluated at once\n"
+       << "static const std::size_t tile = " << TILE << ";\n\n"
+       << "static const float near_zero = " << lit(NEAR_ZERO) << ";\n\n"
+       << "/// maps nans to 0 and clamps to the finite floats\n"
+       << "inline float limited(float x)\n{\n"
+       << "    x = std::isnan(x) ? 0.0f : x;\n"
+       << "    x = x < std::numeric_limits<float>::lowest() ?\n"
+       << "        std::numeric_limits<float>::lowest() : x;\n"
+       << "    return x > std::numeric_limits<float>::max() ?\n"
+       << "        std::numeric_limits<float>::max() : x;\n}\n\n"
+       << "/// normalized outputs of the program for n <= tile samples, one\n"
+       << "/// sample after the other\n"
+       << "inline void features(const float* X, std::size_t n, double* phi)"
+       << "\n{\n";
+
+    const std::map<char, int> n_regs = {{'f', n_f}, {'b', n_b}, {'c', n_c}};
+    const std::map<char, string> ctype = {{'f', "float"}, {'b', "bool"},
+        {'c', "int"}};
+    for (const auto& r : n_regs)
+        if (r.second > 0)
+            os << "    " << ctype.at(r.first) << " " << r.first << "["
+               << r.second << "][tile];\n";
+
+    auto reg = [](char t, int r){ 
+        return string(1, t) + "[" + to_string(r) + "][j]"; };
+    // negative constants are wrapped so that they can follow an operator
+    auto weight = [](float w){ 
+        return w < 0 ? "(" + lit(w) + ")" : lit(w); };
+    auto wrap = [](double w){ 
+        return w < 0 ? "(" + lit(w) + ")" : lit(w); };
+
+    for (const auto& ins : code)
+    {
+        const OpcodeInfo& info = op_info(ins.op);
+        if (!info.cpp)
+            THROW_INVALID_ARGUMENT("to_cpp: unexpected instruction");
+
+        std::map<string, string> vars = {{"W0", weight(ins.w[0])},
+            {"W1", weight(ins.w[1])}, {"v", weight(ins.value)}};
+        const string args = info.args;
+        for (size_t k = 0; k < args.size(); ++k)
+            vars[string(1, 'a' + k)] = reg(args[k], ins.src[k]);
+        if (in({OP_VAR_F, OP_VAR_B, OP_VAR_C}, ins.op))
+            vars["x"] = "(X[j*n_features + " + to_string(ins.loc) + "] - "
+                        + weight(x_offset[ins.loc]) + ")/" 
+                        + weight(x_scale[ins.loc]);
+
+        os << "    for (std::size_t j = 0; j < n; ++j)\n"
+           << "        " << reg(ins.otype, ins.dst) << " = "
+           << substitute(info.cpp, vars) << ";\n";
+    }
+
+    for (size_t i = 0; i < D; ++i)
+    {
+        string v = reg(otypes[i], outputs[i]);
+        if (otypes[i] == 'f')
+            v = "limited(" + v + ")";
+        os << "    for (std::size_t j = 0; j < n; ++j)\n"
+           << "        phi[j*" << D << " + " << i << "] = (double(" << v 
+           << ") - " << wrap(phi_offset[i]) << ")/" << wrap(phi_scale[i]) 
+           << ";\n";
+    }
+    os << "}\n\n";
+
+    // the model
+    auto score = [&](size_t k){
+        std::ostringstream ss;
+        ss << "0.0";
+        for (size_t i = 0; i < D; ++i)
+            ss << " + " << lit(w[k*D + i]) << "*phi[" << i << "]";
+        ss << " + " << lit(b[k]);
+        return ss.str();
+    };
+
+    os << "/// prediction for the outputs phi of a sample\n"
+       << "inline float output(const double* phi)\n{\n";
+    if (model == ZERO)
+        os << "    return 0.0f;\n";
+    else if (model == LINEAR && problem == BINARY)
+        os << "    return " << score(0) << " >= 0 ? 1.0f : 0.0f;\n";
+    else if (model == LINEAR)
+        os << "    float y = " << score(0) << ";\n"
+           << "    y = std::isnan(y) ? 0.0f : y;\n"
+           << "    y = std::isinf(y) && y > 0 ?\n"
+           << "        std::numeric_limits<float>::max() : y;\n"
+           << "    return y < std::numeric_limits<float>::lowest() ?\n"
+           << "        std::numeric_limits<float>::lowest() : y;\n";
+    else
+    {
+        // one versus rest
+        os << "    int label = 0;\n"
+           << "    double best = " << score(0) << ";\n";
+        for (size_t k = 1; k < b.size(); ++k)
+            os << "    double s" << k << " = " << score(k) << ";\n"
+               << "    if (s" << k << " > best) { best = s" << k
+               << "; label = " << k << "; }\n";
+        os << "    return float(label);\n";
+    }
+    os << "}\n\n";
+
+    // batches run the program a tile at a time
+    auto batch = [&](const string& f, const string& out){
+        os << "inline void " << f << "(const float* X, std::size_t n, "
+              "float* y)\n{\n"
+           << "    double phi[tile*" << P << "];\n"
+           << "    for (std::size_t start = 0; start < n; start += tile)\n"
+           << "    {\n"
+           << "        const std::size_t m = std::min(tile, n - start);\n"
+           << "        features(X + start*n_features, m, phi);\n"
+           << "        for (std::size_t j = 0; j < m; ++j)\n"
+           << "            y[start + j] = " << out << "(phi + j*" << P 
+           << ");\n"
+           << "    }\n}\n\n"
+           << "inline float " << f << "(const float* x)\n{\n"
+           << "    float y;\n"
+           << "    " << f << "(x, 1, &y);\n"
+           << "    return y;\n}\n\n";
+    };
+    os << "/// predictions for n samples stored one after the other\n";
+    batch("predict", "output");
+
+    if (has_proba)
+    {
+        os << "/// probability of the positive class for the outputs phi\n"
+           << "inline float proba(const double* phi)\n{\n";
+        if (model == ZERO)
+            os << "    return 0.0f;\n";
+        else
+            os << "    return float(1/(1 + std::exp(-(" << score(0)
+               << "))));\n";
+        os << "}\n\n"
+           << "/// probabilities of the positive class of n samples\n";
+        batch("predict_proba", "proba");
+    }
+
+    os << "}\n\n#endif\n";
+    return os.str();
+}
+
+}
+}
@@ -0,0 +1,132 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+#ifndef PREDICTOR_H
+#define PREDICTOR_H
+
+#include "individual.h"
+#include "bytecode.h"
+
+namespace FT{
+
+    namespace Pop{
+
+        ////////////////////////////////////////////////////////////////////////////////// Declarations
+
+        /*!
+         * @class TreeNode
+         * @brief a node of a flattened decision tree. the left child of a
+         * split follows it.
+         */
+        struct TreeNode
+        {
+            int attribute;      ///< output of the program split on, or -1
+            bool nominal;       ///< split on a set of values
+            int right;          ///< index of the right child
+            int begin, end;     ///< values going left, or the threshold
+            double label;
+            double certainty;   ///< used for probabilities
+        };
+
+        /*!
+         * @class Predictor
+         * @brief a fitted model flattened for low latency inference.
+         *
+         * Holds the program as bytecode, the normalization constants of the
+         * inputs and of the program outputs, and the weights of linear
+         * models or the trees of CART and random forests. Samples are read
+         * in place, 64 at a time, into per-thread registers that only grow,
+         * so warm predictions make no heap allocations. The predictor is
+         * immutable and can be shared between threads.
+         *
+         * Programs that can't be compiled to bytecode (longitudinal
+         * aggregates, 2d gaussians) can't be exported, nor can multiclass
+         * SVMs. Probabilities are available for binary LR and CART models.
+         */
+        class Predictor
+        {
+            public:
+                Predictor();
+
+                /// exports the program and ML model of ind. if N is given,
+                /// inputs are normalized with it first, as in Feat::predict.
+                Predictor(const Individual& ind, size_t n_features,
+                          const Normalizer* N=nullptr);
+
+                /// number of values in a sample
+                size_t n_features() const { return F; }
+
+                /// prediction for the sample x
+                float predict(const float* x) const;
+
+                /// predictions for n samples stored one after the other,
+                /// as in the columns of a features x samples matrix
+                void predict(const float* X, size_t n, float* y) const;
+
+                /// predictions for the columns of X
+                VectorXf predict(const MatrixXf& X) const;
+
+                /// probability of the positive class of the sample x
+                float predict_proba(const float* x) const;
+
+                void predict_proba(const float* X, size_t n, float* y) const;
+
+                VectorXf predict_proba(const MatrixXf& X) const;
+
+                /// true if predict_proba() is available
+                bool has_probabilities() const { return has_proba; }
+
+                /// source of a self-contained C++ header defining namespace
+                /// name, with the same predictions as this predictor. only
+                /// linear and logistic models can be emitted.
+                string to_cpp(const string& name) const;
+
+            private:
+                enum ModelKind { ZERO, LINEAR, MULTICLASS_LINEAR, TREES };
+                enum ProblemKind { REGRESSION, BINARY, MULTICLASS };
+
+                size_t F;                   ///< number of features
+                vector<Instruction> code;
+                vector<int> outputs;        ///< registers holding Phi
+                vector<char> otypes;        ///< types of the Phi rows
+                int n_f, n_b, n_c;          ///< registers of each type
+
+                /// input normalization, x -> (x - offset)/scale
+                vector<float> x_offset, x_scale;
+                /// Phi normalization of the ML model
+                vector<double> phi_offset, phi_scale;
+
+                ModelKind model;
+                ProblemKind problem;
+                bool has_proba;             ///< true if probabilities exist
+                bool logistic;              ///< probabilities are sigmoids
+                bool forest;                ///< trees vote
+
+                vector<double> w;           ///< n_classes x dim weights
+                vector<double> b;           ///< n_classes biases
+
+                vector<TreeNode> nodes;
+                vector<double> values;      ///< split values of the trees
+                vector<int> roots;          ///< first node of each tree
+
+                /// writes Phi for len <= 64 samples, normalized for the ML
+                /// model, to phi, one sample after the other
+                void run(const float* X, int len, double* phi) const;
+
+                /// label or value of the tree at root for the sample phi
+                const TreeNode& leaf(int root, const double* phi) const;
+
+                /// prediction for the sample phi
+                float model_output(const double* phi, double* votes) const;
+
+                /// probability for the sample phi
+                float model_proba(const double* phi) const;
+
+                /// runs out(phi, votes, i) over n samples in tiles
+                template<class Out>
+                void for_tiles(const float* X, size_t n, Out out) const;
+        };
+    }
+}
+#endif
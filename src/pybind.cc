@@ -48,6 +48,18 @@ PYBIND11_MODULE(_feat, m)
     //     m.attr("__version__") = "dev";
     // #endif
 
+    py::class_<Pop::Predictor>(m, "Predictor")
+        .def("predict",
+             py::overload_cast<const MatrixXf &>(&Pop::Predictor::predict,
+                                                 py::const_),
+             "predict from the columns of X", py::arg("X"))
+        .def("predict_proba",
+             py::overload_cast<const MatrixXf &>(
+                 &Pop::Predictor::predict_proba, py::const_),
+             "probabilities of the positive class for the columns of X",
+             py::arg("X"))
+        .def_property_readonly("n_features", &Pop::Predictor::n_features);
+
     py::class_<Feat>(m, "cppFeat", py::dynamic_attr())
         // .def(py::init<>())
         .def(py::init([]()
@@ -98,6 +110,10 @@ PYBIND11_MODULE(_feat, m)
                       &Feat::get_protected_groups, &Feat::set_protected_groups)
         .def_property("tune_initial", &Feat::get_tune_initial, &Feat::set_tune_initial)
         .def_property("tune_final", &Feat::get_tune_final, &Feat::set_tune_final)
+        .def_property("cache_size", &Feat::get_cache_size, &Feat::set_cache_size)
+        .def_property("downsample", &Feat::get_downsample, &Feat::set_downsample)
+        .def_property("informed_downsample", &Feat::get_informed_downsample,
+                      &Feat::set_informed_downsample)
         .def_property("starting_pop", &Feat::get_starting_pop, &Feat::set_starting_pop)
         // .def_property("fitted_", &Feat::get_is_fitted, &Feat::set_is_fitted)
         .def("fit",
@@ -114,6 +130,14 @@ PYBIND11_MODULE(_feat, m)
                  py::scoped_estream_redirect,
                  py::gil_scoped_release>(),
              "fit from X,y,Z data")
+        .def("fit",
+             py::overload_cast<MatrixXf &, VectorXf &, const string &>(
+                 &Feat::fit),
+             py::call_guard<
+                 py::scoped_ostream_redirect,
+                 py::scoped_estream_redirect,
+                 py::gil_scoped_release>(),
+             "fit from X,y data and a longitudinal file")
         .def("transform",
              py::overload_cast<MatrixXf &>(&Feat::transform),
              "transform from X data")
@@ -144,8 +168,61 @@ PYBIND11_MODULE(_feat, m)
         .def("predict_proba_archive",
              py::overload_cast<int, MatrixXf &, LongData &>(&Feat::predict_proba_archive),
              "predict from individual in archive")
+        .def("predict_archive_batch",
+             py::overload_cast<MatrixXf &, bool>(
+                 &Feat::predict_archive_batch),
+             "predict from every individual in archive",
+             py::arg("X"), py::arg("front") = false)
+        .def("predict_archive_batch",
+             py::overload_cast<MatrixXf &, LongData &, bool>(
+                 &Feat::predict_archive_batch),
+             "predict from every individual in archive",
+             py::arg("X"), py::arg("Z"), py::arg("front") = false)
+        .def("predict_proba_archive_batch",
+             py::overload_cast<MatrixXf &, bool>(
+                 &Feat::predict_proba_archive_batch),
+             "predict probabilities from every individual in archive",
+             py::arg("X"), py::arg("front") = false)
+        .def("predict_proba_archive_batch",
+             py::overload_cast<MatrixXf &, LongData &, bool>(
+                 &Feat::predict_proba_archive_batch),
+             "predict probabilities from every individual in archive",
+             py::arg("X"), py::arg("Z"), py::arg("front") = false)
         .def("get_archive", &Feat::get_archive, py::arg("front") = false)
+        .def("get_archive_ids", &Feat::get_archive_ids, 
+             py::arg("front") = false)
         .def("get_coefs", &Feat::get_coefs)
+        .def("get_predictor", &Feat::get_predictor)
+        .def("export_cpp", &Feat::export_cpp, py::arg("name") = "feat_model")
+        .def("fit_columnar",
+             py::overload_cast<const string &>(&Feat::fit_columnar),
+             py::call_guard<
+                 py::scoped_ostream_redirect,
+                 py::scoped_estream_redirect,
+                 py::gil_scoped_release>(),
+             "fit from a columnar file", py::arg("path"))
+        .def("fit_columnar",
+             py::overload_cast<const string &, LongData &>(
+                 &Feat::fit_columnar),
+             py::call_guard<
+                 py::scoped_ostream_redirect,
+                 py::scoped_estream_redirect,
+                 py::gil_scoped_release>(),
+             "fit from a columnar file and Z data", 
+             py::arg("path"), py::arg("Z"))
+        .def("fit_columnar",
+             py::overload_cast<const string &, const string &>(
+                 &Feat::fit_columnar),
+             py::call_guard<
+                 py::scoped_ostream_redirect,
+                 py::scoped_estream_redirect,
+                 py::gil_scoped_release>(),
+             "fit from a columnar file and a longitudinal file", 
+             py::arg("path"), py::arg("z_path"))
+        .def("predict_file", &Feat::predict_file, 
+             "predict on a csv file, chunk_size rows at a time",
+             py::arg("path"), py::arg("out_path"), 
+             py::arg("chunk_size") = 65536, py::arg("sep") = ',')
         .def("save", &Feat::save)
         .def("load", &Feat::load)
         .def("get_representation", &Feat::get_representation)
@@ -156,5 +233,36 @@ PYBIND11_MODULE(_feat, m)
         .def("get_model", &Feat::get_model, py::arg("sort") = true)
         .def("get_eqn", &Feat::get_eqn, py::arg("sort") = true)
         ;
+    m.def("csv_to_columnar", &Util::csv_to_columnar,
+          "convert a csv file to a binary columnar file, in parallel",
+          py::arg("csv_path"), py::arg("path"), py::arg("sep") = ',',
+          py::call_guard<py::gil_scoped_release>());
+    m.def("load_columnar", 
+          [](const string& path){
+              Util::ColumnarFile f(path);
+              RowMatrixXf X;
+              f.read(X, 0);
+              return py::make_tuple(std::move(X), 
+                      f.has_target() ? f.y() : VectorXf(), 
+                      f.get_names(), f.get_dtypes());
+          },
+          "load X (features x samples), y, names and dtypes from a columnar "
+          "file", py::arg("path"));
+    m.def("csv_to_longitudinal", &Util::csv_to_longitudinal,
+          "convert a longitudinal csv file to a binary file, in parallel",
+          py::arg("csv_path"), py::arg("path"), py::arg("sep") = ',',
+          py::call_guard<py::gil_scoped_release>());
+    m.def("load_longitudinal", 
+          [](const string& path, const vector<int>& ids){
+              LongData Z;
+              if (ids.empty())
+                  Util::load_longitudinal(path, Z);
+              else
+                  Util::load_partial_longitudinal(path, Z, ',', ids);
+              return Z;
+          },
+          "load longitudinal data from a csv or binary file, optionally "
+          "for the samples with the given ids", 
+          py::arg("path"), py::arg("ids") = vector<int>());
     // py::add_ostream_redirect(m, "ostream_redirect");
 }
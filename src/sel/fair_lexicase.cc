@@ -4,6 +4,7 @@ license: GNU/GPL v3
 */
 
 #include "fair_lexicase.h"
+#include "lexicase_core.h"
 
 namespace FT{
 
@@ -30,26 +31,30 @@ vector<size_t> FairLexicase::select(Population& pop,
      *
      */            
 
-    //< number of samples
-    unsigned int N = pop.individuals.at(0).error.size(); 
+    pop.update_errors();
+    LexicaseCore core(pop.errors);
+
     //< number of individuals
     unsigned int P = pop.individuals.size();             
-    
-    vector<size_t> starting_pool;
-    for (int i = 0; i < pop.individuals.size(); ++i)
+
+    // total error of each individual
+    VectorXf total = pop.errors.rowwise().sum();
+    // if the group intersections are enumerated, the error of each 
+    // individual on each of them, P x groups
+    MatrixXf group_error;
+    if (!d.cases.empty())
     {
-        starting_pool.push_back(i);
+        MatrixXf in_group(pop.errors.cols(), d.cases.size());
+        for (int g = 0; g < d.cases.size(); ++g)
+            in_group.col(g) = d.cases.at(g).cast<float>().matrix();
+        group_error = pop.errors * in_group;
     }
-    assert(starting_pool.size() == P);     
 
     // selected individuals
     vector<size_t> selected(P,0); 
     #pragma omp parallel for 
     for (unsigned int i = 0; i<P; ++i)  // selection loop
     {
-        vector<size_t> pool = starting_pool;    // initial pool   
-        vector<size_t> winner;                  // winners
-
         vector<size_t> shuff_idx; // used to shuffle cases
         map<int,vector<float>> protect_levels;
         vector<float> used_levels;
@@ -69,19 +74,23 @@ vector<size_t> FairLexicase::select(Population& pop,
                 /* cout << "d.protect_levels empty"; */
             }
             protect_levels = d.protect_levels;
+            // a single sampled group is used
+            shuff_idx.resize(1);
         }
 
+        // fitness of the pool members on the current case
+        VectorXf fitness = VectorXf::Zero(P);
 
-        bool pass = true;     // checks pool size and number of cases
-        unsigned int h = 0;   // case count
-
-        while(pass){    // main loop
+        auto filter = [&](CasePool& pool, size_t h)
+        {
+            // error of the pool members on the group
+            VectorXf group(P);
 
             // **Fairness Subgroups**
             // Here, a "case" is the mean fitness over a  collection of
             // samples sharing an intersection of levels of
             // protected groups. 
-            
+        
             // if the cases haven't been enumerated, 
             // we sample group intersections.
             ArrayXb x_idx; 
@@ -102,7 +111,7 @@ vector<size_t> FairLexicase::select(Population& pop,
                 {
                     groups.push_back(pl.first);
                 }
-                x_idx = ArrayXb::Constant(d.X.cols(),true);
+                x_idx = ArrayXb::Constant(d.n_samples(),true);
                 /* cout << "x_idx sum: " << x_idx.count() << "\n"; */
                 // choose a random group
                 vector<size_t> choice_idxs(groups.size());
@@ -111,7 +120,7 @@ vector<size_t> FairLexicase::select(Population& pop,
                 int g = groups.at(idx); 
                 /* cout << "chosen group: " << g << "\n"; */
                 // choose a random level
-                vector<float> lvls = unique(VectorXf(d.X.row(g)));
+                vector<float> lvls = unique(VectorXf(d.feature(g).matrix()));
                 // remove levels not in protect_levels[g]
                 for (int i = lvls.size()-1; i --> 0; )
                 {
@@ -132,77 +141,41 @@ vector<size_t> FairLexicase::select(Population& pop,
                     }
                 }
 
-                x_idx = (d.X.row(g).array() == level);
+                x_idx = (d.feature(g) == level);
                 /* cout << "x_idx count: " << x_idx.count() << "\n"; */
+                VectorXf in_group = x_idx.cast<float>().matrix();
+                for (auto j : pool.members())
+                    group(j) = pop.errors.row(j).dot(in_group);
             }
-            const ArrayXb& case_idx = (d.cases.empty() ? 
-                                x_idx : d.cases.at(shuff_idx[h]));
+            else
+                group = group_error.col(shuff_idx[h]);
+
             // get fitness of everyone in the pool
-            ArrayXf fitness(pool.size());
-            for (size_t j = 0; j<pool.size(); ++j)
+            for (auto j : pool.members())
             {
                 if (r() < 0.5)
                 {
                     // half the time use loss
-                    fitness(j) = case_idx.select(
-                            pop.individuals.at(pool[j]).error,
-                            0).sum();
+                    fitness(j) = group(j);
                 }
                 else
                 {
                     // half the time, look at fairness
-                    fitness(j) = fabs(pop.individuals.at(pool[j]).error.sum()
-                                      - case_idx.select(
-                                        pop.individuals.at(pool[j]).error,
-                                        0).sum());
+                    fitness(j) = fabs(total(j) - group(j));
                 }
             }
             // get epsilon for the fitnesses
-            float epsilon = mad(fitness);
-            //
-            winner.resize(0);   // winners                  
-            // minimum error on case
-            float minfit = std::numeric_limits<float>::max();                     
-
-            // get minimum
-            for (size_t j = 0; j<pool.size(); ++j)
-            {
-                if (fitness(j) < minfit) 
-                  minfit = fitness(j);
-            }
+            float epsilon = mad(core.gather(pool, fitness.data()));
 
             // select best
-            for (size_t j = 0; j<pool.size(); ++j)
-            {
-                if (fitness(j) <= minfit+epsilon)
-                    winner.push_back(pool[j]);                 
-            }
-
-            /* cout << "h: " << h << endl; */
-            /* cout << "winner size: " << winner.size() << "\n"; */
-            ++h; // next case
-            // only keep going if needed
-            pass = (winner.size()>1 
-                   && h<shuff_idx.size()); 
-
-            if(winner.size() == 0)
-            {
-                if(h >= d.group_intersections)
-                    winner.push_back(r.random_choice(pool));
-                else
-                    pass = true;
-            }
-            else
-            {
-                // reduce pool to remaining individuals
-                pool = winner;    
-            }
-      
-        }       
-    
-        assert(winner.size()>0);
-        //if more than one winner, pick randomly
-        selected.at(i) = r.random_choice(winner);   
+            float threshold = core.min(pool, fitness.data()) + epsilon;
+            core.keep(pool, fitness.data(), threshold);
+            return threshold;
+        };
+
+        size_t n_cases;
+        float threshold;
+        selected.at(i) = core.select(shuff_idx, filter, n_cases, threshold);
     }               
 
     if (selected.size() != pop.individuals.size())
@@ -0,0 +1,231 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "lexicase_core.h"
+
+// as with the math kernels, x86-64 Linux builds clone the column scans for
+// AVX-512, AVX2 and the baseline ISA.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) \
+    && defined(__linux__)
+    #define SCAN __attribute__((target_clones("avx512f","avx2","default")))
+#else
+    #define SCAN
+#endif
+
+namespace FT{
+namespace Sel{
+
+static const uint64_t FULL = ~uint64_t(0);
+
+/// blocks with fewer members than this are visited member by member
+static const int DENSE = 8;
+
+static inline int popcount(uint64_t w) { return __builtin_popcountll(w); }
+
+static inline int lowest(uint64_t w) { return __builtin_ctzll(w); }
+
+/// smallest of 64 values. NaNs are ignored, as in `x < m`.
+SCAN static float block_min(const float* x)
+{
+    // independent lanes, so the loop vectorizes without reassociating
+    float lane[16];
+    for (int l = 0; l < 16; ++l)
+        lane[l] = std::numeric_limits<float>::max();
+    for (int k = 0; k < 64; k += 16)
+        for (int l = 0; l < 16; ++l)
+            lane[l] = x[k+l] < lane[l] ? x[k+l] : lane[l];
+
+    float m = lane[0];
+    for (int l = 1; l < 16; ++l)
+        m = lane[l] < m ? lane[l] : m;
+    return m;
+}
+
+/// bit k is set if x[k] <= t (x[k] < t if strict)
+SCAN static uint64_t block_mask(const float* x, float t, bool strict)
+{
+    uint64_t m = 0;
+    if (strict)
+        for (int k = 0; k < 64; ++k)
+            m |= uint64_t(x[k] < t) << k;
+    else
+        for (int k = 0; k < 64; ++k)
+            m |= uint64_t(x[k] <= t) << k;
+    return m;
+}
+
+CasePool::CasePool(size_t P) : words((P+63)/64, FULL), P(P)
+{
+    // clear the bits past the end of the population
+    if (P % 64)
+        words.back() = (uint64_t(1) << (P % 64)) - 1;
+}
+
+size_t CasePool::count() const
+{
+    size_t n = 0;
+    for (const auto& w : words)
+        n += popcount(w);
+    return n;
+}
+
+bool CasePool::empty() const
+{
+    for (const auto& w : words)
+        if (w)
+            return false;
+    return true;
+}
+
+bool CasePool::contains(size_t i) const
+{
+    return (words.at(i/64) >> (i%64)) & 1;
+}
+
+void CasePool::add(size_t i)
+{
+    words.at(i/64) |= uint64_t(1) << (i%64);
+}
+
+void CasePool::clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+vector<size_t> CasePool::members() const
+{
+    vector<size_t> m;
+    for (size_t b = 0; b < words.size(); ++b)
+        for (uint64_t w = words[b]; w; w &= w-1)
+            m.push_back(64*b + lowest(w));
+    return m;
+}
+
+LexicaseCore::LexicaseCore(const MatrixXf& errors) : E(errors) {}
+
+ArrayXf LexicaseCore::epsilons() const
+{
+    ArrayXf epsilon(N());
+
+    #pragma omp parallel for
+    for (unsigned i = 0; i < N(); ++i)
+        epsilon(i) = mad(E.col(i).array());
+
+    return epsilon;
+}
+
+void LexicaseCore::check_weights(const Parameters& params) const
+{
+    if (params.classification && !params.class_weights.empty()
+            && params.sample_weights.size() != N())
+        THROW_LENGTH_ERROR("there are " 
+                + to_string(params.sample_weights.size()) 
+                + " sample weights for " + to_string(N()) + " cases");
+}
+
+vector<size_t> LexicaseCore::case_order(const Parameters& params) const
+{
+    size_t N = this->N();
+    vector<size_t> cases; // cases (samples)
+    if (params.classification && !params.class_weights.empty())
+    {
+        // for classification problems, weight case selection
+        // by class weights
+        assert(params.sample_weights.size() == N 
+                && " there must be one sample weight per case");
+        cases = r.weighted_order(params.sample_weights);
+    }
+    else
+    {   // otherwise, choose cases randomly
+        cases.resize(N);
+        std::iota(cases.begin(),cases.end(),0);
+        r.shuffle(cases.begin(),cases.end());   // shuffle cases
+    }
+    return cases;
+}
+
+float LexicaseCore::min(const CasePool& pool, const float* x) const
+{
+    float m = std::numeric_limits<float>::max();
+    for (size_t b = 0; b < pool.words.size(); ++b)
+    {
+        uint64_t w = pool.words[b];
+        if (w == FULL)
+        {
+            float bm = block_min(x + 64*b);
+            m = bm < m ? bm : m;
+        }
+        else
+        {
+            for (; w; w &= w-1)
+            {
+                float v = x[64*b + lowest(w)];
+                m = v < m ? v : m;
+            }
+        }
+    }
+    return m;
+}
+
+size_t LexicaseCore::keep(CasePool& pool, const float* x, float t,
+                          bool strict) const
+{
+    size_t n = 0;
+    for (size_t b = 0; b < pool.words.size(); ++b)
+    {
+        uint64_t& w = pool.words[b];
+        if (!w)
+            continue;
+        // the last block may run past the population
+        if (popcount(w) >= DENSE && 64*(b+1) <= pool.P)
+            w &= block_mask(x + 64*b, t, strict);
+        else
+        {
+            for (uint64_t v = w; v; v &= v-1)
+            {
+                int k = lowest(v);
+                float e = x[64*b + k];
+                if (strict ? !(e < t) : !(e <= t))
+                    w &= ~(uint64_t(1) << k);
+            }
+        }
+        n += popcount(w);
+    }
+    return n;
+}
+
+VectorXf LexicaseCore::gather(const CasePool& pool, const float* x) const
+{
+    VectorXf v(pool.count());
+    size_t j = 0;
+    for (size_t b = 0; b < pool.words.size(); ++b)
+        for (uint64_t w = pool.words[b]; w; w &= w-1)
+            v(j++) = x[64*b + lowest(w)];
+    return v;
+}
+
+size_t LexicaseCore::random_member(const CasePool& pool) const
+{
+    size_t n = pool.count();
+    assert(n > 0 && " attempting to pick from an empty pool");
+
+    size_t k = r.rnd_int(0, n-1);
+    for (size_t b = 0; b < pool.words.size(); ++b)
+    {
+        uint64_t w = pool.words[b];
+        size_t c = popcount(w);
+        if (k < c)
+        {
+            for (; k > 0; --k)
+                w &= w-1;
+            return 64*b + lowest(w);
+        }
+        k -= c;
+    }
+    return 0;
+}
+
+}
+}
@@ -0,0 +1,148 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#ifndef LEXICASE_CORE_H
+#define LEXICASE_CORE_H
+
+#include <cstdint>
+#include "selection_operator.h"
+
+namespace FT{
+namespace Sel{
+
+    ////////////////////////////////////////////////////////////// Declarations
+    /*!
+     * @class CasePool
+     * @brief the individuals left in a lexicase pool, as a bitset.
+     */
+    struct CasePool
+    {
+        vector<uint64_t> words;
+        size_t P;       ///< population size
+
+        /// a pool holding all P individuals
+        CasePool(size_t P = 0);
+
+        /// number of individuals in the pool
+        size_t count() const;
+
+        bool empty() const;
+
+        bool contains(size_t i) const;
+
+        /// adds individual i to the pool
+        void add(size_t i);
+
+        /// removes everyone from the pool
+        void clear();
+
+        /// indices of the individuals in the pool
+        vector<size_t> members() const;
+    };
+
+    /*!
+     * @class LexicaseCore
+     * @brief filters lexicase pools on the columns of an error matrix.
+     * used by all the lexicase selection operators.
+     *
+     * Errors are stored P x N with one column per case (see
+     * Population::errors), so each filter scans one contiguous column.
+     * Fully occupied 64-individual blocks of the pool are scanned with
+     * vectorized loops; sparse blocks only visit their members.
+     */
+    class LexicaseCore
+    {
+        public:
+            LexicaseCore(const MatrixXf& errors);
+
+            size_t P() const { return E.rows(); }
+            size_t N() const { return E.cols(); }
+
+            /// median absolute deviation of each case, computed in parallel
+            ArrayXf epsilons() const;
+
+            /// throws std::length_error unless params has a sample weight
+            /// for each case, when case_order() draws by weight. call it 
+            /// before selecting in parallel.
+            void check_weights(const Parameters& params) const;
+
+            /// order to visit the cases in. for classification with class
+            /// weights, cases are drawn by sample weight.
+            vector<size_t> case_order(const Parameters& params) const;
+
+            /// smallest value of x among the pool members. x has P values.
+            float min(const CasePool& pool, const float* x) const;
+            float min(const CasePool& pool, size_t c) const
+            { return min(pool, E.col(c).data()); }
+
+            /// removes the members of pool with x above t (at or above t
+            /// if strict). returns the number of members left.
+            size_t keep(CasePool& pool, const float* x, float t,
+                        bool strict=false) const;
+            size_t keep(CasePool& pool, size_t c, float t,
+                        bool strict=false) const
+            { return keep(pool, E.col(c).data(), t, strict); }
+
+            /// values of x for the pool members, in the order of members()
+            VectorXf gather(const CasePool& pool, const float* x) const;
+            VectorXf gather(const CasePool& pool, size_t c) const
+            { return gather(pool, E.col(c).data()); }
+
+            /// a random member of the pool
+            size_t random_member(const CasePool& pool) const;
+
+            /*!
+             * runs one selection event over cases. filter(winners, h)
+             * narrows winners, which starts as a copy of the pool, on the
+             * case cases[h], and returns the threshold it used. as in
+             * lexicase selection, if no one is left on a case, the case is
+             * skipped, and if no one is left on the last case, a random
+             * member of the pool wins.
+             * @param[out] n_cases: number of cases used
+             * @param[out] threshold: the last threshold used
+             * @return the selected individual
+             */
+            template<class Filter>
+            size_t select(const vector<size_t>& cases, Filter filter,
+                          size_t& n_cases, float& threshold) const
+            {
+                CasePool pool(P()), winner;
+                size_t h = 0;
+                bool pass = cases.size() > 0;
+                threshold = 0;
+
+                while (pass)
+                {
+                    winner = pool;
+                    threshold = filter(winner, h);
+                    ++h;
+                    size_t n = winner.count();
+                    // only keep going if needed
+                    pass = (n>1 && h<cases.size());
+
+                    if (n == 0)
+                    {
+                        if (h >= cases.size())
+                        {
+                            n_cases = h;
+                            return random_member(pool);
+                        }
+                        pass = true;
+                    }
+                    else
+                        std::swap(pool, winner);
+                }
+                n_cases = h;
+                //if more than one winner, pick randomly
+                return random_member(pool);
+            }
+
+        private:
+            const MatrixXf& E;
+    };
+}
+}
+
+#endif
@@ -0,0 +1,160 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "nd_sort.h"
+
+namespace FT{
+namespace Sel{
+
+/// true if row a dominates row b, given that a comes first
+/// lexicographically: a is nowhere worse than b, and is not equal to b.
+static inline bool dominates(const float* a, const float* b, size_t M)
+{
+    bool better = false;
+    for (size_t k = 0; k < M; ++k)
+    {
+        if (a[k] > b[k])
+            return false;
+        better |= a[k] < b[k];
+    }
+    return better;
+}
+
+/// true if a member of front dominates row i
+static bool dominated(const Objectives& F, const vector<int>& front, int i)
+{
+    const size_t M = F.cols();
+    // in two dimensions, the last member added has the smallest second
+    // objective in the front, so it is the only one that can dominate i
+    if (M == 2)
+        return dominates(F.row(front.back()).data(), F.row(i).data(), M);
+
+    // later members are closer to i in the sort, so they are tried first
+    for (auto it = front.rbegin(); it != front.rend(); ++it)
+        if (dominates(F.row(*it).data(), F.row(i).data(), M))
+            return true;
+    return false;
+}
+
+/// rows of F in lexicographic order, ties broken by row
+static vector<int> lexicographic_order(const Objectives& F)
+{
+    vector<int> order(F.rows());
+    std::iota(order.begin(), order.end(), 0);
+    const size_t M = F.cols();
+    std::sort(order.begin(), order.end(), [&](int a, int b){
+            const float* x = F.row(a).data();
+            const float* y = F.row(b).data();
+            for (size_t k = 0; k < M; ++k)
+                if (x[k] != y[k])
+                    return x[k] < y[k];
+            return a < b;
+            });
+    return order;
+}
+
+Objectives objectives(const vector<Individual>& individuals)
+{
+    const size_t M = individuals.empty() ? 0 : individuals.at(0).obj.size();
+    for (const auto& ind : individuals)
+        if (ind.obj.size() != M)
+            THROW_LENGTH_ERROR("individuals have different numbers of "
+                    "objectives");
+
+    Objectives F(individuals.size(), M);
+
+    #pragma omp parallel for
+    for (unsigned i = 0; i < individuals.size(); ++i)
+        for (size_t k = 0; k < M; ++k)
+        {
+            float o = individuals[i].obj[k];
+            F(i,k) = std::isnan(o) ? std::numeric_limits<float>::infinity()
+                                   : o;
+        }
+
+    return F;
+}
+
+vector<vector<int>> nd_sort(const Objectives& F)
+{
+    vector<vector<int>> fronts;
+
+    for (int i : lexicographic_order(F))
+    {
+        // if a member of front k dominates i, so does a member of every
+        // front before k, so the first front i fits in is found by bisection
+        size_t lo = 0, hi = fronts.size();
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi)/2;
+            if (dominated(F, fronts[mid], i))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == fronts.size())
+            fronts.push_back(vector<int>());
+        fronts[lo].push_back(i);
+    }
+
+    // keep the fronts independent of the sort, as the selection is
+    for (auto& f : fronts)
+        std::sort(f.begin(), f.end());
+
+    return fronts;
+}
+
+vector<int> nd_front(const Objectives& F)
+{
+    vector<int> front;
+
+    for (int i : lexicographic_order(F))
+        if (front.empty() || !dominated(F, front, i))
+            front.push_back(i);
+
+    std::sort(front.begin(), front.end());
+    return front;
+}
+
+ArrayXf crowding_distance(const Objectives& F, const vector<int>& front)
+{
+    const float inf = std::numeric_limits<float>::max();
+    const size_t n = front.size(), M = F.cols();
+    if (n == 0)
+        return ArrayXf();
+
+    // contribution of each objective
+    ArrayXXf d = ArrayXXf::Zero(n, M);
+
+    #pragma omp parallel for
+    for (unsigned m = 0; m < M; ++m)
+    {
+        vector<int> o(n);
+        std::iota(o.begin(), o.end(), 0);
+        std::stable_sort(o.begin(), o.end(), [&](int a, int b){
+                return F(front[a],m) < F(front[b],m); });
+
+        // the extremes are always kept
+        d(o[0],m) = inf;
+        d(o[n-1],m) = inf;
+
+        float range = F(front[o[n-1]],m) - F(front[o[0]],m);
+        if (!(range > 0))
+            continue;
+        for (size_t i = 1; i+1 < n; ++i)
+            d(o[i],m) = (F(front[o[i+1]],m) - F(front[o[i-1]],m)) / range;
+    }
+
+    ArrayXf dist(n);
+
+    #pragma omp parallel for
+    for (unsigned i = 0; i < n; ++i)
+        dist(i) = (d.row(i) == inf).any() ? inf : d.row(i).sum();
+
+    return dist;
+}
+
+}
+}
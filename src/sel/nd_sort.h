@@ -0,0 +1,53 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#ifndef ND_SORT_H
+#define ND_SORT_H
+
+#include "../pop/individual.h"
+
+namespace FT{
+namespace Sel{
+
+    ////////////////////////////////////////////////////////////// Declarations
+
+    /// objectives of a set of programs, one row per program. all objectives
+    /// are minimized.
+    typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>
+        Objectives;
+
+    /// copies the obj vectors of individuals into a matrix, in parallel.
+    /// NaNs are stored as +inf so that the rows have a well defined order.
+    Objectives objectives(const vector<Individual>& individuals);
+
+    /*!
+     * non-dominated sorting of the rows of F, following the efficient
+     * non-dominated sort with binary search (ENS-BS). rows are visited in
+     * lexicographic order, so that every row is visited after the rows that
+     * dominate it, and placed in the first front with no member
+     * dominating it. with two objectives, only the last member of a front
+     * needs checking, and the sort takes O(P log P).
+     *
+     * dominance is the same as in Individual::check_dominance(), so rows
+     * with equal objectives share a front.
+     * @return the fronts, best first, each in increasing row order
+     */
+    vector<vector<int>> nd_sort(const Objectives& F);
+
+    /// the first front of nd_sort(F), without sorting the rest
+    vector<int> nd_front(const Objectives& F);
+
+    /*!
+     * crowding distance of the members of a front, as in NSGA-II. the
+     * extremes of every objective get the largest float. objectives with
+     * no spread in the front add nothing. objectives are handled in
+     * parallel.
+     * @return distance of front[i] at i
+     */
+    ArrayXf crowding_distance(const Objectives& F, const vector<int>& front);
+}
+}
+
+#endif
@@ -17,16 +17,16 @@ namespace FT{
         
         NSGA2::~NSGA2(){}
         
-        size_t NSGA2::tournament(vector<Individual>& pop, size_t i, size_t j) const 
+        size_t NSGA2::tournament(const vector<Individual>& pop, size_t i,
+                                 size_t j) const 
         {
-            Individual& ind1 = pop.at(i);
-            Individual& ind2 = pop.at(j);
+            // crowded comparison: lower rank wins, then larger crowding
+            const Individual& ind1 = pop.at(i);
+            const Individual& ind2 = pop.at(j);
 
-            int flag = ind1.check_dominance(ind2);
-            
-            if (flag == 1) // ind1 dominates ind2
+            if (ind1.rank < ind2.rank)
                 return i;
-            else if (flag == -1) // ind2 dominates ind1
+            else if (ind2.rank < ind1.rank)
                 return j;
             else if (ind1.crowd_dist > ind2.crowd_dist)
                 return i;
@@ -58,8 +58,18 @@ namespace FT{
             if (params.current_gen==0)
                 return pool;
 
-            // TODO: check if selected initialization and push back are right
-            vector<size_t> selected(pop.size()); 
+            // rank the population and crowd each front, in case it did not
+            // come from NSGA-II survival
+            #pragma omp parallel for
+            for (unsigned int i=0; i<pop.size(); ++i)
+                pop.individuals.at(i).set_obj(params.objectives);
+
+            fast_nds(pop.individuals);
+            for (int i = 0; i < front.size(); ++i)
+                crowding_distance(pop,i);
+
+            vector<size_t> selected;
+            selected.reserve(pop.size());
 
             for (int i = 0; i < pop.size(); ++i)
             {
@@ -98,7 +108,8 @@ namespace FT{
             // Push back selected individuals until full
             vector<size_t> selected;
             int i = 0;
-            while ( selected.size() + front.at(i).size() < params.pop_size)
+            while ( i < front.size() && 
+                    selected.size() + front.at(i).size() < params.pop_size)
             {
                 std::vector<int>& Fi = front.at(i);        // indices in front i
                 crowding_distance(pop,i);                   // calculate crowding in Fi
@@ -109,6 +120,9 @@ namespace FT{
                 ++i;
             }
 
+            if (i == front.size())
+                return selected;
+
             crowding_distance(pop,i);   // calculate crowding in final front to include
             std::sort(front.at(i).begin(),front.at(i).end(),sort_n(pop));
 
@@ -121,114 +135,23 @@ namespace FT{
 
         void NSGA2::fast_nds(vector<Individual>& individuals) 
         {
-            front.resize(1);
-            front.at(0).clear();
-            //std::vector< std::vector<int> >  F(1);
-            #pragma omp parallel for
-            for (int i = 0; i < individuals.size(); ++i) {
-            
-                std::vector<unsigned int> dom;
-                int dcount = 0;
-            
-                Individual& p = individuals.at(i);
-                // p.dcounter  = 0;
-                // p.dominated.clear();
-            
-                for (int j = 0; j < individuals.size(); ++j) {
-                
-                    Individual& q = individuals.at(j);
-                
-                    int compare = p.check_dominance(q);
-                    if (compare == 1) { // p dominates q
-                        //p.dominated.push_back(j);
-                        dom.push_back(j);
-                    } else if (compare == -1) { // q dominates p
-                        //p.dcounter += 1;
-                        dcount += 1;
-                    }
-                }
-            
-                #pragma omp critical
-                {
-                    p.dcounter  = dcount;
-                    p.dominated.clear();
-                    p.dominated = dom;
-                
-                
-                    if (p.dcounter == 0) {
-                        p.set_rank(1);
-                        front.at(0).push_back(i);
-                    }
-                }
-            
-            }
-            
-            // using OpenMP can have different orders in the front.at(0)
-            // so let's sort it so that the algorithm is deterministic
-            // given a seed
-            std::sort(front.at(0).begin(), front.at(0).end());    
-
-            int fi = 1;
-            while (front.at(fi-1).size() > 0) {
-
-                std::vector<int>& fronti = front.at(fi-1);
-                std::vector<int> Q;
-                for (int i = 0; i < fronti.size(); ++i) {
-
-                    Individual& p = individuals.at(fronti.at(i));
-
-                    for (int j = 0; j < p.dominated.size() ; ++j) {
-
-                        Individual& q = individuals.at(p.dominated.at(j));
-                        q.dcounter -= 1;
-
-                        if (q.dcounter == 0) {
-                            q.set_rank(fi+1);
-                            Q.push_back(p.dominated.at(j));
-                        }
-                    }
-                }
-
-                fi += 1;
-                front.push_back(Q);
-            }
+            F = objectives(individuals);
+            front = nd_sort(F);
 
+            #pragma omp parallel for
+            for (int i = 0; i < front.size(); ++i)
+                for (const auto& j : front.at(i))
+                    individuals.at(j).set_rank(i+1);
         }
 
         void NSGA2::crowding_distance(Population& pop, int fronti)
         {
-            std::vector<int> F = front.at(fronti);
-            if (F.size() == 0 ) return;
-
-            const int fsize = F.size();
-
-            for (int i = 0; i < fsize; ++i)
-                pop.individuals.at(F.at(i)).crowd_dist = 0;
-       
+            const std::vector<int>& Fi = front.at(fronti);
+            ArrayXf dist = Sel::crowding_distance(F, Fi);
 
-            const int limit = pop.individuals.at(0).obj.size();
-            for (int m = 0; m < limit; ++m) {
-
-                std::sort(F.begin(), F.end(), comparator_obj(pop,m));
-
-                // in the paper dist=INF for the first and last, in the code
-                // this is only done to the first one or to the two first when size=2
-                pop.individuals.at(F.at(0)).crowd_dist = std::numeric_limits<float>::max();
-                if (fsize > 1)
-                    pop.individuals.at(F.at(fsize-1)).crowd_dist = std::numeric_limits<float>::max();
-            
-                for (int i = 1; i < fsize-1; ++i) 
-                {
-                    if (pop.individuals.at(F.at(i)).crowd_dist != std::numeric_limits<float>::max()) 
-                    {   // crowd over obj
-                        pop.individuals.at(F.at(i)).crowd_dist +=
-                            (pop.individuals.at(F.at(i+1)).obj.at(m) - pop.individuals.at(F.at(i-1)).obj.at(m)) 
-                            / (pop.individuals.at(F.at(fsize-1)).obj.at(m) - pop.individuals.at(F.at(0)).obj.at(m));
-                    }
-                }
-            }        
+            for (int i = 0; i < Fi.size(); ++i)
+                pop.individuals.at(Fi.at(i)).crowd_dist = dist(i);
         }
     }
     
 }
-
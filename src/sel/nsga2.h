@@ -6,6 +6,7 @@ license: GNU/GPL v3
 #define PARETO_H
 
 #include "selection_operator.h"
+#include "nd_sort.h"
 
 namespace FT{
 
@@ -33,7 +34,10 @@ namespace FT{
             //< the Pareto fronts
             vector<vector<int>> front;                
 
-            //< Fast non-dominated sorting
+            //< objectives of the last sorted individuals
+            Objectives F;
+
+            //< Fast non-dominated sorting. sets the ranks of individuals.
             void fast_nds(vector<Individual>&);                
 
             //< crowding distance of a front i
@@ -58,17 +62,8 @@ namespace FT{
                     };
                 };
 
-                /// sort based on objective m
-                struct comparator_obj 
-                {
-                    const Population& pop;      ///< population address
-                    int m;                      ///< objective index 
-                    comparator_obj(const Population& population, int index) 
-                        : pop(population), m(index) {};
-                    bool operator() (int i, int j) { return pop[i].obj[m] < pop[j].obj[m]; };
-                };
-            
-                size_t tournament(vector<Individual>& pop, size_t i, size_t j) const;
+                size_t tournament(const vector<Individual>& pop, size_t i,
+                                  size_t j) const;
         };
         
     }
@@ -4,6 +4,7 @@ license: GNU/GPL v3
 */
 
 #include "pareto_lexicase.h"
+#include "lexicase_core.h"
 
 namespace FT{
 namespace Sel{
@@ -34,19 +35,23 @@ vector<size_t> ParetoLexicase::select(Population& pop,
     for (unsigned int i=0; i<pop.size(); ++i)
         pop.individuals.at(i).set_obj(params.objectives);
 
-    //< number of samples
-    unsigned int N = pop.individuals.at(0).error.size(); 
+    pop.update_errors();
+    LexicaseCore core(pop.errors);
+    core.check_weights(params);
+
     //< number of individuals
     unsigned int P = pop.individuals.size();
-    
-    // selection pool
-    vector<size_t> starting_pool;
-    for (int i = 0; i < pop.individuals.size(); ++i)
-    {
-        starting_pool.push_back(i);
-    }
-    assert(starting_pool.size() == P);   
 
+    // if output is continuous, use epsilon lexicase            
+    bool continuous = (!params.classification 
+            || params.scorer_.compare("log")==0 
+            || params.scorer_.compare("multi_log")==0);
+
+    // secondary objective
+    VectorXf complexity(P);
+    for (unsigned int i = 0; i<P; ++i)
+        complexity(i) = (float) pop.individuals.at(i).get_complexity();
+    
     // selected individuals
     vector<size_t> selected(P,0);
     
@@ -62,97 +67,30 @@ vector<size_t> ParetoLexicase::select(Population& pop,
     #pragma omp parallel for 
     for (unsigned int i = 0; i<P; ++i)
     {
-        vector<size_t> cases; // cases (samples)
-        if (params.classification && !params.class_weights.empty()) 
-        {
-            // for classification problems, weight case selection 
-            // by class weights
-            vector<size_t> choices(N);
-            std::iota(choices.begin(), choices.end(),0);
-            vector<float> sample_weights = params.sample_weights;
-            for (unsigned i = 0; i<N; ++i)
-            {
-                vector<size_t> choice_idxs(N-i);
-                std::iota(choice_idxs.begin(),choice_idxs.end(),0);
-                size_t idx = r.random_choice(choice_idxs,
-                        sample_weights);
-                cases.push_back(choices.at(idx));
-                choices.erase(choices.begin() + idx);
-                sample_weights.erase(sample_weights.begin() + idx);
-            }
-        }
-        else
-        {   // otherwise, choose cases randomly
-            cases.resize(N); 
-            std::iota(cases.begin(),cases.end(),0);
-            r.shuffle(cases.begin(),cases.end());   // shuffle cases
-        }
+        vector<size_t> cases = core.case_order(params);
 
-        vector<size_t> pool = starting_pool;    // initial pool   
-        vector<size_t> winner;                  // winners
-    
-        bool pass = true;     // checks pool size and number of cases
-        unsigned int h = 0;   // case count, index used in cases[h]
-
-        float error_epsilon;
-
-        while(pass){    // main loop
+        // keep the first epsilon-front of the pool on error and complexity
+        auto filter = [&](CasePool& pool, size_t h)
+        {
             // Calculating epsilons on demand
-            error_epsilon = 0;
+            VectorXf pool_error = core.gather(pool, cases[h]);
+            VectorXf pool_complexity = core.gather(pool, complexity.data());
 
-            // if output is continuous, use epsilon lexicase            
-            if (!params.classification || params.scorer_.compare("log")==0 
-            ||  params.scorer_.compare("multi_log")==0)
-            {
-                VectorXf pool_error(pool.size());
-                for (int j = 0; j<pool.size(); ++j)
-                {
-                    pool_error(j) = pop.individuals.at(pool[j]).error(cases[h]);
-                }
-                error_epsilon = mad(pool_error);
-            }
-            
-            float complexity_epsilon;
-            VectorXf pool_complexity(pool.size());
-            for (int j = 0; j<pool.size(); ++j)
-            {
-                pool_complexity(j) = 
-                    (float) pop.individuals.at(pool[j]).get_complexity();
-            }
-            complexity_epsilon = mad(pool_complexity);
-            
-            winner.resize(0);   // winners     
+            float error_epsilon = continuous? mad(pool_error) : 0;
+            float complexity_epsilon = mad(pool_complexity);
 
             // fast non-dominated epsilon-sort
             vector<float> eps{error_epsilon, complexity_epsilon};
-            fast_eNDS(pop.individuals, pool, cases[h], eps);
-
-            // get winners based on relative index used in pool
-            winner.reserve(winner.size() + distance(front.begin(),front.end()));
-            winner.insert(winner.end(), front.begin(), front.end());
-            
-            ++h; // next case 
-            // only keep going if needed
-            pass = (winner.size()>1 && h<cases.size()); 
-            
-            if(winner.size() == 0)
-            {
-                if(h >= cases.size())
-                    winner.push_back(r.random_choice(pool));
-                else
-                    pass = true;
-            }
-            else
-                pool = winner; // reduce pool to remaining individuals
-        }       
+            vector<size_t> members = pool.members();
+            pool.clear();
+            for (auto j : fast_eNDS(pool_error, pool_complexity, eps))
+                pool.add(members.at(j));
 
-        assert(winner.size()>0);
+            return error_epsilon;
+        };
 
-        n_cases_used[i] = h;
-        thresholds[i]   = error_epsilon;
-
-        //if more than one winner, pick randomly
-        selected.at(i) = r.random_choice(winner);   
+        selected.at(i) = core.select(cases, filter, 
+                n_cases_used[i], thresholds[i]);
     }
 
     if (selected.size() != pop.individuals.size())
@@ -211,54 +149,33 @@ auto ParetoLexicase::epsi_dominated(vector<float> const &lhs,
     // bool accept = d != Dominance::None;
 }
 
-void ParetoLexicase::fast_eNDS(
-    vector<Individual>& individuals, vector<size_t>& pool, 
-    size_t case_id, vector<float> eps)
+vector<size_t> ParetoLexicase::fast_eNDS(const VectorXf& error, 
+    const VectorXf& complexity, vector<float> eps) const
 {
-    front.clear();
+    vector<size_t> front;
 
-    // create vectors of individuals objectives here
-    #pragma omp parallel for
-    for (int i = 0; i < pool.size(); ++i) {
+    for (int i = 0; i < error.size(); ++i) {
     
-        std::vector<unsigned int> dom;
         int dcount = 0;
     
         // TODO: work with any secundary objective, not just complexity
-        Individual& p = individuals.at(pool[i]);
-        vector<float> p_obj{p.error(case_id), (float)p.complexity};
-        // p.dcounter  = 0;
-        // p.dominated.clear();
+        vector<float> p_obj{error(i), complexity(i)};
     
-        for (int j = 0; j < pool.size(); ++j)
+        for (int j = 0; j < error.size() && dcount == 0; ++j)
         {
-            Individual& q = individuals.at(pool[j]);
-            vector<float> q_obj{q.error(case_id), (float)q.complexity};
+            vector<float> q_obj{error(j), complexity(j)};
         
             // TODO: unify e, epsi, eps (maybe epsilon)
             auto compare = epsi_dominated(p_obj, q_obj, eps);
 
-            if (compare == eDominance::Right) { // p dominates q
-                //p.dominated.push_back(j);
-                dom.push_back(pool[j]);
-            } else if (compare == eDominance::Left) { // q dominates p
-                //p.dcounter += 1;
+            if (compare == eDominance::Left) // q dominates p
                 dcount += 1;
-            }
         }
     
-        #pragma omp critical
-        {
-            p.dcounter  = dcount;
-            p.dominated.clear();
-            p.dominated = dom;
-        
-            if (p.dcounter == 0) {
-                p.set_rank(1);
-                front.push_back(pool[i]);
-            }
-        }
+        if (dcount == 0)
+            front.push_back(i);
     }
+    return front;
 }
 
 } // namespace FT
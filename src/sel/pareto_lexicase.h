@@ -50,13 +50,10 @@ namespace Sel{
 
             // pareto front of rank 0 using Fast non-dominated sorting, based
             // on the epsilon for test case t (eps_t) and epsilon for
-            // population complexity (eps_c)
-            void fast_eNDS(
-                vector<Individual>& individuals, vector<size_t>& pool,
-                size_t case_id, vector<float> eps);  
-
-            // Pareto front (just individuals in the rank 1). Used by fast_eNDS
-            vector<size_t> front;   
+            // population complexity (eps_c). returns positions in error
+            // and complexity, which hold the objectives of a pool.
+            vector<size_t> fast_eNDS(const VectorXf& error, 
+                const VectorXf& complexity, vector<float> eps) const;  
     };
 }
 }
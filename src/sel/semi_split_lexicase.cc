@@ -4,6 +4,7 @@ license: GNU/GPL v3
 */
 
 #include "semi_split_lexicase.h"
+#include "lexicase_core.h"
 
 namespace FT{
 namespace Sel{
@@ -24,18 +25,14 @@ vector<size_t> SemiDynamicSplitLexicase::select(Population& pop,
 
     // TODO: write proper docstring
     
+    pop.update_errors();
+    LexicaseCore core(pop.errors);
+    core.check_weights(params);
+
     //< number of samples
-    unsigned int N = pop.individuals.at(0).error.size(); 
+    unsigned int N = core.N(); 
     //< number of individuals
     unsigned int P = pop.individuals.size();
-    
-    // selection pool
-    vector<size_t> starting_pool;
-    for (int i = 0; i < pop.individuals.size(); ++i)
-    {
-        starting_pool.push_back(i);
-    }
-    assert(starting_pool.size() == P);   
 
     // selected individuals
     vector<size_t> selected(P,0);
@@ -49,11 +46,7 @@ vector<size_t> SemiDynamicSplitLexicase::select(Population& pop,
     thresholds.resize(P);
     std::fill(thresholds.begin(), thresholds.end(), 0);
 
-    // used to retrieve the split threshold used in each case (for logging)
-    vector<float> split_thresholds(N);
-    std::fill(split_thresholds.begin(), split_thresholds.end(), 0);
-         
-    // define epsilon
+    // define epsilon: the split threshold of each case
     ArrayXf epsilon = ArrayXf::Zero(N);
 
     // if output is continuous, use epsilon lexicase            
@@ -61,93 +54,27 @@ vector<size_t> SemiDynamicSplitLexicase::select(Population& pop,
     ||  params.scorer_.compare("multi_log")==0)
     {
         // for each sample, calculate epsilon
-        for (int i = 0; i<epsilon.size(); ++i)
-        {
-            VectorXf case_errors(pop.individuals.size());
-            for (int j = 0; j<pop.individuals.size(); ++j)
-            {
-                case_errors(j) = pop.individuals.at(j).error(i);
-            }
-
-            float split_threshold = find_threshold(case_errors);
-
-            split_thresholds[i] = split_threshold;   
-            epsilon(i) = split_threshold;
-        }
+        #pragma omp parallel for
+        for (unsigned int i = 0; i<N; ++i)
+            epsilon(i) = find_threshold(pop.errors.col(i).array());
     }
 
     // selection loop
     #pragma omp parallel for 
     for (unsigned int i = 0; i<P; ++i)
     {
-        vector<size_t> cases; // cases (samples)
-        if (params.classification && !params.class_weights.empty()) 
-        {
-            // for classification problems, weight case selection 
-            // by class weights
-            vector<size_t> choices(N);
-            std::iota(choices.begin(), choices.end(),0);
-            vector<float> sample_weights = params.sample_weights;
-            for (unsigned i = 0; i<N; ++i)
-            {
-                vector<size_t> choice_idxs(N-i);
-                std::iota(choice_idxs.begin(),choice_idxs.end(),0);
-                size_t idx = r.random_choice(choice_idxs,
-                        sample_weights);
-                cases.push_back(choices.at(idx));
-                choices.erase(choices.begin() + idx);
-                sample_weights.erase(sample_weights.begin() + idx);
-            }
-        }
-        else
-        {   // otherwise, choose cases randomly
-            cases.resize(N); 
-            std::iota(cases.begin(),cases.end(),0);
-            r.shuffle(cases.begin(),cases.end());   // shuffle cases
-        }
+        vector<size_t> cases = core.case_order(params);
 
-        vector<size_t> pool = starting_pool;    // initial pool   
-        vector<size_t> winner;                  // winners
-    
-        bool pass = true;     // checks pool size and number of cases
-        unsigned int h = 0;   // case count, index used in cases[h]
-        
-        while(pass){    // main loop
-            winner.resize(0);   // winners     
-
-            // criteria to stay in pool
+        // criteria to stay in pool
+        auto filter = [&](CasePool& pool, size_t h)
+        {
             float epsilon_threshold = epsilon[cases[h]];
+            core.keep(pool, cases[h], epsilon_threshold);
+            return epsilon_threshold;
+        };
 
-            // select best
-            for (size_t j = 0; j<pool.size(); ++j)
-                if (pop.individuals.at(pool[j]).error(cases[h]) 
-                        <= epsilon_threshold)
-                winner.push_back(pool[j]);    
-
-            ++h; // next case 
-
-            // only keep going if needed
-            pass = (winner.size()>1 && h<cases.size()); 
-            
-            if(winner.size() == 0)
-            {
-                if(h >= cases.size())
-                    winner.push_back(r.random_choice(pool));
-                else
-                    pass = true;
-            }
-            else
-                pool = winner; // reduce pool to remaining individuals
-        }       
-
-        assert(winner.size()>0);
-        
-        // last threshold value before ending the selection of individual i 
-        n_cases_used[i] = h;
-        thresholds[i]   = epsilon[cases[--h]];
-
-        //if more than one winner, pick randomly
-        selected.at(i) = r.random_choice(winner);   
+        selected.at(i) = core.select(cases, filter, 
+                n_cases_used[i], thresholds[i]);
     }
 
     if (selected.size() != pop.individuals.size())
@@ -4,6 +4,7 @@ license: GNU/GPL v3
 */
 
 #include "split_lexicase.h"
+#include "lexicase_core.h"
 
 namespace FT{
 namespace Sel{
@@ -29,18 +30,18 @@ vector<size_t> SplitLexicase::select(Population& pop,
     for (unsigned int i=0; i<pop.size(); ++i)
         pop.individuals.at(i).set_obj(params.objectives);
     
-    //< number of samples
-    unsigned int N = pop.individuals.at(0).error.size(); 
+    pop.update_errors();
+    LexicaseCore core(pop.errors);
+    core.check_weights(params);
+
     //< number of individuals
     unsigned int P = pop.individuals.size();
-    
-    // selection pool
-    vector<size_t> starting_pool;
-    for (int i = 0; i < pop.individuals.size(); ++i)
-    {
-        starting_pool.push_back(i);
-    }
-    assert(starting_pool.size() == P);   
+
+    // TODO: handle classification and regression here
+    // if output is continuous, use epsilon lexicase            
+    bool continuous = (!params.classification 
+            || params.scorer_.compare("log")==0 
+            || params.scorer_.compare("multi_log")==0);
 
     // selected individuals
     vector<size_t> selected(P,0);
@@ -57,104 +58,27 @@ vector<size_t> SplitLexicase::select(Population& pop,
     #pragma omp parallel for 
     for (unsigned int i = 0; i<P; ++i)
     {
-        vector<size_t> cases; // cases (samples)
-        if (params.classification && !params.class_weights.empty()) 
-        {
-            // for classification problems, weight case selection 
-            // by class weights
-            vector<size_t> choices(N);
-            std::iota(choices.begin(), choices.end(),0);
-            vector<float> sample_weights = params.sample_weights;
-            for (unsigned i = 0; i<N; ++i)
-            {
-                vector<size_t> choice_idxs(N-i);
-                std::iota(choice_idxs.begin(),choice_idxs.end(),0);
-                size_t idx = r.random_choice(choice_idxs,
-                        sample_weights);
-                cases.push_back(choices.at(idx));
-                choices.erase(choices.begin() + idx);
-                sample_weights.erase(sample_weights.begin() + idx);
-            }
-        }
-        else
-        {   // otherwise, choose cases randomly
-            cases.resize(N); 
-            std::iota(cases.begin(),cases.end(),0);
-            r.shuffle(cases.begin(),cases.end());   // shuffle cases
-        }
-
-        vector<size_t> pool = starting_pool;    // initial pool   
-        vector<size_t> winner;                  // winners
-    
-        bool pass = true;     // checks pool size and number of cases
-        unsigned int h = 0;   // case count, index used in cases[h]
+        vector<size_t> cases = core.case_order(params);
 
-        float split_threshold;
-        
-        while(pass){    // main loop
+        // keep the pool members below a threshold set on the pool's errors
+        auto filter = [&](CasePool& pool, size_t h)
+        {
             // Calculating epsilon on demand
-            split_threshold = 0;
-            float min_error = 0;
-            float max_error = 0;
-
-            // TODO: handle classification and regression here
-            // if output is continuous, use epsilon lexicase            
-            if (!params.classification || params.scorer_.compare("log")==0 
-            ||  params.scorer_.compare("multi_log")==0)
-            {
-                VectorXf pool_error(pool.size());
-                for (int j = 0; j<pool.size(); ++j)
-                {
-                    pool_error(j) = pop.individuals.at(pool[j]).error(cases[h]);
-                }
-                
-                split_threshold = find_threshold(pool_error);
-                min_error = pool_error.minCoeff();
-                max_error = pool_error.maxCoeff();
-            }
-
-            // handling when everyone is on the same side of the partition
-            if (split_threshold==0 // numeric error inside `find_threshold`
-            // || (split_threshold< min_error // no one would be selected
-            // ||  split_threshold>=max_error) // everyone is selected
-            ) {
-                ++h;      // next case (this skip will be in the stats)
-                continue; // skip calculations
-            }
-            
-            winner.resize(0);   // winners     
-
-            // select best
-            for (size_t j = 0; j<pool.size(); ++j)
-                if (pop.individuals.at(pool[j]).error(cases[h])
-                        < split_threshold) 
-                {
-                    winner.push_back(pool[j]);
-                }
-
-            ++h; // next case 
-
-            // only keep going if needed
-            pass = (winner.size()>1 && h<cases.size()); 
-            
-            if(winner.size() == 0)
-            {
-                if(h >= cases.size())
-                    winner.push_back(r.random_choice(pool));
-                else
-                    pass = true;
-            }
-            else
-                pool = winner; // reduce pool to remaining individuals
-        }       
+            float split_threshold = 0;
+            if (continuous)
+                split_threshold = find_threshold(core.gather(pool, cases[h]));
 
-        assert(winner.size()>0);
+            // handling when everyone is on the same side of the partition,
+            // or numeric error inside `find_threshold`: skip the case 
+            // (this skip will be in the stats)
+            if (split_threshold != 0)
+                core.keep(pool, cases[h], split_threshold, true);
 
-        n_cases_used[i] = h;
-        thresholds[i]   = split_threshold;
+            return split_threshold;
+        };
 
-        //if more than one winner, pick randomly
-        selected.at(i) = r.random_choice(winner);   
+        selected.at(i) = core.select(cases, filter, 
+                n_cases_used[i], thresholds[i]);
     }
 
     if (selected.size() != pop.individuals.size())
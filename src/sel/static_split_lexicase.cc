@@ -4,6 +4,7 @@ license: GNU/GPL v3
 */
 
 #include "static_split_lexicase.h"
+#include "lexicase_core.h"
 
 namespace FT{
 namespace Sel{
@@ -24,18 +25,14 @@ vector<size_t> StaticSplitLexicase::select(Population& pop,
 
     // TODO: write proper docstring
     
+    pop.update_errors();
+    LexicaseCore core(pop.errors);
+    core.check_weights(params);
+
     //< number of samples
-    unsigned int N = pop.individuals.at(0).error.size(); 
+    unsigned int N = core.N(); 
     //< number of individuals
     unsigned int P = pop.individuals.size();
-    
-    // selection pool
-    vector<size_t> starting_pool;
-    for (int i = 0; i < pop.individuals.size(); ++i)
-    {
-        starting_pool.push_back(i);
-    }
-    assert(starting_pool.size() == P);   
 
     // selected individuals
     vector<size_t> selected(P,0);
@@ -49,111 +46,32 @@ vector<size_t> StaticSplitLexicase::select(Population& pop,
     thresholds.resize(P);
     std::fill(thresholds.begin(), thresholds.end(), 0);
 
-    // used to retrieve the split threshold used in each case (for logging)
+    // the split threshold of each case. individuals at or below it are 
+    // within epsilon on the case.
     vector<float> split_thresholds(N);
-    std::fill(split_thresholds.begin(), split_thresholds.end(), 0);
-    
-    // this is how we decide who's going to stay in the pool. matrix is
-    // ind x test cases
-    ArrayXb fitness_within_eps(P, N);
+    #pragma omp parallel for
     for (unsigned int i = 0; i<N; ++i)
-    {
-        VectorXf pop_error(P);
-        for (unsigned int j = 0; j<P; ++j)
-        {
-            pop_error(j) = pop.individuals.at(j).error(i);
-        }
-
-        float split_threshold = find_threshold(pop_error);
-        for (unsigned int j = 0; j<P; ++j)
-        {
-            if (pop.individuals.at(j).error(i) <= split_threshold)
-                fitness_within_eps(j, i) = 0;
-            else
-                fitness_within_eps(j, i) = 1;
-        }
-        split_thresholds[i] = split_threshold;       
-    }
+        split_thresholds[i] = find_threshold(pop.errors.col(i).array());
 
     // selection loop
     #pragma omp parallel for 
     for (unsigned int i = 0; i<P; ++i)
     {
-        vector<size_t> cases; // cases (samples)
-        if (params.classification && !params.class_weights.empty()) 
-        {
-            // for classification problems, weight case selection 
-            // by class weights
-            vector<size_t> choices(N);
-            std::iota(choices.begin(), choices.end(),0);
-            vector<float> sample_weights = params.sample_weights;
-            for (unsigned i = 0; i<N; ++i)
-            {
-                vector<size_t> choice_idxs(N-i);
-                std::iota(choice_idxs.begin(),choice_idxs.end(),0);
-                size_t idx = r.random_choice(choice_idxs,
-                        sample_weights);
-                cases.push_back(choices.at(idx));
-                choices.erase(choices.begin() + idx);
-                sample_weights.erase(sample_weights.begin() + idx);
-            }
-        }
-        else
-        {   // otherwise, choose cases randomly
-            cases.resize(N); 
-            std::iota(cases.begin(),cases.end(),0);
-            r.shuffle(cases.begin(),cases.end());   // shuffle cases
-        }
-
-        vector<size_t> pool = starting_pool;    // initial pool   
-        vector<size_t> winner;                  // winners
-    
-        bool pass = true;     // checks pool size and number of cases
-        unsigned int h = 0;   // case count, index used in cases[h]
-        
-        while(pass){    // main loop
-            // TODO: handle classification here?
-            winner.resize(0);   // winners     
-               
-            // minimum error on case
-            float minfit = std::numeric_limits<float>::max();       
-
-            // get minimum
-            for (size_t j = 0; j<pool.size(); ++j)
-                if (fitness_within_eps(pool[j], cases[h]) < minfit) 
-                    minfit = fitness_within_eps(pool[j], cases[h]);
-            
-            // select best
-            for (size_t j = 0; j<pool.size(); ++j)
-                if ( fitness_within_eps(pool[j], cases[h])==minfit )
-                {
-                    winner.push_back(pool[j]);
-                }
+        vector<size_t> cases = core.case_order(params);
 
-            ++h; // next case 
-
-            // only keep going if needed
-            pass = (winner.size()>1 && h<cases.size()); 
-            
-            if(winner.size() == 0)
-            {
-                if(h >= cases.size())
-                    winner.push_back(r.random_choice(pool));
-                else
-                    pass = true;
-            }
-            else
-                pool = winner; // reduce pool to remaining individuals
-        }       
-
-        assert(winner.size()>0);
-        
-        // last threshold value before ending the selection of individual i 
-        n_cases_used[i] = h;
-        thresholds[i]   = split_thresholds[cases[--h]];
-
-        //if more than one winner, pick randomly
-        selected.at(i) = r.random_choice(winner);   
+        // TODO: handle classification here?
+        // keep the pool members within epsilon, if there are any; 
+        // otherwise they're all equally bad on the case
+        auto filter = [&](CasePool& pool, size_t h)
+        {
+            CasePool within = pool;
+            if (core.keep(within, cases[h], split_thresholds[cases[h]]) > 0)
+                pool = within;
+            return split_thresholds[cases[h]];
+        };
+
+        selected.at(i) = core.select(cases, filter, 
+                n_cases_used[i], thresholds[i]);
     }
 
     if (selected.size() != pop.individuals.size())
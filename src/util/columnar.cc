@@ -0,0 +1,1032 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#include "columnar.h"
+#include "utils.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <omp.h>
+#include <map>
+#include <unordered_map>
+
+namespace FT{
+
+namespace Util{
+
+static const char MAGIC[8] = {'F','E','A','T','C','O','L','1'};
+
+/// columns and the data start on multiples of this many bytes
+static const size_t ALIGN = 64;
+
+/// samples copied per task when gathering columns into a matrix
+static const size_t BLOCK = 1024;
+
+static inline size_t align(size_t x) { return (x + ALIGN - 1)/ALIGN*ALIGN; }
+
+/// bytes of the header, padded, for these names
+static size_t header_size(const vector<string>& names)
+{
+    size_t s = sizeof(MAGIC) + 2*sizeof(uint64_t) + 2 + names.size();
+    for (const auto& name : names)
+        s += sizeof(uint32_t) + name.size();
+    return align(s);
+}
+
+/// writes the header to out, which holds header_size(names) bytes
+static void write_header(char* out, size_t n, const vector<string>& names,
+                         const vector<char>& dtypes, bool has_y,
+                         bool binary_endpoint)
+{
+    std::memset(out, 0, header_size(names));
+    auto put = [&](const void* v, size_t bytes){
+        std::memcpy(out, v, bytes);
+        out += bytes;
+    };
+    uint64_t n_samples = n, n_features = names.size();
+    uint8_t flags[2] = {has_y, binary_endpoint};
+    put(MAGIC, sizeof(MAGIC));
+    put(&n_samples, sizeof(n_samples));
+    put(&n_features, sizeof(n_features));
+    put(flags, 2);
+    put(dtypes.data(), dtypes.size());
+    for (const auto& name : names)
+    {
+        uint32_t len = name.size();
+        put(&len, sizeof(len));
+        put(name.data(), len);
+    }
+}
+
+/// a file mapped into memory, unmapped when it goes out of scope
+struct Mapping
+{
+    int fd;
+    char* data;
+    size_t size;
+
+    /// maps path for reading, or creates it with size bytes for writing
+    Mapping(const std::string& path, size_t size=0, bool write=false)
+        : fd(-1), data(nullptr), size(size)
+    {
+        fd = write ? open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                   : open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            THROW_INVALID_ARGUMENT("Invalid file " + path + "\n");
+
+        struct stat st;
+        if (write)
+        {
+            if (ftruncate(fd, size) != 0)
+                fail("could not resize " + path);
+        }
+        else if (fstat(fd, &st) == 0)
+            this->size = st.st_size;
+        else
+            fail("could not read " + path);
+
+        if (this->size == 0)
+            fail(path + " is empty");
+
+        void* p = mmap(nullptr, this->size,
+                       write ? PROT_READ | PROT_WRITE : PROT_READ,
+                       MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+            fail("could not map " + path + " into memory");
+        data = static_cast<char*>(p);
+    }
+
+    ~Mapping()
+    {
+        if (data)
+            munmap(data, size);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    void fail(const string& msg)
+    {
+        close(fd);
+        fd = -1;
+        THROW_RUNTIME_ERROR(msg);
+    }
+};
+
+bool is_columnar(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return in.read(magic, sizeof(magic)) 
+           && !std::memcmp(magic, MAGIC, sizeof(MAGIC));
+}
+
+ColumnarFile::ColumnarFile(const std::string& path) : map(nullptr), size(0)
+{
+    Mapping m(path);
+
+    // header fields, checking that they lie in the file
+    size_t at = 0;
+    auto get = [&](void* v, size_t bytes){
+        if (at + bytes > m.size)
+            THROW_LENGTH_ERROR(path + " is truncated");
+        std::memcpy(v, m.data + at, bytes);
+        at += bytes;
+    };
+
+    char magic[sizeof(MAGIC)];
+    get(magic, sizeof(magic));
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC)))
+        THROW_INVALID_ARGUMENT(path + " is not a FEAT columnar file");
+
+    uint64_t n_samples, n_features;
+    uint8_t flags[2];
+    get(&n_samples, sizeof(n_samples));
+    get(&n_features, sizeof(n_features));
+    get(flags, 2);
+    n = n_samples;
+    has_y = flags[0];
+    binary_endpoint = flags[1];
+
+    dtypes.resize(n_features);
+    get(dtypes.data(), n_features);
+    names.resize(n_features);
+    for (auto& name : names)
+    {
+        uint32_t len;
+        get(&len, sizeof(len));
+        name.resize(len);
+        get(&name[0], len);
+    }
+
+    data = header_size(names);
+    stride = align(n*sizeof(float));
+    if (data + (n_features + has_y)*stride > m.size)
+        THROW_LENGTH_ERROR(path + " is truncated");
+
+    // keep the mapping; the descriptor isn't needed anymore
+    map = m.data;
+    size = m.size;
+    m.data = nullptr;
+}
+
+ColumnarFile::~ColumnarFile()
+{
+    if (map)
+        munmap(const_cast<char*>(map), size);
+}
+
+const float* ColumnarFile::feature(size_t i) const
+{
+    if (i >= n_features())
+        THROW_LENGTH_ERROR("no feature " + to_string(i));
+    return reinterpret_cast<const float*>(map + data + i*stride);
+}
+
+const float* ColumnarFile::target() const
+{
+    if (!has_y)
+        THROW_INVALID_ARGUMENT("the file has no target");
+    return reinterpret_cast<const float*>(map + data
+                                          + n_features()*stride);
+}
+
+size_t ColumnarFile::read(MatrixXf& X, size_t start, size_t count) const
+{
+    start = std::min(start, n);
+    count = std::min(count, n - start);
+    const size_t F = n_features();
+    X.resize(F, count);
+
+    // blocks of samples, so the strided writes into X stay in cache
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < count; b += BLOCK)
+    {
+        size_t e = std::min(b + BLOCK, count);
+        for (size_t j = 0; j < F; ++j)
+        {
+            const float* x = reinterpret_cast<const float*>(
+                    map + data + j*stride) + start;
+            for (size_t i = b; i < e; ++i)
+                X(j, i) = x[i];
+        }
+    }
+    return count;
+}
+
+size_t ColumnarFile::read(RowMatrixXf& X, size_t start, size_t count) const
+{
+    start = std::min(start, n);
+    count = std::min(count, n - start);
+    const size_t F = n_features();
+    X.resize(F, count);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < F; ++j)
+        std::memcpy(X.row(j).data(), map + data + j*stride 
+                                     + start*sizeof(float),
+                    count*sizeof(float));
+    return count;
+}
+
+MatrixXf ColumnarFile::X(size_t start, size_t count) const
+{
+    MatrixXf X;
+    read(X, start, count);
+    return X;
+}
+
+VectorXf ColumnarFile::y(size_t start, size_t count) const
+{
+    start = std::min(start, n);
+    count = std::min(count, n - start);
+    return Map<const VectorXf>(target() + start, count);
+}
+
+void save_columnar(const std::string& path, const MatrixXf& X,
+                   const VectorXf& y, const vector<string>& names,
+                   const vector<char>& dtypes)
+{
+    const size_t F = X.rows(), n = X.cols();
+    const bool has_y = y.size() > 0;
+    if (names.size() != F || dtypes.size() != F)
+        THROW_LENGTH_ERROR("save_columnar: X has " + to_string(F)
+                + " features but there are " + to_string(names.size())
+                + " names and " + to_string(dtypes.size()) + " dtypes");
+    if (has_y && y.size() != n)
+        THROW_LENGTH_ERROR("save_columnar: different numbers of samples in "
+                "X and y");
+
+    const size_t stride = align(n*sizeof(float));
+    const size_t hsize = header_size(names);
+    Mapping out(path, hsize + (F + has_y)*stride, true);
+
+    bool binary_endpoint = has_y && (y.array() == 0 || y.array() == 1).all();
+    write_header(out.data, n, names, dtypes, has_y, binary_endpoint);
+
+    #pragma omp parallel for
+    for (size_t j = 0; j < F; ++j)
+    {
+        float* col = reinterpret_cast<float*>(out.data + hsize + j*stride);
+        for (size_t i = 0; i < n; ++i)
+            col[i] = X(j, i);
+    }
+    if (has_y)
+        std::memcpy(out.data + hsize + F*stride, y.data(), n*sizeof(float));
+}
+
+void load_columnar(const std::string& path, MatrixXf& X, VectorXf& y,
+                   vector<string>& names, vector<char>& dtypes,
+                   bool& binary_endpoint)
+{
+    ColumnarFile f(path);
+    X = f.X();
+    y = f.has_target() ? f.y() : VectorXf();
+    names = f.get_names();
+    dtypes = f.get_dtypes();
+    binary_endpoint = f.get_binary_endpoint();
+}
+
+/// true if [p, e) is only whitespace
+static bool blank(const char* p, const char* e)
+{
+    for (; p < e; ++p)
+        if (!std::isspace(static_cast<unsigned char>(*p)))
+            return false;
+    return true;
+}
+
+/// calls f(begin, end) on each line of [p, e) that isn't blank
+template<class F>
+static void for_each_line(const char* p, const char* e, F f)
+{
+    while (p < e)
+    {
+        const char* eol = std::find(p, e, '\n');
+        if (!blank(p, eol))
+            f(p, eol);
+        p = eol + 1;
+    }
+}
+
+/// splits [body, end) into blocks of whole lines, a few per thread to 
+/// balance the load. returns the start of each block, then end.
+static vector<const char*> line_blocks(const char* body, const char* end)
+{
+    const size_t n_blocks = std::max<size_t>(1, std::min<size_t>(
+                4*omp_get_max_threads(), (end - body)/(1 << 16)));
+    vector<const char*> starts(n_blocks + 1, end);
+    starts[0] = body;
+    for (size_t b = 1; b < n_blocks; ++b)
+    {
+        const char* p = std::max(starts[b-1], body + (end - body)*b/n_blocks);
+        if (p > body && p[-1] != '\n')
+            p = std::min(std::find(p, end, '\n') + 1, end);
+        starts[b] = p;
+    }
+    return starts;
+}
+
+/// parses [p, e) when it is [-+]digits[.digits][(e|E)[-+]digits] with at
+/// most 2^53 as mantissa and 10^22 as scale, where one multiplication or
+/// division rounds exactly as strtod does. returns false otherwise.
+static bool parse_plain(const char* p, const char* e, double& v)
+{
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    auto digit = [](char c){ return c >= '0' && c <= '9'; };
+
+    bool neg = false;
+    if (p < e && (*p == '-' || *p == '+'))
+        neg = *p++ == '-';
+    uint64_t m = 0;
+    int digits = 0, scale = 0;
+    bool any = false;
+    for (bool frac = false; p < e; ++p)
+    {
+        if (*p == '.' && !frac)
+        {
+            frac = true;
+            continue;
+        }
+        if (!digit(*p))
+            break;
+        if (digits == 18)
+            return false;
+        m = 10*m + (*p - '0');
+        digits += m != 0;
+        scale -= frac;
+        any = true;
+    }
+    if (!any)
+        return false;
+    if (p < e && (*p == 'e' || *p == 'E'))
+    {
+        bool eneg = false;
+        if (++p < e && (*p == '-' || *p == '+'))
+            eneg = *p++ == '-';
+        int x = 0;
+        if (p == e)
+            return false;
+        for (; p < e && digit(*p) && x < 1000; ++p)
+            x = 10*x + (*p - '0');
+        scale += eneg ? -x : x;
+    }
+    if (p != e || m > (uint64_t(1) << 53) || scale < -22 || scale > 22)
+        return false;
+
+    v = scale < 0 ? m / pow10[-scale] : m * pow10[scale];
+    if (neg)
+        v = -v;
+    return true;
+}
+
+/// parses the number in [p, e), allowing whitespace around it
+static bool parse_double(const char* p, const char* e, double& v)
+{
+    const char* b = p;
+    const char* d = e;
+    while (b < d && std::isspace(static_cast<unsigned char>(*b)))
+        ++b;
+    while (d > b && std::isspace(static_cast<unsigned char>(d[-1])))
+        --d;
+    if (parse_plain(b, d, v))
+        return true;
+
+    char buf[64];
+    string s;
+    const char* c;
+    if (e - p < int(sizeof(buf)))
+    {
+        std::memcpy(buf, p, e - p);
+        buf[e - p] = 0;
+        c = buf;
+    }
+    else
+    {
+        s.assign(p, e);
+        c = s.c_str();
+    }
+    char* end;
+    v = std::strtod(c, &end);
+    if (end == c)
+        return false;
+    return blank(end, end + std::strlen(end));
+}
+
+static bool parse_float(const char* p, const char* e, float& v)
+{
+    double d;
+    if (!parse_double(p, e, d))
+        return false;
+    v = d;
+    return true;
+}
+
+/// what find_dtypes() tracks for one feature over part of the samples
+struct TypeStats
+{
+    bool binary = true;
+    bool integer = true;
+    vector<float> unique;       ///< integer values, up to 10
+
+    void add(float v)
+    {
+        if (v != 0 && v != 1)
+            binary = false;
+        if (v != std::floor(v) && v != std::ceil(v))
+            integer = false;
+        else if (unique.size() < 10
+                && std::find(unique.begin(), unique.end(), v) == unique.end())
+            unique.push_back(v);
+    }
+
+    void merge(const TypeStats& o)
+    {
+        binary = binary && o.binary;
+        integer = integer && o.integer;
+        for (float v : o.unique)
+            if (unique.size() < 10
+                && std::find(unique.begin(), unique.end(), v) == unique.end())
+                unique.push_back(v);
+    }
+
+    char dtype() const
+    {
+        if (binary)
+            return 'b';
+        return integer && unique.size() < 10 ? 'c' : 'f';
+    }
+};
+
+void csv_to_columnar(const std::string& csv_path, const std::string& path,
+                     char sep)
+{
+    Mapping in(csv_path);
+    const char* begin = in.data;
+    const char* end = begin + in.size;
+    madvise(in.data, in.size, MADV_SEQUENTIAL);
+
+    // header, as in load_csv()
+    const char* body = std::find(begin, end, '\n');
+    vector<string> names;
+    int target_col = -1;
+    {
+        std::stringstream header(string(begin, body));
+        std::string cell;
+        for (int col = 0; std::getline(header, cell, sep); ++col)
+        {
+            cell = trim(cell);
+            if (!cell.compare("class") || !cell.compare("target")
+                    || !cell.compare("label"))
+                target_col = col;
+            else
+                names.push_back(cell);
+        }
+    }
+    body = std::min(body + 1, end);
+    const size_t F = names.size();
+    const size_t n_cols = F + (target_col >= 0);
+
+    vector<const char*> starts = line_blocks(body, end);
+    const size_t n_blocks = starts.size() - 1;
+
+    // rows in each block, then where each block's rows start
+    vector<size_t> first(n_blocks + 1, 0);
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < n_blocks; ++b)
+    {
+        size_t rows = 0;
+        for_each_line(starts[b], starts[b+1], [&](const char*, const char*){
+                ++rows; });
+        first[b+1] = rows;
+    }
+    for (size_t b = 0; b < n_blocks; ++b)
+        first[b+1] += first[b];
+    const size_t n = first[n_blocks];
+
+    // the output, with room for every column
+    const size_t stride = align(n*sizeof(float));
+    const size_t hsize = header_size(names);
+    Mapping out(path, hsize + n_cols*stride, true);
+    auto column = [&](size_t j){
+        return reinterpret_cast<float*>(out.data + hsize + j*stride); };
+    float* y = column(F);
+
+    vector<vector<TypeStats>> stats(n_blocks, vector<TypeStats>(F));
+    string error;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < n_blocks; ++b)
+    {
+        size_t r = first[b];
+        vector<TypeStats>& st = stats[b];
+        bool ok = true;
+
+        for_each_line(starts[b], starts[b+1], [&](const char* p,
+                    const char* e){
+            if (!ok)
+                return;
+            size_t col = 0, j = 0;
+            while (ok)
+            {
+                const char* c = std::find(p, e, sep);
+                float v;
+                if (!parse_float(p, c, v))
+                {
+                    ok = false;
+                    #pragma omp critical
+                    if (error.empty())
+                        error = "could not parse '" + trim(string(p, c))
+                                + "' on row " + to_string(r + 1) + " of "
+                                + csv_path;
+                }
+                else if (int(col) == target_col)
+                    y[r] = v;
+                else if (j < F)
+                {
+                    column(j)[r] = v;
+                    st[j].add(v);
+                    ++j;
+                }
+                if (c == e)
+                    break;
+                p = c + 1;
+                ++col;
+            }
+            if (ok && col + 1 != n_cols)
+            {
+                ok = false;
+                #pragma omp critical
+                if (error.empty())
+                    error = "row " + to_string(r + 1) + " of " + csv_path
+                            + " has " + to_string(col + 1) + " columns, not "
+                            + to_string(n_cols);
+            }
+            ++r;
+        });
+    }
+    if (!error.empty())
+    {
+        unlink(path.c_str());
+        THROW_RUNTIME_ERROR(error);
+    }
+
+    vector<char> dtypes(F);
+    for (size_t j = 0; j < F; ++j)
+    {
+        TypeStats s;
+        for (size_t b = 0; b < n_blocks; ++b)
+            s.merge(stats[b][j]);
+        dtypes[j] = s.dtype();
+    }
+
+    bool binary_endpoint = target_col >= 0;
+    for (size_t i = 0; i < n && binary_endpoint; ++i)
+        binary_endpoint = y[i] == 0 || y[i] == 1;
+
+    write_header(out.data, n, names, dtypes, target_col >= 0,
+                 binary_endpoint);
+}
+
+/////////////////////////////////////////////////////////// longitudinal data
+
+static const char LONG_MAGIC[8] = {'F','E','A','T','L','N','G','1'};
+
+/// the rows of one block of a longitudinal csv file
+struct LongBlock
+{
+    vector<string> names;                       ///< variables, as found
+    std::unordered_map<string, uint32_t> name_at;
+    vector<uint32_t> var;                       ///< index into names
+    vector<long long> id;
+    vector<float> value;
+    vector<float> time;
+    std::unordered_set<long long> ids;
+};
+
+LongRecords read_longitudinal(const std::string& path, char sep,
+        const std::unordered_set<long long>* keep)
+{
+    Mapping in(path);
+    const char* begin = in.data;
+    const char* end = begin + in.size;
+    madvise(in.data, in.size, MADV_SEQUENTIAL);
+
+    // header, naming the columns id, date, value and name in any order
+    const char* body = std::find(begin, end, '\n');
+    const char* fields[4] = {"id", "date", "value", "name"};
+    enum { ID, DATE, VALUE, NAME };
+    int col_of[4] = {-1, -1, -1, -1};
+    size_t n_cols = 0;
+    {
+        std::stringstream header(string(begin, body));
+        std::string cell;
+        for (; std::getline(header, cell, sep); ++n_cols)
+            for (int f = 0; f < 4; ++f)
+                if (!trim(cell).compare(fields[f]))
+                    col_of[f] = n_cols;
+        for (int f = 0; f < 4; ++f)
+            if (col_of[f] < 0)
+                THROW_INVALID_ARGUMENT(path + " has no " + fields[f] 
+                        + " column");
+    }
+    body = std::min(body + 1, end);
+
+    vector<const char*> starts = line_blocks(body, end);
+    const size_t n_blocks = starts.size() - 1;
+    vector<LongBlock> blocks(n_blocks);
+    string error;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < n_blocks; ++b)
+    {
+        LongBlock& B = blocks[b];
+        vector<const char*> cells(n_cols + 1);
+        bool ok = true;
+        int last = -1;
+
+        for_each_line(starts[b], starts[b+1], [&](const char* p,
+                    const char* e){
+            if (!ok)
+                return;
+            auto fail = [&](const string& msg){
+                ok = false;
+                #pragma omp critical
+                if (error.empty())
+                    error = msg + " in line '" + trim(string(p, e)) 
+                            + "' of " + path;
+            };
+            // cell j is [cells[j], cells[j+1] - 1)
+            size_t j = 0;
+            for (const char* c = p; j < n_cols; ++j)
+            {
+                cells[j] = c;
+                c = std::find(c, e, sep) + 1;
+                if (c > e && j + 1 < n_cols)
+                    return fail("too few columns");
+                cells[j+1] = std::min(c, e + 1);
+            }
+            auto cell = [&](int f, double& v){
+                const char* c = cells[col_of[f]];
+                const char* ce = cells[col_of[f] + 1] - 1;
+                if (!parse_double(c, ce, v))
+                {
+                    fail("could not parse '" + trim(string(c, ce)) + "'");
+                    return false;
+                }
+                return true;
+            };
+
+            double id, value, time;
+            if (!cell(ID, id))
+                return;
+            if (id != std::floor(id))
+                return fail("id " + to_string(id) + " is not an integer");
+            if (keep && !keep->count((long long)id))
+                return;
+            if (!cell(VALUE, value) || !cell(DATE, time))
+                return;
+
+            const char* c = cells[col_of[NAME]];
+            const char* ce = cells[col_of[NAME] + 1] - 1;
+            while (c < ce && std::isspace(static_cast<unsigned char>(*c)))
+                ++c;
+            while (ce > c && std::isspace(static_cast<unsigned char>(ce[-1])))
+                --ce;
+            // rows of one variable tend to come together
+            if (last < 0 || B.names[last].compare(0, string::npos, c, ce - c))
+            {
+                string name(c, ce);
+                auto it = B.name_at.find(name);
+                if (it == B.name_at.end())
+                {
+                    it = B.name_at.emplace(name, B.names.size()).first;
+                    B.names.push_back(name);
+                }
+                last = it->second;
+            }
+            B.var.push_back(last);
+            B.id.push_back((long long)id);
+            B.value.push_back(value);
+            B.time.push_back(time);
+            B.ids.insert(id);
+        });
+    }
+    if (!error.empty())
+        THROW_RUNTIME_ERROR(error);
+
+    // variables in order of name, as in LongData, and samples in order of
+    // id, with hash tables from each block's names and all ids to them
+    std::map<string, uint32_t> var_at;
+    for (const auto& B : blocks)
+        for (const auto& name : B.names)
+            var_at.emplace(name, 0);
+    vector<string> names;
+    for (auto& v : var_at)
+    {
+        v.second = names.size();
+        names.push_back(v.first);
+    }
+    vector<vector<uint32_t>> remap(n_blocks);
+    for (size_t b = 0; b < n_blocks; ++b)
+        for (const auto& name : blocks[b].names)
+            remap[b].push_back(var_at.at(name));
+
+    LongRecords r;
+    for (auto& B : blocks)
+    {
+        r.ids.insert(r.ids.end(), B.ids.begin(), B.ids.end());
+        std::unordered_set<long long>().swap(B.ids);
+    }
+    std::sort(r.ids.begin(), r.ids.end());
+    r.ids.erase(std::unique(r.ids.begin(), r.ids.end()), r.ids.end());
+    std::unordered_map<long long, uint32_t> sample_at(2*r.ids.size());
+    for (size_t i = 0; i < r.ids.size(); ++i)
+        sample_at[r.ids[i]] = i;
+
+    const size_t V = names.size(), n = r.ids.size();
+
+    // each block's rows of each variable, and where they go
+    vector<vector<size_t>> first(n_blocks, vector<size_t>(V, 0));
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < n_blocks; ++b)
+        for (uint32_t v : blocks[b].var)
+            ++first[b][remap[b][v]];
+    vector<size_t> total(V, 0);
+    for (size_t b = 0; b < n_blocks; ++b)
+        for (size_t v = 0; v < V; ++v)
+        {
+            size_t rows = first[b][v];
+            first[b][v] = total[v];
+            total[v] += rows;
+        }
+
+    // rows scattered by variable, in the order of the file
+    vector<vector<uint32_t>> sample(V);
+    vector<vector<float>> value(V), time(V);
+    for (size_t v = 0; v < V; ++v)
+    {
+        sample[v].resize(total[v]);
+        value[v].resize(total[v]);
+        time[v].resize(total[v]);
+    }
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < n_blocks; ++b)
+    {
+        LongBlock& B = blocks[b];
+        for (size_t i = 0; i < B.var.size(); ++i)
+        {
+            uint32_t v = remap[b][B.var[i]];
+            size_t k = first[b][v]++;
+            sample[v][k] = sample_at.find(B.id[i])->second;
+            value[v][k] = B.value[i];
+            time[v][k] = B.time[i];
+        }
+        B = LongBlock();
+    }
+
+    // a stable counting sort of each variable by sample
+    vector<Dat::LongVar> vars(V);
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t v = 0; v < V; ++v)
+    {
+        Dat::LongVar& z = vars[v];
+        z.offsets.assign(n + 1, 0);
+        for (uint32_t i : sample[v])
+            ++z.offsets[i + 1];
+        for (size_t i = 0; i < n; ++i)
+            z.offsets[i + 1] += z.offsets[i];
+
+        z.values.resize(total[v]);
+        z.times.resize(total[v]);
+        vector<size_t> next(z.offsets.begin(), z.offsets.end() - 1);
+        for (size_t k = 0; k < total[v]; ++k)
+        {
+            size_t at = next[sample[v][k]]++;
+            z.values(at) = value[v][k];
+            z.times(at) = time[v][k];
+        }
+        vector<uint32_t>().swap(sample[v]);
+        vector<float>().swap(value[v]);
+        vector<float>().swap(time[v]);
+    }
+    for (size_t v = 0; v < V; ++v)
+        r.vars.emplace(names[v], std::move(vars[v]));
+
+    return r;
+}
+
+/// throws unless every variable has a value for each sample
+static void check_samples(const Dat::LongVars& vars, 
+                          const vector<long long>& ids)
+{
+    for (const auto& z : vars)
+        for (size_t i = 0; i < z.second.size(); ++i)
+            if (z.second.count(i) == 0)
+                THROW_RUNTIME_ERROR(to_string(i) + " not found (patient id = "
+                        + to_string(ids.at(i)) + ") in " + z.first);
+}
+
+Dat::LongVars LongRecords::by_index() const
+{
+    for (size_t i = 0; i < ids.size(); ++i)
+        if (ids[i] != (long long)i)
+            THROW_RUNTIME_ERROR("longitudinal ids should be 0 ... " 
+                    + to_string(ids.size() - 1) + ", but " + to_string(i)
+                    + " is " + to_string(ids[i]));
+    check_samples(vars, ids);
+    return vars;
+}
+
+Dat::LongVars LongRecords::select(const vector<int>& idx) const
+{
+    vector<size_t> at(idx.size());
+    vector<long long> selected(idx.begin(), idx.end());
+    for (size_t k = 0; k < idx.size(); ++k)
+    {
+        auto it = std::lower_bound(ids.begin(), ids.end(), idx[k]);
+        if (it == ids.end() || *it != idx[k])
+            THROW_RUNTIME_ERROR(to_string(k) + " not found (patient id = " 
+                    + to_string(idx[k]) + ") in the longitudinal data");
+        at[k] = it - ids.begin();
+    }
+    Dat::LongVars selection;
+    for (const auto& z : vars)
+        selection.emplace(z.first, z.second.gather(at));
+    check_samples(selection, selected);
+    return selection;
+}
+
+bool is_longitudinal(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(LONG_MAGIC)];
+    return in.read(magic, sizeof(magic)) 
+           && !std::memcmp(magic, LONG_MAGIC, sizeof(LONG_MAGIC));
+}
+
+void save_longitudinal(const std::string& path, const LongRecords& r)
+{
+    const uint64_t n = r.ids.size(), V = r.vars.size();
+    vector<const Dat::LongVar*> vars;
+    size_t hsize = sizeof(LONG_MAGIC) + 2*sizeof(uint64_t);
+    for (const auto& z : r.vars)
+    {
+        if (z.second.size() != n)
+            THROW_LENGTH_ERROR("save_longitudinal: " + z.first + " has " 
+                    + to_string(z.second.size()) + " samples, not " 
+                    + to_string(n));
+        vars.push_back(&z.second);
+        hsize += sizeof(uint32_t) + z.first.size() + sizeof(uint64_t);
+    }
+    hsize = align(hsize);
+
+    // where the ids and each variable's arrays start
+    vector<size_t> at(V + 1);
+    at[0] = hsize + align(n*sizeof(int64_t));
+    for (size_t v = 0; v < V; ++v)
+        at[v+1] = at[v] + align((n + 1)*sizeof(uint64_t)) 
+                  + 2*align(vars[v]->values.size()*sizeof(float));
+    Mapping out(path, at[V], true);
+
+    char* p = out.data;
+    std::memset(p, 0, hsize);
+    auto put = [&](const void* x, size_t bytes){
+        std::memcpy(p, x, bytes);
+        p += bytes;
+    };
+    put(LONG_MAGIC, sizeof(LONG_MAGIC));
+    put(&n, sizeof(n));
+    put(&V, sizeof(V));
+    for (const auto& z : r.vars)
+    {
+        uint32_t len = z.first.size();
+        uint64_t n_values = z.second.values.size();
+        put(&len, sizeof(len));
+        put(z.first.data(), len);
+        put(&n_values, sizeof(n_values));
+    }
+
+    int64_t* ids = reinterpret_cast<int64_t*>(out.data + hsize);
+    std::copy(r.ids.begin(), r.ids.end(), ids);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t v = 0; v < V; ++v)
+    {
+        const Dat::LongVar& z = *vars[v];
+        size_t m = z.values.size();
+        char* q = out.data + at[v];
+        std::copy(z.offsets.begin(), z.offsets.end(), 
+                  reinterpret_cast<uint64_t*>(q));
+        q += align((n + 1)*sizeof(uint64_t));
+        std::memcpy(q, z.values.data(), m*sizeof(float));
+        q += align(m*sizeof(float));
+        std::memcpy(q, z.times.data(), m*sizeof(float));
+    }
+}
+
+/// reads a file written by save_longitudinal(). the arrays are copied out
+/// of the mapping, which is closed on return, since a LongVar owns its 
+/// values and times.
+static LongRecords load_longitudinal_file(const std::string& path)
+{
+    Mapping m(path);
+
+    size_t at = 0;
+    auto get = [&](void* v, size_t bytes){
+        if (at + bytes > m.size)
+            THROW_LENGTH_ERROR(path + " is truncated");
+        std::memcpy(v, m.data + at, bytes);
+        at += bytes;
+    };
+
+    char magic[sizeof(LONG_MAGIC)];
+    get(magic, sizeof(magic));
+    if (std::memcmp(magic, LONG_MAGIC, sizeof(LONG_MAGIC)))
+        THROW_INVALID_ARGUMENT(path + " is not a FEAT longitudinal file");
+
+    uint64_t n, V;
+    get(&n, sizeof(n));
+    get(&V, sizeof(V));
+    vector<string> names(V);
+    vector<uint64_t> n_values(V);
+    for (size_t v = 0; v < V; ++v)
+    {
+        uint32_t len;
+        get(&len, sizeof(len));
+        names[v].resize(len);
+        get(&names[v][0], len);
+        get(&n_values[v], sizeof(uint64_t));
+    }
+    size_t hsize = align(at);
+
+    vector<size_t> start(V + 1);
+    start[0] = hsize + align(n*sizeof(int64_t));
+    for (size_t v = 0; v < V; ++v)
+        start[v+1] = start[v] + align((n + 1)*sizeof(uint64_t))
+                     + 2*align(n_values[v]*sizeof(float));
+    if (start[V] > m.size)
+        THROW_LENGTH_ERROR(path + " is truncated");
+
+    LongRecords r;
+    const int64_t* ids = reinterpret_cast<const int64_t*>(m.data + hsize);
+    r.ids.assign(ids, ids + n);
+
+    vector<Dat::LongVar*> vars;
+    for (const auto& name : names)
+        vars.push_back(&r.vars[name]);
+
+    string error;
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t v = 0; v < V; ++v)
+    {
+        Dat::LongVar& z = *vars[v];
+        const char* q = m.data + start[v];
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(q);
+        z.offsets.assign(offsets, offsets + n + 1);
+        q += align((n + 1)*sizeof(uint64_t));
+        z.values = Map<const ArrayXf>(reinterpret_cast<const float*>(q), 
+                                      n_values[v]);
+        q += align(n_values[v]*sizeof(float));
+        z.times = Map<const ArrayXf>(reinterpret_cast<const float*>(q),
+                                     n_values[v]);
+
+        bool ok = z.offsets.front() == 0 && z.offsets.back() == n_values[v];
+        for (size_t i = 0; i < n && ok; ++i)
+            ok = z.offsets[i] <= z.offsets[i+1];
+        if (!ok)
+        {
+            #pragma omp critical
+            error = path + " has invalid offsets for " + names[v];
+        }
+    }
+    if (!error.empty())
+        THROW_RUNTIME_ERROR(error);
+    return r;
+}
+
+LongRecords load_longitudinal_records(const std::string& path, char sep)
+{
+    if (is_longitudinal(path))
+        return load_longitudinal_file(path);
+    return read_longitudinal(path, sep);
+}
+
+void csv_to_longitudinal(const std::string& csv_path, const std::string& path,
+                         char sep)
+{
+    save_longitudinal(path, read_longitudinal(csv_path, sep));
+}
+
+}
+}
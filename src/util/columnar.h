@@ -0,0 +1,176 @@
+/* FEAT
+copyright 2017 William La Cava
+license: GNU/GPL v3
+*/
+
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <Eigen/Dense>
+#include <vector>
+#include <string>
+#include "../init.h"
+#include "../util/error.h"
+#include "../dat/data.h"
+#include <unordered_set>
+
+using namespace Eigen;
+
+namespace FT{
+
+    namespace Util{
+
+        /*!
+         * @class ColumnarFile
+         * @brief a dataset stored column by column in a binary file, mapped
+         * into memory.
+         *
+         * The file starts with a header:
+         *
+         *      char     magic[8]           "FEATCOL1"
+         *      uint64   n_samples
+         *      uint64   n_features
+         *      uint8    has_y
+         *      uint8    binary_endpoint
+         *      char     dtypes[n_features]
+         *      names    n_features times a uint32 length and the characters
+         *
+         * padded with zeros to 64 bytes. Each feature follows as n_samples
+         * native floats, then y if has_y. Every column is padded to 64 bytes
+         * so that it starts aligned. Columns are read in place: only the
+         * pages that are touched are loaded.
+         */
+        class ColumnarFile
+        {
+            public:
+                explicit ColumnarFile(const std::string& path);
+                ~ColumnarFile();
+
+                ColumnarFile(const ColumnarFile&) = delete;
+                ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+                size_t n_samples() const { return n; }
+                size_t n_features() const { return names.size(); }
+                const vector<string>& get_names() const { return names; }
+                const vector<char>& get_dtypes() const { return dtypes; }
+                bool has_target() const { return has_y; }
+                bool get_binary_endpoint() const { return binary_endpoint; }
+
+                /// values of feature i, one per sample
+                const float* feature(size_t i) const;
+                /// target values, one per sample
+                const float* target() const;
+
+                /// samples [start, start+count) as a features x samples
+                /// matrix, copied out of the columns in parallel. count is
+                /// clipped to the end of the file.
+                MatrixXf X(size_t start=0, size_t count=size_t(-1)) const;
+                VectorXf y(size_t start=0, size_t count=size_t(-1)) const;
+
+                /// reads up to count samples from start into the columns of
+                /// X, as in X(). returns the number of samples read.
+                size_t read(MatrixXf& X, size_t start, size_t count) const;
+
+                /// reads up to count samples from start into the rows of 
+                /// X, one column of the file per row, so that X is laid out
+                /// as the features Data holds (see Data::set_features()).
+                /// returns the number of samples read.
+                size_t read(RowMatrixXf& X, size_t start, 
+                            size_t count=size_t(-1)) const;
+
+            private:
+                const char* map;        ///< the mapped file
+                size_t size;            ///< bytes mapped
+                size_t n;               ///< samples
+                size_t data;            ///< offset of the first column
+                size_t stride;          ///< bytes between columns
+                bool has_y;
+                bool binary_endpoint;
+                vector<string> names;
+                vector<char> dtypes;
+        };
+
+        /// true if path starts like a ColumnarFile
+        bool is_columnar(const std::string& path);
+
+        /// writes X (features x samples), y and their names and dtypes in
+        /// the format of ColumnarFile. y may be empty.
+        void save_columnar(const std::string& path, const MatrixXf& X,
+                           const VectorXf& y, const vector<string>& names,
+                           const vector<char>& dtypes);
+
+        /// loads a file written by save_columnar() or csv_to_columnar(),
+        /// with the outputs of load_csv()
+        void load_columnar(const std::string& path, MatrixXf& X, VectorXf& y,
+                           vector<string>& names, vector<char>& dtypes,
+                           bool& binary_endpoint);
+
+        /*!
+         * converts a csv file laid out as for load_csv() to the format of
+         * ColumnarFile. the csv is mapped into memory and split into blocks
+         * at line breaks; the blocks' rows are counted and then parsed in
+         * parallel, straight into the columns of the output file. dtypes
+         * are found while parsing, as in find_dtypes(). blank lines are
+         * skipped.
+         */
+        void csv_to_columnar(const std::string& csv_path,
+                             const std::string& path, char sep=',');
+
+        /*!
+         * @class LongRecords
+         * @brief the contents of a longitudinal file: its variables, with
+         * one sample per distinct id in ascending order of id. samples
+         * without rows of a variable are empty.
+         */
+        struct LongRecords
+        {
+            vector<long long> ids;      ///< sorted ids of the samples
+            Dat::LongVars vars;
+
+            /// the variables when ids are 0 ... n-1, as for
+            /// load_longitudinal(). throws if a variable lacks a sample.
+            Dat::LongVars by_index() const;
+
+            /// sample k holds the rows of id idx[k], as for
+            /// load_partial_longitudinal(). throws if a variable lacks one.
+            Dat::LongVars select(const vector<int>& idx) const;
+        };
+
+        /*!
+         * reads a longitudinal csv file with the columns id, date, value and
+         * name, in any order. like csv_to_columnar(), the file is mapped
+         * into memory and parsed in parallel blocks of lines. each block's
+         * rows are then scattered into flat variables, which are sorted by
+         * sample with a stable counting sort, so the values of a sample
+         * keep the order of the file. ids are looked up in hash tables.
+         * if keep is given, rows of other ids are skipped.
+         */
+        LongRecords read_longitudinal(const std::string& path, char sep=',',
+                const std::unordered_set<long long>* keep=nullptr);
+
+        /// true if path starts like a file written by save_longitudinal()
+        bool is_longitudinal(const std::string& path);
+
+        /*!
+         * writes r to a binary file that load_longitudinal_records() maps
+         * into memory instead of parsing. after a header holding the
+         * magic "FEATLNG1", the numbers of samples and variables, and each
+         * variable's name and number of values, come the ids and then each
+         * variable's offsets, values and times, every array 64-byte aligned.
+         */
+        void save_longitudinal(const std::string& path, const LongRecords& r);
+
+        /// reads a file written by save_longitudinal(), copying its 
+        /// arrays out of the mapping, or parses a csv file with 
+        /// read_longitudinal()
+        LongRecords load_longitudinal_records(const std::string& path,
+                                              char sep=',');
+
+        /// converts a longitudinal csv file to the format of
+        /// save_longitudinal()
+        void csv_to_longitudinal(const std::string& csv_path,
+                                 const std::string& path, char sep=',');
+    }
+}
+
+#endif
@@ -28,7 +28,10 @@ namespace FT{
         void load_csv (const std::string & path, MatrixXf& X, VectorXf& y, vector<string>& names, 
                        vector<char> &dtypes, bool& binary_endpoint, char sep=',');
         
-        ///  load longitudinal csv file into matrix. 
+        ///  load longitudinal csv file into matrix. the file may also be
+        ///  one written by save_longitudinal(). the variables are read flat
+        ///  and split into per-sample arrays here; use 
+        ///  load_longitudinal_records() to keep them flat.
         void load_longitudinal(const std::string & path,
                                std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf> > > &Z,
                                char sep=',');
@@ -37,6 +40,32 @@ namespace FT{
         void load_partial_longitudinal(const std::string & path,
                                std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf> > > &Z,
                                char sep, const vector<int>& idx);
+
+        /*!
+         * @class CSVReader
+         * @brief reads a csv file laid out as for load_csv() a few rows at a
+         * time, so that files larger than memory can be streamed. the
+         * target column, if there is one, is skipped.
+         */
+        class CSVReader
+        {
+            public:
+                CSVReader(const std::string& path, char sep=',');
+
+                /// reads up to n rows into the columns of X, resizing it to
+                /// features x rows read. returns the number of rows read.
+                size_t read(MatrixXf& X, size_t n);
+
+                /// feature names from the header
+                const vector<string>& get_names() const { return names; }
+
+            private:
+                std::ifstream in;
+                char sep;
+                int target_col;         ///< column of the target, or -1
+                vector<string> names;
+                size_t line;            ///< lines read, for errors
+        };
     }
 }
 
@@ -44,6 +44,14 @@ namespace FT {
         };
         
         static Logger &logger = *Logger::initLogger();
+
+/// logs message m at verbosity v (and optional separator) through logger. 
+/// the level is checked first, so m is only built if it will be logged.
+#define LOG( m, v, ... ) \
+    do { \
+        if (FT::Util::logger.get_log_level() >= (v)) \
+            FT::Util::logger.log( m, v, ##__VA_ARGS__ ); \
+    } while (0)
     }
 }
 #endif
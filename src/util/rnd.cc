@@ -4,6 +4,8 @@ license: GNU/GPL v3
 */
 
 #include "rnd.h"
+#include <algorithm>
+#include <cmath>
 
 namespace FT {
 
@@ -179,6 +181,39 @@ namespace FT {
                 return gset;	//and return it.
             }
         }
+
+        vector<size_t> Rnd::weighted_order(const vector<float>& w)
+        {
+            /*!
+             * sorts the indices on exponential keys -log(u)/w, which draws
+             * them as successive weighted choices would (Efraimidis and 
+             * Spirakis, 2006). indices with zero weight go last, in a 
+             * random order.
+             */
+            std::mt19937& g = rg.at(omp_get_thread_num());
+            std::uniform_real_distribution<double> dist(0.0, 1.0);
+            const double inf = std::numeric_limits<double>::infinity();
+
+            vector<pair<double,size_t>> keys(w.size());
+            for (size_t i = 0; i < w.size(); ++i)
+            {
+                double u = 1.0 - dist(g);   // in (0, 1]
+                keys[i].first = w[i] > 0 ? -std::log(u)/w[i] : inf;
+                keys[i].second = i;
+            }
+            std::sort(keys.begin(), keys.end());
+
+            vector<size_t> order(w.size());
+            for (size_t i = 0; i < keys.size(); ++i)
+                order[i] = keys[i].second;
+
+            auto zeros = std::find_if(keys.begin(), keys.end(), 
+                    [&](const pair<double,size_t>& k){ return k.first == inf; });
+            shuffle(order.begin() + (zeros - keys.begin()), order.end(), g);
+
+            return order;
+        }
+
         Rnd::~Rnd() {}
     }
 
@@ -53,10 +53,19 @@ namespace FT {
 			    void shuffle (RandomAccessIterator first, 
                         RandomAccessIterator last)
 			    {
+                    shuffle(first, last, rg[omp_get_thread_num()]);
+	            }    
+
+                /// shuffles with generator g, e.g. a stream owned by a task 
+                /// whose results shouldn't depend on the thread it runs on
+			    template <class RandomAccessIterator>
+			    void shuffle (RandomAccessIterator first, 
+                        RandomAccessIterator last, std::mt19937& g)
+			    {
 	                for (auto i=(last-first)-1; i>0; --i) 
                     {
 	                    std::uniform_int_distribution<decltype(i)> d(0,i);
-		                swap (first[i], first[d(rg[omp_get_thread_num()])]);
+		                swap (first[i], first[d(g)]);
 	                }
 	            }    
                 
@@ -118,6 +127,10 @@ namespace FT {
                 
                 float gasdev();
 
+                /// indices of w in a random order, drawn without replacement
+                /// with probability proportional to their weight. O(N log N).
+                vector<size_t> weighted_order(const vector<float>& w);
+
             private:
 
                 Rnd();
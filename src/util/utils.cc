@@ -286,7 +286,9 @@ void Log_Stats::update(int index,
                        unsigned max_tests,
                        float mn_threshold,
                        float md_threshold,
-                       float mx_threshold)
+                       float mx_threshold,
+                       size_t n_cache_hits,
+                       size_t n_cache_misses)
 {
     generation.push_back(index+1);
     time.push_back(timer_count);
@@ -304,6 +306,8 @@ void Log_Stats::update(int index,
     min_threshold.push_back(mn_threshold);
     med_threshold.push_back(md_threshold);
     max_threshold.push_back(mx_threshold);
+    cache_hits.push_back(n_cache_hits);
+    cache_misses.push_back(n_cache_misses);
 }
 
 std::string ravel(const vector<string>& v, string sep)
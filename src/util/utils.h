@@ -396,6 +396,8 @@ struct Log_Stats
     vector<float> min_threshold;
     vector<float> med_threshold;
     vector<float> max_threshold;
+    vector<size_t> cache_hits;
+    vector<size_t> cache_misses;
     
     void update(int index,
                 float timer_count,
@@ -412,7 +414,9 @@ struct Log_Stats
                 unsigned max_tests,
                 float mn_threshold,
                 float md_threshold,
-                float mx_threshold
+                float mx_threshold,
+                size_t n_cache_hits,
+                size_t n_cache_misses
                 );
 };
 
@@ -434,7 +438,9 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Log_Stats,
     min_threshold,
     med_threshold,
     max_threshold,
-    med_dim);
+    med_dim,
+    cache_hits,
+    cache_misses);
 
 ///template function to convert objects to string for logging
 template <typename T>
@@ -70,14 +70,14 @@ void Variation::vary(Population& pop, const vector<size_t>& parents,
                 // create child
                
                 // perform crossover
-                logger.log("\n===\ncrossing\n" + mom.get_eqn() + "\nwith\n " + 
+                LOG("\n===\ncrossing\n" + mom.get_eqn() + "\nwith\n " + 
                            dad.get_eqn() , 3);
-                logger.log("programs:\n" + mom.program_str() + "\nwith\n " + 
+                LOG("programs:\n" + mom.program_str() + "\nwith\n " + 
                            dad.program_str() , 3);
                 
                 pass = cross(mom, dad, child, params, d);
                 
-                logger.log("crossing " + mom.get_eqn() + "\nwith\n " + 
+                LOG("crossing " + mom.get_eqn() + "\nwith\n " + 
                    dad.get_eqn() + "\nproduced " + child.get_eqn() + 
                    ", pass: " + std::to_string(pass) + "\n===\n",3);    
                 
@@ -91,10 +91,10 @@ void Variation::vary(Population& pop, const vector<size_t>& parents,
                 // create child
                 /* #pragma omp critical */
                 /* { */
-               logger.log("mutating " + mom.get_eqn() + "(" + 
+               LOG("mutating " + mom.get_eqn() + "(" + 
                         mom.program_str() + ")", 3);
                pass = mutate(mom,child,params,d);
-               logger.log("mutating " + mom.get_eqn() + " produced " + 
+               LOG("mutating " + mom.get_eqn() + " produced " + 
                         child.get_eqn() + ", pass: " + std::to_string(pass),3);
                 /* } */ 
                 child.set_parents({mom});
@@ -102,7 +102,7 @@ void Variation::vary(Population& pop, const vector<size_t>& parents,
             if (pass)
             {
                 assert(child.size()>0);
-                logger.log("assigning " + child.program_str() + 
+                LOG("assigning " + child.program_str() + 
                         " to pop.individuals[" + std::to_string(i) + "]",3);
 
                 pop.individuals.at(i) = child;
@@ -131,20 +131,20 @@ bool Variation::mutate(const Individual& mom, Individual& child,
     {
         if (r() < 0.5)
         {
-            logger.log("\tdeletion mutation",3);
+            LOG("\tdeletion mutation",3);
             delete_mutate(child,params); 
         }
         else 
         {
             if (params.corr_delete_mutate)
             {
-                logger.log("\tcorrelation_delete_mutate",3);
+                LOG("\tcorrelation_delete_mutate",3);
                 bool perfect_correlation = correlation_delete_mutate(
                         child,mom.Phi,params,d); 
             }
             else
             {
-                logger.log("\tdelete_dimension_mutate",3);
+                LOG("\tdelete_dimension_mutate",3);
                 delete_dimension_mutate(child, params);
             }
         }
@@ -153,14 +153,14 @@ bool Variation::mutate(const Individual& mom, Individual& child,
     }
     else if (rf < 2.0/3.0 && child.size() < params.max_size)
     {
-        logger.log("\tinsert mutation",3);
+        LOG("\tinsert mutation",3);
         insert_mutate(child,params);
         assert(child.program.is_valid_program(params.num_features, 
                     params.longitudinalMap));
     }
     else
     {        
-        logger.log("\tpoint mutation",3);
+        LOG("\tpoint mutation",3);
         point_mutate(child,params);
         assert(child.program.is_valid_program(params.num_features, 
                     params.longitudinalMap));
@@ -187,7 +187,7 @@ void Variation::point_mutate(Individual& child, const Parameters& params)
         /* cout << child.get_p(i) << "\n"; */
         if (r() < child.get_p(i))  // mutate p. 
         {
-            logger.log("\t\tmutating node " + p->name, 3);
+            LOG("\t\tmutating node " + p->name, 3);
             NodeVector replacements;  // potential replacements for p
 
             if (p->total_arity() > 0) // then it is an instruction
@@ -226,7 +226,8 @@ void Variation::point_mutate(Individual& child, const Parameters& params)
         }
         ++i; 
     }
-
+    // replacements keep their arity, but not their complexity
+    child.program.update_structure();
 }
 
 void Variation::insert_mutate(Individual& child, 
@@ -248,7 +249,7 @@ void Variation::insert_mutate(Individual& child,
             // mutate with weighted probability
             if (r() < child.get_p(i))                      
             {
-                logger.log("\t\tinsert mutating node " + 
+                LOG("\t\tinsert mutating node " + 
                         child.program.at(i)->name + " with probability " +
                         std::to_string(child.get_p(i)), 3);
                 NodeVector insertion;  // inserted segment
@@ -290,7 +291,7 @@ void Variation::insert_mutate(Individual& child,
                 // grab chosen node's subtree
                 int end = i;
                 int start = child.program.subtree(end); 
-                logger.log("\t\tinsert mutation from " + to_string(end)
+                LOG("\t\tinsert mutation from " + to_string(end)
                         + " to " + to_string(start), 3);
 
 
@@ -332,7 +333,7 @@ void Variation::insert_mutate(Individual& child,
                
                 string s; 
                 for (const auto& ins : insertion) s += ins->name + " "; 
-                logger.log("\t\tinsertion: " + s + "\n", 3);
+                LOG("\t\tinsertion: " + s + "\n", 3);
                 NodeVector new_program; 
                 splice_programs(new_program, 
                                 child.program, start, end, 
@@ -353,6 +354,7 @@ void Variation::insert_mutate(Individual& child,
                      params.ttypes);
         for (const auto& ip : insertion) 
             child.program.push_back(ip->clone());
+        child.program.update_structure();
     }
 }
 
@@ -364,7 +366,7 @@ void Variation::delete_mutate(Individual& child,
      * @param params: parameters  
      * @return mutated child
      * */
-    logger.log("\t\tprogram: " + child.program_str(),4);
+    LOG("\t\tprogram: " + child.program_str(),4);
     // loop thru child's program
     for (unsigned i = 0; i< child.program.size(); ++i)
     {
@@ -379,7 +381,7 @@ void Variation::delete_mutate(Individual& child,
             {
                 portion += child.program.at(j)->name + " ";
             }
-            logger.log("\t\tdelete mutating [ " + 
+            LOG("\t\tdelete mutating [ " + 
                     portion + " ] from program " +
                     child.program_str(), 4);
 
@@ -398,7 +400,7 @@ void Variation::delete_mutate(Individual& child,
 
             if (terms.size()==0)  // if no insertion terminals match, skip
             {
-                logger.log("\t\tnevermind, couldn't find a matching terminal",
+                LOG("\t\tnevermind, couldn't find a matching terminal",
                         4);
                 continue;
             }
@@ -407,7 +409,7 @@ void Variation::delete_mutate(Individual& child,
             std::unique_ptr<Node> insertion = random_node(terms);
             
             string s; 
-            logger.log("\t\tinsertion: " + insertion->name + "\n", 4);
+            LOG("\t\tinsertion: " + insertion->name + "\n", 4);
 
             // delete portion of program
             if (logger.get_log_level() >=4)
@@ -417,7 +419,7 @@ void Variation::delete_mutate(Individual& child,
                 {
                     s+= child.program.at(i)->name + " ";
                 }
-                logger.log("\t\tdeleting " + std::to_string(start) + " to " + 
+                LOG("\t\tdeleting " + std::to_string(start) + " to " + 
                         std::to_string(end) + ": " + s, 4);
             }    
             child.program.erase(child.program.begin()+start,
@@ -426,7 +428,8 @@ void Variation::delete_mutate(Individual& child,
             // insert the terminal that was chosen 
             child.program.insert(child.program.begin()+start, 
                     insertion->clone());
-            logger.log("\t\tresult of delete mutation: " + 
+            child.program.update_structure();
+            LOG("\t\tresult of delete mutation: " + 
                     child.program_str(), 4);
             continue;
         }
@@ -442,7 +445,7 @@ void Variation::delete_dimension_mutate(Individual& child,
      * @param params: parameters  
      * @return mutated child
      * */
-    logger.log("\t\tprogram: " + child.program_str(),3);
+    LOG("\t\tprogram: " + child.program_str(),3);
     vector<size_t> roots = child.program.roots();
     
     size_t end = r.random_choice(roots,child.p); 
@@ -454,12 +457,13 @@ void Variation::delete_dimension_mutate(Individual& child,
         {
             s+= child.program.at(i)->name + " ";
         }
-        logger.log("\t\tdeleting " + std::to_string(start) + " to " + 
+        LOG("\t\tdeleting " + std::to_string(start) + " to " + 
                 std::to_string(end) + ": " + s, 3);
     }    
     child.program.erase(child.program.begin()+start,
             child.program.begin()+end+1);
-    logger.log("\t\tresult of delete mutation: " + child.program_str(), 3);
+    child.program.update_structure();
+    LOG("\t\tresult of delete mutation: " + child.program_str(), 3);
 }
 
 bool Variation::correlation_delete_mutate(Individual& child, 
@@ -475,7 +479,7 @@ bool Variation::correlation_delete_mutate(Individual& child,
      * @param d: data
      * @return mutated child
      * */
-    logger.log("\t\tprogram: " + child.program_str(),3); 
+    LOG("\t\tprogram: " + child.program_str(),3); 
     // mean center features
     for (int i = 0; i < Phi.rows(); ++i)
     {
@@ -503,7 +507,7 @@ bool Variation::correlation_delete_mutate(Individual& child,
            }
         }
     }
-    logger.log("chosen pair: " + to_string(f1) +  ", " + to_string(f2)
+    LOG("chosen pair: " + to_string(f1) +  ", " + to_string(f2)
             + "; corr = " + to_string(highest_corr), 3);
     if (f1 == 0 && f2 == 0)
     {
@@ -514,10 +518,10 @@ bool Variation::correlation_delete_mutate(Individual& child,
                                         Phi.row(f1).array()); 
     float corr_f2 = pearson_correlation(d.y.array()-d.y.mean(),
                                         Phi.row(f2).array()); 
-    logger.log( "corr (" + to_string(f1) + ", y): " + to_string(corr_f1), 3);
-    logger.log( "corr (" + to_string(f2) + ", y): " + to_string(corr_f2), 3);
+    LOG( "corr (" + to_string(f1) + ", y): " + to_string(corr_f1), 3);
+    LOG( "corr (" + to_string(f2) + ", y): " + to_string(corr_f2), 3);
     int choice = corr_f1 <= corr_f2 ? f1 : f2; 
-    logger.log( "chose (" + to_string(choice), 3);
+    LOG( "chose (" + to_string(choice), 3);
     // pick the subtree starting at roots(choice) and delete it
     vector<size_t> roots = child.program.roots();
     size_t end = roots.at(choice); 
@@ -527,16 +531,17 @@ bool Variation::correlation_delete_mutate(Individual& child,
         std::string s="";
         for (unsigned i = start; i<=end; ++i) 
             s+= child.program.at(i)->name + " ";
-        logger.log("\t\tdeleting " + std::to_string(start) + " to " + 
+        LOG("\t\tdeleting " + std::to_string(start) + " to " + 
                 std::to_string(end) + ": " + s, 3);
     }    
     child.program.erase(child.program.begin()+start,
             child.program.begin()+end+1);
+    child.program.update_structure();
 
-    logger.log("\t\tresult of corr delete mutation: " 
+    LOG("\t\tresult of corr delete mutation: " 
                + child.program_str(), 3);
 
-    if (!child.program.is_valid_program(d.X.rows(), 
+    if (!child.program.is_valid_program(d.n_features(), 
                 params.longitudinalMap))
     {
         cout << "Error in correlation_delete_mutate: child is not a valid "
@@ -570,7 +575,7 @@ bool Variation::cross(const Individual& mom, const Individual& dad,
     
     if (subtree) 
     {
-        logger.log("\tsubtree xo",3);
+        LOG("\tsubtree xo",3);
         // limit xo choices to matching output types in the programs. 
         vector<char> d_otypes;
         for (const auto& p : dad.program)
@@ -584,7 +589,7 @@ bool Variation::cross(const Individual& mom, const Individual& dad,
         // mom and dad have no overlapping types, can't cross
         if (mlocs.size()==0)                
         {
-            logger.log("WARNING: no overlapping types between " + 
+            LOG("WARNING: no overlapping types between " + 
                     mom.program_str() + "," + dad.program_str() + "\n", 3);
             return 0;               
         }
@@ -606,10 +611,10 @@ bool Variation::cross(const Individual& mom, const Individual& dad,
             return stagewise_cross(mom, dad, child, params, d);
         else
         {
-            logger.log("\troot xo",3);
+            LOG("\troot xo",3);
             mlocs = mom.program.roots();
             dlocs = dad.program.roots();
-            logger.log("\t\trandom choice mlocs (size "+
+            LOG("\t\trandom choice mlocs (size "+
                        std::to_string(mlocs.size())+"), p size: "+
                        std::to_string(mom.p.size()),3);
             // weighted probability choice    
@@ -657,7 +662,7 @@ bool Variation::residual_cross(const Individual& mom, const Individual& dad,
      * @return  child: mom with dad subtree graft
      */
                
-    logger.log("\tresidual xo",3);
+    LOG("\tresidual xo",3);
     vector<size_t> mlocs, dlocs; // mom and dad locations for consideration
     // i1-j1: mom portion, i2-j2: dad portion
     size_t i1, j1, j1_idx, i2, j2;       
@@ -667,7 +672,7 @@ bool Variation::residual_cross(const Individual& mom, const Individual& dad,
     std::iota(mlocs_indices.begin(),mlocs_indices.end(),0);
 
     dlocs = dad.program.roots();
-    logger.log("\t\trandom choice mlocs (size "+
+    LOG("\t\trandom choice mlocs (size "+
                std::to_string(mlocs.size())+"), p size: "+
                std::to_string(mom.p.size()),3);
     // weighted probability choice
@@ -764,7 +769,7 @@ bool Variation::stagewise_cross(const Individual& mom, const Individual& dad,
      *     - update $\mathbf{r} = r - b\phi^*$ 
      * $\phi_c$ = all $\phi^*$ that were chosen 
      */
-    logger.log("\tstagewise xo",3);
+    LOG("\tstagewise xo",3);
     // normalize the residual 
     VectorXf R = d.y.array() - d.y.mean();
     /* cout << "R: " << R.norm() << "\n"; */
@@ -900,6 +905,7 @@ bool Variation::stagewise_cross(const Individual& mom, const Individual& dad,
         }
         
     }
+    child.program.update_structure();
             
     /* cout << "child program size: " << child.program.size() << "\n"; */
     /* if (logger.get_log_level() >= 3) */
@@ -939,7 +945,7 @@ void Variation::splice_programs( NodeVector& vnew,
      *
      * @return  vnew: new vector 
      */
-    logger.log("splice_programs",3);
+    LOG("splice_programs",3);
     if (i1 >= v1.size())
         cout << "i1 ( " << i1 << ") >= v1 size (" << v1.size() << ")\n";
     if (i2 >= v2.size())
@@ -965,6 +971,7 @@ void Variation::splice_programs( NodeVector& vnew,
     {
         std::cerr << "bad_alloc caught: " << ba.what() << "\n";
     }
+    vnew.update_structure();
 }
 
 void Variation::print_cross(const Individual& mom, size_t i1, size_t j1, 
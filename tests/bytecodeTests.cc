@@ -0,0 +1,270 @@
+#include "testsHeader.h"
+#include "../src/pop/bytecode.h"
+
+/// evaluates program with the stack interpreter
+MatrixXf interpret(Individual& ind, const Data& d)
+{
+    State state;
+    for (const auto& n : ind.program)
+        n->evaluate(d, state);
+    return ind.state_to_phi(state);
+}
+
+TEST(Bytecode, MatchesInterpreter)
+{
+    int N = 1000;
+    MatrixXf X(4, N);
+    X.setRandom();
+    X.row(2) = (X.row(2).array() > 0).cast<float>();
+    X.row(3) = (X.row(3).array()*1.5 + 1.5).floor();
+    VectorXf y(N);
+    y.setRandom();
+    LongData z;
+    Data d(X, y, z);
+
+    bool b_true = true;
+    // programs in postfix order, mixing float, boolean and categorical
+    // outputs. the last one repeats a subtree, which should be
+    // evaluated once.
+    vector<vector<Node*>> programs = {
+        {new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeDivide(), new NodeSin(), new NodeVariable<float>(0),
+         new NodeExponential(), new NodeMultiply(), new NodeLog()},
+        {new NodeVariable<float>(1), new NodeVariable<float>(0),
+         new NodeGreaterThan(), new NodeVariable<bool>(2, 'b'), new NodeXor(),
+         new NodeVariable<float>(0), new NodeTanh(),
+         new NodeVariable<float>(1), new NodeRelu(), new NodeIfThenElse(),
+         new NodeVariable<int>(3, 'c'), new NodeFloat<int>()},
+        {new NodeVariable<float>(0), new NodeSplit<float>(),
+         new NodeVariable<int>(3, 'c'), new NodeSplit<int>(), new NodeAnd(),
+         new NodeVariable<float>(1), new NodeSqrt(), new NodeSign(),
+         new NodeVariable<int>(3, 'c')},
+        {new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeLEQ(), new NodeNot(), new NodeConstant(b_true), new NodeOr(),
+         new NodeVariable<float>(1), new NodeVariable<bool>(2, 'b'),
+         new NodeIf(), new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeGEQ(), new NodeFloat<bool>()},
+        {new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeSubtract(), new NodeSquare(), new NodeVariable<float>(1),
+         new NodeCube(), new NodeVariable<float>(0), new NodeGaussian(),
+         new NodeVariable<float>(1), new NodeGaussian(), new NodeExponent(),
+         new NodeVariable<float>(0), new NodeLogit(),
+         new NodeVariable<float>(1), new NodeStep()},
+        {new NodeVariable<float>(2), new NodeVariable<float>(3),
+         new NodeEqual(), new NodeVariable<float>(0),
+         new NodeVariable<float>(1), new NodeLessThan(), 
+         new NodeFloat<bool>()},
+        {new NodeVariable<float>(0), new NodeCos(), new NodeVariable<float>(1),
+         new NodeAdd(), new NodeVariable<float>(0), new NodeCos(),
+         new NodeVariable<float>(1), new NodeAdd()}
+    };
+    // identical subtrees need identical weights
+    dynamic_cast<NodeDx*>(programs.back().at(5))->W =
+        dynamic_cast<NodeDx*>(programs.back().at(1))->W;
+    dynamic_cast<NodeDx*>(programs.back().at(7))->W =
+        dynamic_cast<NodeDx*>(programs.back().at(3))->W;
+
+    for (const auto& p : programs)
+    {
+        Individual ind;
+        for (auto n : p)
+            ind.program.push_back(std::unique_ptr<Node>(n));
+        for (const auto& n : ind.program)
+            if (n->isNodeTrain())
+                dynamic_cast<NodeTrain*>(n.get())->train = false;
+
+        MatrixXf expected = interpret(ind, d);
+
+        Bytecode bc(ind.program);
+        ASSERT_TRUE(bc.compiled);
+        ASSERT_EQ(bc.otypes, ind.dtypes);
+
+        for (int tile : {0, 64, 100, N})
+        {
+            MatrixXf Phi = bc.run(d, tile);
+            ASSERT_EQ(Phi.rows(), expected.rows());
+            ASSERT_EQ(Phi.cols(), expected.cols());
+            ASSERT_TRUE(((Phi - expected).array().abs()
+                        <= 1e-5*(1 + expected.array().abs())).all());
+        }
+        if (&p == &programs.back())
+            ASSERT_EQ(bc.code.size(), 4);
+    }
+}
+
+TEST(Bytecode, FallsBack)
+{
+    Individual a;
+    a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(0)));
+    a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+    a.program.push_back(std::unique_ptr<Node>(new Node2dGaussian()));
+
+    ASSERT_FALSE(Bytecode(a.program).compiled);
+
+    Individual b;
+    b.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(0)));
+    b.program.push_back(std::unique_ptr<Node>(new NodeSplit<float>()));
+
+    // splits being trained need all samples at once
+    ASSERT_FALSE(Bytecode(b.program, true).compiled);
+    ASSERT_TRUE(Bytecode(b.program, false).compiled);
+}
+
+TEST(Bytecode, LoadsCachedSubtrees)
+{
+    int N = 500;
+    MatrixXf X(2, N);
+    X.setRandom();
+    VectorXf y(N);
+    y.setRandom();
+    LongData z;
+    Data d(X, y, z);
+
+    Individual ind;
+    ind.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(0)));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeSin()));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeMultiply()));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(0)));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeGreaterThan()));
+
+    SubtreeCache cache(1 << 20);
+    cache.set_data(d);
+    ASSERT_EQ(d.cache, &cache);
+
+    Bytecode first(ind.program, false, d.cache);
+    MatrixXf expected = first.run(d);
+    // only the roots, * and >, are stored
+    ASSERT_EQ(first.stypes.size(), 2);
+    ASSERT_EQ(cache.size_bytes(), 2*N*sizeof(float));
+    ASSERT_EQ(cache.hits(), 0);
+
+    // both roots are loaded on the second pass
+    Bytecode second(ind.program, false, d.cache);
+    ASSERT_EQ(second.code.size(), 2);
+    ASSERT_EQ(second.loads.size(), 2);
+    ASSERT_EQ(second.stypes.size(), 0);
+    ASSERT_EQ(cache.hits(), 2);
+    ASSERT_TRUE(second.run(d, 64) == expected);
+
+    // individuals built on a root reuse its output
+    Individual other;
+    for (int i = 0; i < 4; ++i)
+        other.program.push_back(ind.program.at(i)->clone());
+    other.program.push_back(std::unique_ptr<Node>(new NodeTanh()));
+    Bytecode shared(other.program, false, d.cache);
+    ASSERT_EQ(shared.loads.size(), 1);
+    ASSERT_TRUE(((shared.run(d) - interpret(other, d)).array().abs()
+                <= 1e-5).all());
+
+    // subtrees of the same shape on other features are not hits
+    Individual swapped;
+    for (int i = 0; i < 4; ++i)
+        swapped.program.push_back(ind.program.at(i)->clone());
+    dynamic_cast<NodeVariable<float>*>(swapped.program.at(0).get())->loc = 1;
+    dynamic_cast<NodeVariable<float>*>(swapped.program.at(2).get())->loc = 0;
+    Bytecode distinct(swapped.program, false, d.cache);
+    ASSERT_EQ(distinct.loads.size(), 0);
+    ASSERT_TRUE(((distinct.run(d) - interpret(swapped, d)).array().abs()
+                <= 1e-5).all());
+
+    // other data has no cache, and the bytecode refuses to run on it
+    MatrixXf X2 = X;
+    Data d2(X2, y, z);
+    ASSERT_TRUE(d2.cache == nullptr);
+    ASSERT_THROW(second.run(d2), std::runtime_error);
+
+    // views of the data don't share its outputs
+    MatrixXf Xv;
+    VectorXf yv;
+    LongData zv;
+    Data dv(Xv, yv, zv);
+    d.view_cases(dv, {0, 1, 2});
+    ASSERT_TRUE(dv.cache == nullptr);
+
+    // data the cache was bound to before keeps pointing at it, but 
+    // neither reads outputs on other data
+    MatrixXf Xb = X.leftCols(100);
+    VectorXf yb = y.head(100);
+    Data db(Xb, yb, z);
+    cache.set_data(db);
+    ASSERT_EQ(d.cache, &cache);
+    ASSERT_FALSE(cache.bound_to(d));
+    ASSERT_THROW(second.run(d), std::runtime_error);
+    Bytecode(ind.program, false, db.cache).run(db);
+    ASSERT_TRUE(((ind.out(d) - expected).array().abs() <= 1e-5).all());
+    cache.set_data(d);
+
+    cache.clear();
+    ASSERT_TRUE(d.cache == nullptr);
+    ASSERT_EQ(cache.size_bytes(), 0);
+}
+
+TEST(Bytecode, CacheEvictsLeastRecentlyUsed)
+{
+    MatrixXf X(1, 10);
+    VectorXf y(10);
+    LongData z;
+    Data d(X, y, z);
+
+    SubtreeCache cache(2*10*sizeof(float));
+    cache.set_data(d);
+
+    for (int key : {1, 2})
+        cache.put(std::to_string(key), 
+                  std::make_shared<ArrayXf>(ArrayXf::Constant(10, key)));
+    // touch 1 so that 2 is evicted
+    ASSERT_TRUE(cache.get("1") != nullptr);
+    cache.put("3", std::make_shared<ArrayXf>(ArrayXf::Constant(10, 3)));
+
+    ASSERT_EQ(cache.size_bytes(), 2*10*sizeof(float));
+    ASSERT_TRUE(cache.get("2") == nullptr);
+    ASSERT_EQ((*cache.get("1"))(0), 1);
+    ASSERT_EQ((*cache.get("3"))(0), 3);
+
+    // outputs of another length are not stored
+    cache.put("4", std::make_shared<ArrayXf>(ArrayXf::Zero(5)));
+    ASSERT_TRUE(cache.get("4") == nullptr);
+
+    // copies start empty
+    SubtreeCache copy(cache);
+    ASSERT_EQ(copy.size_bytes(), 0);
+    ASSERT_EQ(copy.get_budget(), cache.get_budget());
+
+    cache.clear();
+}
+
+TEST(Bytecode, FeatureMajorFollowsShuffle)
+{
+    MatrixXf X(3, 100);
+    X.setRandom();
+    VectorXf y(100);
+    y.setRandom();
+    LongData z;
+    DataRef d(X, y, z);
+    std::mt19937 gen(3);
+    d.train_test_split(true, 0.75, &gen);
+
+    vector<size_t> t_idx, v_idx;
+    std::mt19937 gen2(3);
+    d.o->split_cases(t_idx, v_idx, 0.75, true, &gen2);
+    ASSERT_EQ(d.t->n_features(), 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT_TRUE((d.o->feature(i) == X.row(i).transpose().array()).all());
+        for (int j = 0; j < t_idx.size(); ++j)
+            ASSERT_EQ(d.t->feature(i)(j), X(i, t_idx[j]));
+        for (int j = 0; j < v_idx.size(); ++j)
+            ASSERT_EQ(d.v->feature(i)(j), X(i, v_idx[j]));
+    }
+
+    // float variables are read in place, not copied into registers
+    Individual ind;
+    ind.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(2)));
+    ind.program.push_back(std::unique_ptr<Node>(new NodeAdd()));
+    Bytecode bc(ind.program, false);
+    ASSERT_TRUE(((bc.run(*d.t, 16) - interpret(ind, *d.t)).array().abs()
+                <= 1e-5).all());
+}
@@ -0,0 +1,94 @@
+#include "testsHeader.h"
+#include "../src/pop/compact.h"
+#include <set>
+
+/// a program using every kind of gene: weighted nodes, variables of each
+/// type, constants and splits
+NodeVector compact_test_program()
+{
+    bool b_true = true;
+    vector<Node*> nodes = {
+        new NodeVariable<float>(0, 'f', "age"), new NodeVariable<float>(2),
+        new NodeAdd({0.5, -2.0}), new NodeSin({3.0}),
+        new NodeVariable<float>(0, 'f', "age"), new NodeSplit<float>(),
+        new NodeVariable<int>(3, 'c'), new NodeFuzzyFixedSplit<int>(),
+        new NodeAnd(), new NodeConstant(b_true), new NodeOr(),
+        new NodeConstant(1.5), new NodeVariable<bool>(1, 'b'),
+        new NodeIf(), new NodeMultiply({1.0, 0.25})};
+    dynamic_cast<NodeSplit<float>*>(nodes.at(5))->threshold = 0.75;
+    dynamic_cast<NodeFuzzyFixedSplit<int>*>(nodes.at(7))->threshold = 2;
+    dynamic_cast<NodeFuzzyFixedSplit<int>*>(nodes.at(7))->threshold_set = true;
+
+    NodeVector program;
+    for (auto n : nodes)
+        program.push_back(std::unique_ptr<Node>(n));
+    program.update_structure();
+    return program;
+}
+
+TEST(CompactProgram, RoundTrip)
+{
+    NodeVector program = compact_test_program();
+    CompactProgram cp(program);
+
+    ASSERT_EQ(cp.size(), program.size());
+    ASSERT_TRUE(cp.is_valid());
+    ASSERT_EQ(cp.complexity(), program.complexity());
+    for (size_t i = 0; i < cp.size(); ++i)
+    {
+        ASSERT_EQ(cp.info(i).otype, program.at(i)->otype);
+        ASSERT_EQ(cp.info(i).total_arity, program.at(i)->total_arity());
+    }
+
+    // decoding and serializing give back the same json as the nodes
+    json j, jc, jd;
+    to_json(j, program);
+    to_json(jc, cp);
+    to_json(jd, cp.decode());
+    ASSERT_EQ(jc, j);
+    ASSERT_EQ(jd, j);
+
+    CompactProgram loaded;
+    from_json(j, loaded);
+    ASSERT_TRUE(loaded == cp);
+    ASSERT_EQ(loaded.hash(), cp.hash());
+    ASSERT_EQ(loaded.variable_name(loaded.genes.at(0)), "age");
+}
+
+TEST(CompactProgram, HashFollowsWeights)
+{
+    NodeVector program = compact_test_program();
+    CompactProgram a(program);
+    CompactProgram b = a;
+
+    ASSERT_TRUE(a == b);
+    ASSERT_EQ(a.hash(), b.hash());
+    // copies share the variable names
+    ASSERT_EQ(a.names.get(), b.names.get());
+
+    b.pool.at(b.genes.at(2).w) += 1;
+    ASSERT_FALSE(a == b);
+    ASSERT_TRUE(a.hash() != b.hash());
+
+    // programs missing arguments are flagged
+    CompactProgram c = a;
+    c.genes.erase(c.genes.begin());
+    ASSERT_FALSE(c.is_valid());
+}
+
+TEST(CompactProgram, OpTableHoldsOpcodes)
+{
+    const OpTable& T = OpTable::get();
+    ASSERT_EQ(T.size(), NM.node_map.size());
+
+    // every opcode but loads runs some operator of the NodeMap
+    std::set<int> opcodes;
+    for (size_t i = 0; i < T.size(); ++i)
+        if (T.at(i).tiled)
+            opcodes.insert(T.at(i).opcode);
+    ASSERT_EQ(opcodes.size(), OP_LOAD_F);
+
+    ASSERT_EQ(T.find("variable", 'b')->opcode, OP_VAR_B);
+    ASSERT_FALSE(T.find("mean", 'f')->tiled);
+    ASSERT_EQ(T.find("z_age", 'z'), nullptr);
+}
@@ -0,0 +1,296 @@
+#include "testsHeader.h"
+
+/// longitudinal data whose values are the first feature of their samples
+LongData tagged_longitudinal(const MatrixXf& X)
+{
+    VectorXf y = X.row(0).transpose();
+    LongData Z;
+    for (int i = 0; i < y.size(); ++i)
+    {
+        int n = r.rnd_int(1, 5);
+        Z["a"].first.push_back(ArrayXf::Constant(n, y(i)));
+        Z["a"].second.push_back(ArrayXf::LinSpaced(n, 0, n-1));
+        Z["b"].first.push_back(ArrayXf::Constant(n+1, -y(i)));
+        Z["b"].second.push_back(ArrayXf::LinSpaced(n+1, 0, n));
+    }
+    return Z;
+}
+
+void check_longitudinal(const Data& d)
+{
+    ASSERT_EQ(d.get_longitudinal().size(), 2);
+    const LongVar& a = d.longitudinal("a");
+    const LongVar& b = d.longitudinal("b");
+    ASSERT_EQ(a.size(), d.n_samples());
+    ASSERT_EQ(b.size(), d.n_samples());
+    for (int i = 0; i < d.n_samples(); ++i)
+    {
+        ASSERT_TRUE((a.value(i) == d.feature(0)(i)).all());
+        ASSERT_TRUE((b.value(i) == -d.feature(0)(i)).all());
+        ASSERT_EQ(b.count(i), a.count(i) + 1);
+        ASSERT_EQ(a.time(i)(a.count(i)-1), float(a.count(i)-1));
+    }
+}
+
+TEST(Data, LongitudinalFlattening)
+{
+    MatrixXf X = VectorXf::LinSpaced(10, 0, 9).transpose();
+    LongData Z = tagged_longitudinal(X);
+
+    LongVar a(Z.at("a"));
+    ASSERT_EQ(a.size(), 10);
+    ASSERT_EQ(a.offsets.back(), a.values.size());
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(a.value(i).matrix() == Z.at("a").first.at(i).matrix());
+        ASSERT_TRUE(a.time(i).matrix() == Z.at("a").second.at(i).matrix());
+    }
+
+    auto z = a.unflatten();
+    ASSERT_EQ(z.first.size(), 10);
+    for (int i = 0; i < 10; ++i)
+        ASSERT_TRUE(z.first.at(i).matrix()
+                == Z.at("a").first.at(i).matrix());
+
+    LongVar g = a.gather({7, 2, 2});
+    ASSERT_EQ(g.size(), 3);
+    ASSERT_TRUE((g.value(0) == 7).all());
+    ASSERT_TRUE((g.value(2) == 2).all());
+
+    LongVar s = a.slice(3, 4);
+    ASSERT_EQ(s.size(), 4);
+    ASSERT_EQ(s.offsets.front(), 0);
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE((s.value(i) == 3 + i).all());
+
+    // values and times must pair up
+    Z["a"].second.pop_back();
+    ASSERT_THROW(LongVar(Z.at("a")), std::length_error);
+}
+
+TEST(Data, LongitudinalFollowsSplits)
+{
+    for (bool classification : {false, true})
+    {
+        int n = 200;
+        MatrixXf X = MatrixXf::Random(2, n);
+        VectorXf y(n);
+        for (int i = 0; i < n; ++i)
+            y(i) = classification ? i % 2 : i;
+        LongData Z = tagged_longitudinal(X);
+
+        DataRef d(X, y, Z, classification);
+        d.train_test_split(true, 0.75);
+        check_longitudinal(*d.o);
+        check_longitudinal(*d.t);
+        check_longitudinal(*d.v);
+        ASSERT_EQ(d.t->y.size() + d.v->y.size(), n);
+
+        MatrixXf Xb;
+        VectorXf yb;
+        LongData Zb;
+        Data db(Xb, yb, Zb, classification);
+        d.t->get_batch(db, 50);
+        check_longitudinal(db);
+    }
+}
+
+TEST(Data, LongitudinalViews)
+{
+    VectorXf y = VectorXf::LinSpaced(20, 0, 19);
+    MatrixXf X = y.transpose();
+    LongData Z = tagged_longitudinal(X);
+    Data d(X, y, Z);
+
+    // the stack holds a view of the data, not a copy
+    State state;
+    NodeLongitudinal za("a");
+    za.evaluate(d, state);
+    ASSERT_EQ(state.z.size(), 1);
+    ASSERT_EQ(state.z.top().value(3).data(), 
+              d.longitudinal("a").value(3).data());
+
+    NodeMean mean;
+    mean.evaluate(d, state);
+    ASSERT_EQ(state.z.size(), 0);
+    ASSERT_TRUE(state.f.top().matrix() == y);
+
+    za.evaluate(d, state);
+    NodeRecent recent;
+    recent.evaluate(d, state);
+    ASSERT_TRUE(state.f.top().matrix() == y);
+}
+
+TEST(Data, LongitudinalAggregates)
+{
+    LongData Z;
+    int n = 100;
+    for (int i = 0; i < n; ++i)
+    {
+        int m = r.rnd_int(1, 9);
+        ArrayXf v = ArrayXf::Random(m), t = ArrayXf::Random(m);
+        if (i % 10 == 0)
+            v(0) = NAN;
+        Z["a"].first.push_back(v);
+        Z["a"].second.push_back(t);
+    }
+    MatrixXf X = MatrixXf::Random(1, n);
+    VectorXf y = VectorXf::Random(n);
+    Data d(X, y, Z);
+
+    const LongStats& s = d.longitudinal("a").stats();
+    auto near = [](float a, float b){ 
+        return std::isnan(a) ? std::isnan(b) 
+                             : fabs(a - b) <= 1e-4*(1 + fabs(b)); };
+    for (int i = 0; i < n; ++i)
+    {
+        const ArrayXf& raw = Z.at("a").first.at(i);
+        ArrayXf v = Node::limited(raw);
+        ArrayXf t = Node::limited(Z.at("a").second.at(i));
+        ArrayXf::Index last;
+        Z.at("a").second.at(i).maxCoeff(&last);
+
+        ASSERT_EQ(s.count(i), v.size());
+        ASSERT_TRUE(near(s.mean(i), v.mean()));
+        ASSERT_TRUE(near(s.variance(i), variance(v)));
+        ASSERT_TRUE(near(s.skew(i), skew(v)));
+        ASSERT_TRUE(near(s.kurtosis(i), kurtosis(v)));
+        ASSERT_EQ(s.min(i), v.minCoeff());
+        ASSERT_EQ(s.max(i), v.maxCoeff());
+        vector<float> sorted(v.data(), v.data() + v.size());
+        std::sort(sorted.begin(), sorted.end());
+        int h = sorted.size()/2;
+        ASSERT_EQ(s.median(i), sorted.size() % 2 ? sorted[h] 
+                                : (sorted[h-1] + sorted[h])/2);
+        ASSERT_TRUE(near(s.slope(i), NodeSlope().slope(t, v)));
+        ASSERT_TRUE(near(s.recent(i), raw(last)));
+    }
+
+    // aggregates are computed once per dataset
+    ASSERT_EQ(&d.longitudinal("a").stats(), &s);
+    State state;
+    NodeLongitudinal za("a");
+    NodeMedian med;
+    za.evaluate(d, state);
+    med.evaluate(d, state);
+    ASSERT_TRUE(state.f.top().matrix() == s.median.matrix());
+
+    // and again for a batch
+    MatrixXf Xb;
+    VectorXf yb;
+    LongData Zb;
+    Data db(Xb, yb, Zb);
+    d.get_batch(db, 10);
+    const LongStats& sb = db.longitudinal("a").stats();
+    ASSERT_NE(&sb, &s);
+    ASSERT_EQ(sb.median.size(), 10);
+    ASSERT_TRUE(sb.median.matrix() == s.median.head(10).matrix());
+}
+
+TEST(Data, Views)
+{
+    int n = 100;
+    MatrixXf X = MatrixXf::Random(3, n);
+    VectorXf y = VectorXf::Random(n);
+    LongData Z = tagged_longitudinal(X);
+    Data d(X, y, Z);
+
+    // a view holds indices; its features are gathered when read
+    MatrixXf Xv;
+    VectorXf yv;
+    LongData Zv;
+    Data dv(Xv, yv, Zv);
+    vector<size_t> idx = {5, 99, 0, 5, 42};
+    d.view_cases(dv, idx);
+    ASSERT_TRUE(dv.is_view());
+    ASSERT_EQ(dv.n_samples(), idx.size());
+    ASSERT_EQ(dv.n_features(), 3);
+    ASSERT_EQ(dv.X.size(), 0);
+    for (int j = 0; j < 3; ++j)
+        for (int i = 0; i < idx.size(); ++i)
+            ASSERT_EQ(dv.feature(j)(i), X(j, idx[i]));
+    for (int i = 0; i < idx.size(); ++i)
+        ASSERT_EQ(dv.y(i), y(idx[i]));
+    check_longitudinal(dv);
+
+    // views of views index the original data
+    MatrixXf Xvv;
+    VectorXf yvv;
+    LongData Zvv;
+    Data dvv(Xvv, yvv, Zvv);
+    dv.view_cases(dvv, {4, 1});
+    ASSERT_EQ(dvv.feature(2)(0), X(2, 42));
+    ASSERT_EQ(dvv.feature(2)(1), X(2, 99));
+    ASSERT_EQ(dvv.longitudinal("b").value(1).data()[0], -X(0, 99));
+
+    // copies of views and copies from views hold the same samples
+    Data copy(dv);
+    ASSERT_TRUE(copy.feature(1).matrix() == dv.feature(1).matrix());
+    MatrixXf Xc;
+    VectorXf yc;
+    LongData Zc;
+    Data dc(Xc, yc, Zc);
+    dv.get_cases(dc, {2, 3});
+    ASSERT_FALSE(dc.is_view());
+    ASSERT_EQ(dc.X.size(), 0);
+    ASSERT_TRUE(dc.matrix().col(0) == X.col(0));
+    ASSERT_TRUE(dc.matrix().col(1) == X.col(5));
+    check_longitudinal(dc);
+
+    // programs see the same outputs on a view as on a copy
+    NodeVariable<float> x1(1);
+    NodeLongitudinal za("a");
+    NodeMean mean;
+    for (Data* data : {&dv, &copy})
+    {
+        State state;
+        x1.evaluate(*data, state);
+        za.evaluate(*data, state);
+        mean.evaluate(*data, state);
+        ASSERT_TRUE(state.f.top().matrix() == dv.feature(0).matrix());
+        state.f.pop();
+        ASSERT_TRUE(state.f.top().matrix() == dv.feature(1).matrix());
+    }
+}
+
+TEST(Data, SplitsLeaveDataInOrder)
+{
+    for (bool classification : {false, true})
+    {
+        int n = 101;
+        MatrixXf X = MatrixXf::Random(2, n);
+        MatrixXf X0 = X;
+        VectorXf y(n);
+        for (int i = 0; i < n; ++i)
+            y(i) = classification ? i % 3 : i;
+        LongData Z = tagged_longitudinal(X);
+
+        DataRef d(X, y, Z, classification);
+        std::mt19937 gen(7);
+        d.train_test_split(true, 0.7, &gen);
+        ASSERT_TRUE(d.o->X == X0);
+
+        // the same draws give the same folds as index lists
+        vector<size_t> t_idx, v_idx;
+        std::mt19937 gen2(7);
+        d.o->split_cases(t_idx, v_idx, 0.7, true, &gen2);
+        ASSERT_EQ(t_idx.size(), d.t->n_samples());
+        ASSERT_EQ(v_idx.size(), d.v->n_samples());
+        // the folds hold their features only in feature-major order
+        ASSERT_EQ(d.t->X.size(), 0);
+        ASSERT_EQ(d.v->X.size(), 0);
+        for (int i = 0; i < t_idx.size(); ++i)
+            ASSERT_TRUE(d.t->matrix().col(i) == X0.col(t_idx[i]));
+        for (int i = 0; i < v_idx.size(); ++i)
+            ASSERT_TRUE(d.v->matrix().col(i) == X0.col(v_idx[i]));
+
+        vector<size_t> all(t_idx);
+        all.insert(all.end(), v_idx.begin(), v_idx.end());
+        std::sort(all.begin(), all.end());
+        ASSERT_TRUE(std::unique(all.begin(), all.end()) == all.end());
+        if (classification)
+            for (float label : {0, 1, 2})
+                ASSERT_TRUE((d.t->y.array() == label).count() 
+                        >= (d.v->y.array() == label).count());
+    }
+}
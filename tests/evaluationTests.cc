@@ -392,3 +392,222 @@ TEST(Evaluation, marginal_fairness)
     ASSERT_EQ(((int)(score_no_alpha*1000000)), 190476);
 
 }
+
+TEST(Evaluation, ParallelValidationMatchesSerial)
+{
+    Feat feat = make_estimator(100, 10, "LinearRidgeRegression", false, 1, 666);
+
+    int N = 200;
+    MatrixXf X(3, N), X_v(3, N);
+    X.setRandom();
+    X_v.setRandom();
+    VectorXf y = 2*X.row(0).array().sin() + X.row(1).array()*X.row(2).array();
+    VectorXf y_v = 2*X_v.row(0).array().sin() 
+                   + X_v.row(1).array()*X_v.row(2).array();
+    std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf> > > z; 
+
+    feat.params.init(X, y);       
+    feat.set_dtypes(find_dtypes(X));
+    feat.pop = Population(feat.params.pop_size);
+    feat.evaluator = Evaluation(feat.params.scorer_);
+	feat.params.set_terminals(X.rows());
+	
+	Data dt(X, y, z);
+    Data dv(X_v, y_v, z);
+    DataRef d;
+    d.setTrainingData(&dt);
+    d.setValidationData(&dv); 
+        
+    feat.initial_model(d);
+    feat.pop.init(feat.best_ind, feat.params);
+    feat.evaluator.fitness(feat.pop.individuals, dt, feat.params);
+
+    // validate serially, then on several threads
+    int threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    feat.evaluator.validation(feat.pop.individuals, dv, feat.params);
+    vector<float> serial;
+    for (const auto& ind : feat.pop.individuals)
+        serial.push_back(ind.fitness_v);
+
+    omp_set_num_threads(4);
+    for (auto& ind : feat.pop.individuals)
+        ind.fitness_v = -1;
+    feat.evaluator.validation(feat.pop.individuals, dv, feat.params);
+    omp_set_num_threads(threads);
+
+    for (size_t i = 0; i < serial.size(); ++i)
+        ASSERT_EQ(feat.pop.individuals.at(i).fitness_v, serial.at(i));
+}
+
+TEST(Evaluation, ParallelBackpropMatchesSerial)
+{
+    Feat feat = make_estimator(100, 10, "LinearRidgeRegression", false, 1, 666);
+    feat.params.backprop = true;
+    feat.params.bp.iters = 5;
+
+    int N = 200;
+    MatrixXf X(3, N);
+    X.setRandom();
+    VectorXf y = 2*X.row(0).array().sin() + X.row(1).array()*X.row(2).array();
+    std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf> > > z; 
+
+    feat.params.init(X, y);       
+    feat.set_dtypes(find_dtypes(X));
+    feat.pop = Population(feat.params.pop_size);
+    feat.evaluator = Evaluation(feat.params.scorer_);
+	feat.params.set_terminals(X.rows());
+	
+	Data dt(X, y, z);
+    DataRef d;
+    d.setTrainingData(&dt);
+        
+    feat.initial_model(d);
+    feat.pop.init(feat.best_ind, feat.params);
+    vector<Individual> serial = feat.pop.individuals;
+    vector<Individual> parallel = feat.pop.individuals;
+
+    // tune weights serially, then on several threads, from the same seed
+    int threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    r.set_seed(42);
+    feat.evaluator.fitness(serial, dt, feat.params);
+
+    omp_set_num_threads(4);
+    r.set_seed(42);
+    feat.evaluator.fitness(parallel, dt, feat.params);
+    omp_set_num_threads(threads);
+
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        ASSERT_TRUE(serial.at(i).program.get_weights() 
+                    == parallel.at(i).program.get_weights());
+        ASSERT_EQ(serial.at(i).fitness, parallel.at(i).fitness);
+    }
+}
+
+TEST(Evaluation, Downsample)
+{
+    Feat feat = make_estimator(100, 10, "LinearRidgeRegression", false, 1, 666);
+    feat.params.downsample = 0.25;
+
+    int N = 200;
+    MatrixXf X(3, N);
+    X.setRandom();
+    VectorXf y = 2*X.row(0).array().sin() + X.row(1).array()*X.row(2).array();
+    std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf> > > z; 
+
+    feat.params.init(X, y);       
+    feat.set_dtypes(find_dtypes(X));
+    feat.pop = Population(feat.params.pop_size);
+    feat.evaluator = Evaluation(feat.params.scorer_);
+	feat.params.set_terminals(X.rows());
+	
+	Data dt(X, y, z);
+    DataRef d;
+    d.setTrainingData(&dt);
+        
+    feat.initial_model(d);
+    feat.pop.init(feat.best_ind, feat.params);
+    feat.evaluator.fitness(feat.pop.individuals, dt, feat.params);
+
+    vector<float> fitness;
+    for (const auto& ind : feat.pop.individuals)
+        fitness.push_back(ind.fitness);
+
+    MatrixXf Xs;
+    VectorXf ys;
+    LongData zs;
+    Data ds(Xs, ys, zs);
+    for (bool informed : {false, true})
+    {
+        feat.params.informed_downsample = informed;
+        feat.evaluator.downsample(feat.pop.individuals, dt, ds, feat.params);
+
+        // a quarter of the cases, each once, viewed by ds
+        vector<size_t> cases = feat.evaluator.cases;
+        ASSERT_EQ(cases.size(), N/4);
+        ASSERT_TRUE(std::adjacent_find(cases.begin(), cases.end()) 
+                    == cases.end());
+        ASSERT_TRUE(ds.is_view());
+        ASSERT_EQ(ds.n_samples(), N/4);
+
+        // individuals are refit and scored on the sampled cases only
+        for (size_t i = 0; i < fitness.size(); ++i)
+        {
+            const Individual& ind = feat.pop.individuals.at(i);
+            ASSERT_EQ(ind.error.size(), cases.size());
+            if (fitness.at(i) < MAX_FLT)
+                ASSERT_NEAR(ind.fitness, ind.error.mean(), 
+                            1e-4*(1 + ind.fitness));
+        }
+    }
+
+    // a parent and an identical offspring get the same fitness on ds
+    feat.params.backprop = false;
+    feat.params.hillclimb = false;
+    vector<Individual> clones(feat.pop.individuals.size());
+    for (size_t i = 0; i < clones.size(); ++i)
+        feat.pop.individuals.at(i).clone(clones.at(i));
+    feat.evaluator.fitness(clones, ds, feat.params);
+    for (size_t i = 0; i < clones.size(); ++i)
+    {
+        const Individual& ind = feat.pop.individuals.at(i);
+        if (ind.fitness == MAX_FLT)
+            continue;
+        ASSERT_NEAR(clones.at(i).fitness, ind.fitness, 
+                    1e-4*(1 + ind.fitness));
+        ASSERT_TRUE(clones.at(i).error.isApprox(ind.error, 1e-4));
+    }
+
+    // offspring are fit on the sample
+    feat.evaluator.fitness(feat.pop.individuals, ds, feat.params);
+    for (const auto& ind : feat.pop.individuals)
+        ASSERT_EQ(ind.error.size(), N/4);
+}
+
+TEST(Evaluation, DownsampleWithClassWeights)
+{
+    Feat feat = make_estimator(100, 10, "LR", true, 1, 666);
+    feat.params.downsample = 0.1;
+
+    // unbalanced classes, so the case order is weighted
+    int N = 500;
+    MatrixXf X(2, N);
+    X.setRandom();
+    VectorXf y = (X.row(0).array() > 0.5).cast<float>();
+    std::map<string, std::pair<vector<ArrayXf>, vector<ArrayXf> > > z; 
+
+    feat.params.init(X, y);       
+    feat.set_dtypes(find_dtypes(X));
+    feat.pop = Population(feat.params.pop_size);
+    feat.evaluator = Evaluation(feat.params.scorer_);
+	feat.params.set_terminals(X.rows());
+    feat.params.set_sample_weights(y);
+    ASSERT_FALSE(feat.params.class_weights.empty());
+	
+	Data dt(X, y, z, true);
+    DataRef d;
+    d.setTrainingData(&dt);
+    feat.initial_model(d);
+    feat.pop.init(feat.best_ind, feat.params);
+    feat.evaluator.fitness(feat.pop.individuals, dt, feat.params);
+
+    MatrixXf Xs;
+    VectorXf ys;
+    LongData zs;
+    Data ds(Xs, ys, zs, true);
+    feat.evaluator.downsample(feat.pop.individuals, dt, ds, feat.params);
+
+    // weights of every training case don't fit the sampled errors
+    Sel::Lexicase lexicase(false);
+    ASSERT_THROW(lexicase.select(feat.pop, feat.params, ds), 
+                 std::length_error);
+
+    // the weights of the sampled cases do
+    feat.params.set_sample_weights(ds.y);
+    vector<size_t> parents = lexicase.select(feat.pop, feat.params, ds);
+    ASSERT_EQ(parents.size(), feat.pop.individuals.size());
+    for (size_t p : parents)
+        ASSERT_TRUE(p < feat.pop.individuals.size());
+}
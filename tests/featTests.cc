@@ -88,6 +88,354 @@ TEST(Feat, predict)
     ASSERT_EQ(feat.predict(X).size(), 7);      
 }
 
+TEST(Feat, predict_archive_batch)
+{
+    Feat feat = make_estimator(100, 10, "LinearRidgeRegression", false, 1,666);
+    feat.set_n_jobs(1);
+
+    MatrixXf X = MatrixXf::Random(2, 50);
+    VectorXf y = 2*X.row(0).array() + 3*X.row(1).array().sin();
+    feat.fit(X, y);
+
+    // the batch matches predicting model by model
+    MatrixXf Xb = X, Xi;
+    MatrixXf batch = feat.predict_archive_batch(Xb, true);
+    vector<unsigned> ids = feat.get_archive_ids(true);
+    ASSERT_EQ(batch.rows(), ids.size());
+    ASSERT_EQ(batch.cols(), X.cols());
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        Xi = X;
+        VectorXf yi = feat.predict_archive(ids.at(i), Xi);
+        ASSERT_TRUE(batch.row(i).transpose().isApprox(yi));
+    }
+}
+
+TEST(Feat, fit_longitudinal_file)
+{
+    int n = 40;
+    MatrixXf X = MatrixXf::Random(2, n);
+    LongData Z;
+    for (int i = 0; i < n; ++i)
+    {
+        ArrayXf v = ArrayXf::Random(1 + i%4), t = ArrayXf::LinSpaced(
+                v.size(), 0, v.size()-1);
+        Z["a"].first.push_back(v);
+        Z["a"].second.push_back(t);
+    }
+    VectorXf y = X.row(0).transpose();
+    for (int i = 0; i < n; ++i)
+        y(i) += Z["a"].first.at(i).mean();
+
+    string path = "fit_longitudinal_test.bin";
+    Util::LongRecords r;
+    for (int i = 0; i < n; ++i)
+        r.ids.push_back(i);
+    r.vars = Dat::flatten(Z);
+    Util::save_longitudinal(path, r);
+
+    // the file is read flat, and fits the same model as Z
+    vector<string> eqns;
+    for (bool from_file : {false, true})
+    {
+        Feat feat = make_estimator(20, 3, "LinearRidgeRegression", false, 
+                                   1, 666);
+        feat.set_n_jobs(1);
+        // fit and predict normalize X in place
+        MatrixXf Xf = X, Xp = X;
+        if (from_file)
+            feat.fit(Xf, y, path);
+        else
+            feat.fit(Xf, y, Z);
+        eqns.push_back(feat.get_eqn());
+        ASSERT_EQ(feat.predict(Xp, Z).size(), n);
+    }
+    ASSERT_EQ(eqns.at(0), eqns.at(1));
+
+    std::remove(path.c_str());
+}
+
+TEST(Feat, predictor)
+{
+    MatrixXf X = MatrixXf::Random(3, 200);
+    VectorXf y = 2*X.row(0).array() + 3*X.row(1).array().sin()
+                 - X.row(2).array().exp();
+    VectorXf yb = (y.array() > y.mean()).cast<float>();
+    MatrixXf Xt = MatrixXf::Random(3, 150);
+
+    // regression, and binary classification with and without probabilities
+    vector<std::tuple<string,bool,VectorXf>> problems = {
+        std::make_tuple("LinearRidgeRegression", false, y),
+        std::make_tuple("LR", true, yb),
+        std::make_tuple("CART", true, yb),
+        std::make_tuple("RF", false, y)
+    };
+    for (auto& p : problems)
+    {
+        Feat feat = make_estimator(50, 5, std::get<0>(p), std::get<1>(p), 
+                1, 666);
+        feat.set_n_jobs(1);
+        feat.set_functions({"+","-","*","/","exp","sin","relu","<","and",
+                "ite"});
+        feat.fit(X, std::get<2>(p));
+
+        Pop::Predictor predictor = feat.get_predictor();
+        ASSERT_EQ(predictor.n_features(), X.rows());
+
+        MatrixXf Xc = Xt;
+        VectorXf expected = feat.predict(Xc);
+        VectorXf yhat = predictor.predict(Xt);
+        ASSERT_TRUE(yhat.isApprox(expected, 1e-4)) << std::get<0>(p);
+
+        // one sample at a time
+        for (int i = 0; i < Xt.cols(); i += 37)
+            ASSERT_NEAR(predictor.predict(Xt.col(i).data()), expected(i),
+                        1e-4*(1+fabs(expected(i))));
+
+        if (std::get<1>(p))
+        {
+            Xc = Xt;
+            ArrayXXf proba = feat.predict_proba(Xc);
+            VectorXf phat = predictor.predict_proba(Xt);
+            ASSERT_TRUE(phat.isApprox(proba.row(0).matrix().transpose(), 
+                        1e-4)) << std::get<0>(p);
+        }
+    }
+}
+
+// compiler used to build the tests, for compiling exported models
+#ifndef CXX_COMPILER
+#define CXX_COMPILER "c++"
+#endif
+
+/// compiles the exported header source of namespace name, and returns the
+/// predictions and, if proba is set, the probabilities it makes for the
+/// columns of X
+static void run_export(const string& source, const string& name, 
+        const MatrixXf& X, bool proba, VectorXf& y, VectorXf& p)
+{
+    std::ofstream(name + ".h") << source;
+    std::ofstream main(name + ".cc");
+    main << "#include \"" << name << ".h\"\n#include <cstdio>\n"
+         << "static const float X[] = {";
+    for (int i = 0; i < X.size(); ++i)
+        main << std::scientific << std::setprecision(9) << X.data()[i]
+             << "f,";
+    main << "};\nint main()\n{\n"
+         << "    const std::size_t n = " << X.cols() << ";\n"
+         << "    static float y[n], p[n];\n"
+         << "    " << name << "::predict(X, n, y);\n";
+    if (proba)
+        main << "    " << name << "::predict_proba(X, n, p);\n";
+    main << "    for (std::size_t i = 0; i < n; ++i)\n"
+         << "        std::printf(\"%.9g %.9g\\n\", y[i], p[i]);\n}\n";
+    main.close();
+
+    string cmd = string(CXX_COMPILER) + " -std=c++11 -O2 -o " + name 
+                 + " " + name + ".cc";
+    ASSERT_EQ(std::system(cmd.c_str()), 0) << cmd;
+
+    FILE* out = popen(("./" + name).c_str(), "r");
+    ASSERT_TRUE(out != NULL);
+    y.resize(X.cols());
+    p.resize(X.cols());
+    for (int i = 0; i < X.cols(); ++i)
+        ASSERT_EQ(fscanf(out, "%f %f", &y(i), &p(i)), 2);
+    pclose(out);
+    for (string ext : {".h", ".cc", ""})
+        std::remove((name + ext).c_str());
+}
+
+TEST(Feat, predictor_operators)
+{
+    // the predictor runs every operator the bytecode compiles with the
+    // same kernels as Individual::predict()
+    int N = 300;
+    MatrixXf X(4, N);
+    X.setRandom();
+    X.row(2) = (X.row(2).array() > 0).cast<float>();
+    X.row(3) = (X.row(3).array()*1.5 + 1.5).floor();
+    VectorXf y = X.row(0).array().sin() + X.row(1).array().square();
+    LongData Z;
+    Data d(X, y, Z);
+
+    Feat feat = make_estimator(10, 1, "LinearRidgeRegression", false, 1, 666);
+    feat.params.init(X, y);
+    feat.params.set_terminals(X.rows());
+
+    bool b_true = true;
+    float half = 0.5;
+    vector<vector<Node*>> programs = {
+        {new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeSubtract(), new NodeVariable<float>(0),
+         new NodeVariable<float>(1), new NodeExponent(),
+         new NodeVariable<float>(0), new NodeLogit(),
+         new NodeVariable<float>(1), new NodeSquare(),
+         new NodeVariable<float>(0), new NodeCube(),
+         new NodeVariable<float>(1), new NodeSqrt(),
+         new NodeVariable<float>(0), new NodeGaussian(),
+         new NodeVariable<float>(1), new NodeStep(),
+         new NodeConstant(half), new NodeVariable<float>(0), new NodeAdd()},
+        {new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeDivide(), new NodeSin(), new NodeVariable<float>(0),
+         new NodeExponential(), new NodeMultiply(), new NodeLog(),
+         new NodeVariable<float>(0), new NodeCos(),
+         new NodeVariable<float>(1), new NodeTanh(),
+         new NodeVariable<float>(0), new NodeRelu(),
+         new NodeVariable<float>(1), new NodeSign(),
+         new NodeVariable<float>(0), new NodeSqrt()},
+        {new NodeVariable<float>(1), new NodeVariable<float>(0),
+         new NodeGreaterThan(), new NodeVariable<bool>(2, 'b'), new NodeXor(),
+         new NodeFloat<bool>(),
+         new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeLessThan(), new NodeVariable<float>(0),
+         new NodeVariable<float>(1), new NodeEqual(), new NodeOr(),
+         new NodeNot(), new NodeConstant(b_true), new NodeAnd(),
+         new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeGEQ(), new NodeVariable<float>(0),
+         new NodeVariable<float>(1), new NodeLEQ()},
+        {new NodeVariable<float>(0), new NodeSplit<float>(),
+         new NodeVariable<int>(3, 'c'), new NodeSplit<int>(), new NodeAnd(),
+         new NodeVariable<int>(3, 'c'), new NodeFloat<int>(),
+         new NodeVariable<float>(0), new NodeVariable<float>(1),
+         new NodeVariable<bool>(2, 'b'), new NodeIfThenElse(),
+         new NodeVariable<float>(1), new NodeVariable<bool>(2, 'b'),
+         new NodeIf(), new NodeVariable<int>(3, 'c')}
+    };
+    // negative weights make sqrt nan, which must be cleaned the same way
+    dynamic_cast<NodeDx*>(programs.at(1).back())->W.at(0) = -2;
+
+    vector<bool> ran(OP_LOAD_F, false);
+    for (const auto& p : programs)
+    {
+        Individual ind;
+        for (auto n : p)
+            ind.program.push_back(std::unique_ptr<Node>(n));
+        bool pass = true;
+        ind.fit(d, feat.params, pass);
+
+        Bytecode bc(ind.program);
+        ASSERT_TRUE(bc.compiled) << ind.program_str();
+        for (const auto& ins : bc.code)
+            ran.at(ins.op) = true;
+
+        VectorXf expected = ind.predict_vector(d);
+        Pop::Predictor predictor(ind, X.rows());
+        VectorXf yhat = predictor.predict(X);
+        for (int i = 0; i < N; ++i)
+            ASSERT_NEAR(yhat(i), expected(i), 1e-4*(1+fabs(expected(i))))
+                << ind.program_str();
+
+        // and so does the exported code, up to the precision of the 
+        // math library
+        VectorXf ycpp, pcpp;
+        run_export(predictor.to_cpp("operators_test"), "operators_test", X,
+                   false, ycpp, pcpp);
+        for (int i = 0; i < N; ++i)
+            ASSERT_NEAR(ycpp(i), expected(i), 1e-3*(1+fabs(expected(i))))
+                << ind.program_str();
+    }
+    // every operator but cached loads was run
+    ASSERT_TRUE(std::all_of(ran.begin(), ran.end(), [](bool r){ return r; }));
+}
+
+TEST(Feat, export_cpp)
+{
+    MatrixXf X = MatrixXf::Random(3, 200);
+    VectorXf y = 2*X.row(0).array() + 3*X.row(1).array().sin()
+                 - X.row(2).array().exp();
+    VectorXf yb = (y.array() > y.mean()).cast<float>();
+    MatrixXf Xt = MatrixXf::Random(3, 100);
+
+    for (bool classification : {false, true})
+    {
+        Feat feat = make_estimator(50, 5, 
+                classification ? "LR" : "LinearRidgeRegression", 
+                classification, 1, 666);
+        feat.set_n_jobs(1);
+        feat.set_functions({"+","-","*","/","exp","log","sin","relu","<",
+                "and","ite"});
+        feat.fit(X, classification ? yb : y);
+
+        VectorXf yhat, phat;
+        run_export(feat.export_cpp("export_cpp_test"), "export_cpp_test", Xt,
+                   classification, yhat, phat);
+
+        MatrixXf Xc = Xt;
+        VectorXf expected = feat.predict(Xc);
+        if (!classification)
+        {
+            ASSERT_TRUE(yhat.isApprox(expected, 1e-4));
+            continue;
+        }
+        Xc = Xt;
+        ArrayXXf proba = feat.predict_proba(Xc);
+        for (int i = 0; i < Xt.cols(); ++i)
+        {
+            ASSERT_NEAR(phat(i), proba(0,i), 1e-4);
+            // labels can only differ right at the threshold
+            if (fabs(proba(0,i) - 0.5) > 1e-4)
+                ASSERT_EQ(yhat(i), expected(i));
+        }
+    }
+}
+
+TEST(Feat, predict_stream)
+{
+    Feat feat = make_estimator(50, 5, "LinearRidgeRegression", false, 1, 666);
+    feat.set_n_jobs(1);
+
+    MatrixXf X = MatrixXf::Random(2, 100);
+    VectorXf y = 2*X.row(0).array() + 3*X.row(1).array().sin();
+    feat.fit(X, y);
+
+    // chunks of an in-memory matrix, the last one short
+    MatrixXf Xt = MatrixXf::Random(2, 250);
+    int next = 0;
+    ChunkReader read = [&](MatrixXf& Xc, LongData&, size_t n){
+        n = std::min<size_t>(n, Xt.cols() - next);
+        Xc = Xt.middleCols(next, n);
+        next += n;
+        return n;
+    };
+
+    vector<float> yhat;
+    feat.predict_stream(read, [&](const VectorXf& yc){ 
+            yhat.insert(yhat.end(), yc.data(), yc.data() + yc.size()); }, 16);
+    MatrixXf Xc = Xt;
+    VectorXf expected = feat.predict(Xc);
+    ASSERT_EQ(yhat.size(), Xt.cols());
+    ASSERT_TRUE(Map<VectorXf>(yhat.data(), yhat.size()).isApprox(expected, 
+                1e-4));
+
+    next = 0;
+    MatrixXf Phi(0, 0);
+    feat.transform_stream(read, [&](const MatrixXf& Pc){
+            Phi.conservativeResize(Pc.rows() + Phi.rows(), Pc.cols());
+            Phi.bottomRows(Pc.rows()) = Pc; }, 16);
+    Xc = Xt;
+    ASSERT_TRUE(Phi.isApprox(feat.transform(Xc)));
+
+    // from a csv file, in chunks that don't divide the rows
+    string path = "predict_stream_test.csv", out_path = path + ".out";
+    std::ofstream csv(path);
+    csv << "x1,target,x2\n";
+    csv.precision(9);
+    for (int i = 0; i < Xt.cols(); ++i)
+        csv << Xt(0,i) << ",0," << Xt(1,i) << "\n";
+    csv.close();
+    feat.predict_file(path, out_path, 33);
+
+    std::ifstream out(out_path);
+    float v;
+    int i = 0;
+    for (; out >> v; ++i)
+        ASSERT_NEAR(v, expected(i), 1e-4*(1+fabs(expected(i))));
+    ASSERT_EQ(i, Xt.cols());
+    std::remove(path.c_str());
+    std::remove(out_path.c_str());
+}
+
 TEST(Feat, transform)
 {
     Feat feat = make_estimator(100, 10, "LinearRidgeRegression", false, 1, 666);
@@ -166,6 +166,97 @@ TEST(Individual, Complexity)
 	a.complexity = 0;
 }
 
+TEST(Individual, Structure)
+{
+	Individual a;
+
+	// two dimensions: (x1+x2)*(x3-x4) and ite(x5,x6,true)
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(2)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeAdd()));
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(3)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(4)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeSubtract()));
+	a.program.push_back(std::unique_ptr<Node>(new NodeMultiply()));
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(5)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(6)));
+	bool t = true;
+	a.program.push_back(std::unique_ptr<Node>(new NodeConstant(t)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeIfThenElse()));
+
+	// answers from the reverse scan must match the index
+	vector<size_t> subtrees;
+	for (size_t i = 0; i < a.program.size(); ++i)
+	    subtrees.push_back(a.program.subtree(i));
+	vector<size_t> roots = a.program.roots();
+	unsigned complexity = a.set_complexity();
+
+	a.program.update_structure();
+
+	ASSERT_EQ(a.program.roots(), roots);
+	ASSERT_EQ(roots, vector<size_t>({6, 10}));
+	ASSERT_EQ(a.program.root_types(), vector<char>({'f','f'}));
+	for (size_t i = 0; i < a.program.size(); ++i)
+	    ASSERT_EQ(a.program.subtree(i), subtrees.at(i));
+	ASSERT_EQ(a.set_complexity(), complexity);
+	ASSERT_EQ(a.get_dim(), 2);
+
+	ASSERT_EQ(a.program.root_of(3), 0);
+	ASSERT_EQ(a.program.root_of(8), 1);
+	ASSERT_EQ(a.program.depth(6), 0);
+	ASSERT_EQ(a.program.depth(5), 1);
+	ASSERT_EQ(a.program.depth(4), 2);
+	ASSERT_EQ(a.program.depth(9), 1);
+
+	// same size replacement changes complexity once the index is rebuilt
+	a.program.at(6) = std::unique_ptr<Node>(new NodeAdd());
+	a.program.update_structure();
+	ASSERT_LT(a.set_complexity(), complexity);
+
+	// copies carry the index along
+	NodeVector b = a.program;
+	ASSERT_EQ(b.subtree(10), 7);
+	ASSERT_EQ(b.complexity(), a.program.complexity());
+}
+
+TEST(Individual, OutReusesState)
+{
+    // out() recycles a per-thread State, so outputs must not depend on
+    // the programs evaluated before.
+    MatrixXf X(2,3); 
+    X << 1.0, 2.0, 3.0,
+         4.0, 5.0, 6.0;
+    VectorXf y(3);
+    y << 1.0, 2.0, 3.0;
+    LongData z;
+    Data d(X, y, z);
+
+	Individual a, b;
+	
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(0)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+	a.program.push_back(std::unique_ptr<Node>(new NodeAdd({1.0, 1.0})));
+	
+	b.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(0)));
+	b.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+	b.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(0)));
+	b.program.push_back(std::unique_ptr<Node>(new NodeMultiply({1.0, 1.0})));
+	b.program.push_back(std::unique_ptr<Node>(new NodeSubtract({1.0, 1.0})));
+	b.program.push_back(std::unique_ptr<Node>(new NodeVariable<float>(1)));
+	
+	MatrixXf Phi_a = a.out(d);
+	MatrixXf Phi_b = b.out(d);
+	
+	ASSERT_EQ(Phi_a.rows(), 1);
+	ASSERT_EQ(Phi_b.rows(), 2);
+	ASSERT_TRUE(Phi_a.isApprox(a.out(d)));
+	ASSERT_TRUE(Phi_b.isApprox(b.out(d)));
+	
+	VectorXf expected(3);
+	expected << 5.0, 7.0, 9.0;
+	ASSERT_TRUE(Phi_a.row(0).transpose().isApprox(expected));
+}
+
 TEST(Individual, serialization)
 {
     /* setup data, then test random individuals. 
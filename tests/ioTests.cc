@@ -0,0 +1,197 @@
+#include "testsHeader.h"
+
+TEST(IO, CSVToColumnar)
+{
+    // a csv with the target in the middle, blank lines and windows endings
+    string csv = "columnar_test.csv", path = "columnar_test.bin";
+    std::ofstream out(csv);
+    out << "x1,class,x2,x3\n";
+    out.precision(9);
+    int n = 300;
+    MatrixXf X(3, n);
+    VectorXf y(n);
+    for (int i = 0; i < n; ++i)
+    {
+        X(0,i) = r.rnd_flt();
+        X(1,i) = r.rnd_int(0, 4);
+        X(2,i) = r.rnd_int(0, 1);
+        y(i) = r.rnd_int(0, 1);
+        out << X(0,i) << "," << y(i) << ", " << X(1,i) << "," << X(2,i)
+            << (i % 2 ? "\r\n" : "\n");
+        if (i % 100 == 50)
+            out << "\n";
+    }
+    out.close();
+
+    Util::csv_to_columnar(csv, path);
+
+    Util::ColumnarFile f(path);
+    ASSERT_EQ(f.n_samples(), n);
+    ASSERT_EQ(f.n_features(), 3);
+    ASSERT_TRUE(f.has_target());
+    ASSERT_TRUE(f.get_binary_endpoint());
+    ASSERT_EQ(f.get_names(), vector<string>({"x1","x2","x3"}));
+    ASSERT_EQ(f.get_dtypes(), Util::find_dtypes(X));
+    ASSERT_TRUE(f.X() == X);
+    ASSERT_TRUE(f.y() == y);
+
+    // columns are stored in place
+    for (int i = 0; i < n; ++i)
+        ASSERT_EQ(f.feature(1)[i], X(1,i));
+
+    // chunks
+    MatrixXf Xb;
+    ASSERT_EQ(f.read(Xb, 280, 64), 20);
+    ASSERT_TRUE(Xb == X.rightCols(20));
+    ASSERT_EQ(f.read(Xb, n, 64), 0);
+
+    // malformed rows are reported
+    out.open(csv);
+    out << "x1,x2\n1,2\n3,oops\n";
+    out.close();
+    ASSERT_THROW(Util::csv_to_columnar(csv, path), std::runtime_error);
+
+    std::remove(csv.c_str());
+    std::remove(path.c_str());
+}
+
+TEST(IO, SaveColumnar)
+{
+    string path = "columnar_test.bin";
+    MatrixXf X = MatrixXf::Random(4, 77);
+    VectorXf y = VectorXf::Random(77);
+    vector<string> names = {"a","bb","ccc","d"};
+    vector<char> dtypes = Util::find_dtypes(X);
+
+    Util::save_columnar(path, X, y, names, dtypes);
+    ASSERT_TRUE(Util::is_columnar(path));
+
+    MatrixXf X2;
+    VectorXf y2;
+    vector<string> names2;
+    vector<char> dtypes2;
+    bool binary_endpoint;
+    Util::load_columnar(path, X2, y2, names2, dtypes2, binary_endpoint);
+    ASSERT_TRUE(X2 == X);
+    ASSERT_TRUE(y2 == y);
+    ASSERT_EQ(names2, names);
+    ASSERT_EQ(dtypes2, dtypes);
+    ASSERT_FALSE(binary_endpoint);
+
+    // without a target
+    Util::save_columnar(path, X, VectorXf(), names, dtypes);
+    Util::ColumnarFile f(path);
+    ASSERT_FALSE(f.has_target());
+    ASSERT_TRUE(f.X(10, 5) == X.middleCols(10, 5));
+
+    // columns read straight into the features of a Data
+    RowMatrixXf X_fm;
+    ASSERT_EQ(f.read(X_fm, 70), 7);
+    ASSERT_TRUE(MatrixXf(X_fm) == X.middleCols(70, 7));
+    f.read(X_fm, 0);
+    MatrixXf Xd;
+    VectorXf yd = y;
+    LongData Zd;
+    Data d(Xd, yd, Zd);
+    d.set_features(std::move(X_fm));
+    ASSERT_EQ(d.X.size(), 0);
+    ASSERT_EQ(d.n_samples(), 77);
+    ASSERT_EQ(d.n_features(), 4);
+    ASSERT_TRUE(d.matrix() == X);
+
+    std::remove(path.c_str());
+}
+
+TEST(IO, LoadLongitudinal)
+{
+    // rows in random order, with the columns in an unusual order
+    string csv = "longitudinal_test.csv", path = "longitudinal_test.bin";
+    int n = 50;
+    LongData Z;
+    vector<std::tuple<int,float,float,string>> rows;
+    for (string name : {"b", "a"})
+        for (int i = 0; i < n; ++i)
+        {
+            int m = r.rnd_int(1, 6);
+            for (int j = 0; j < m; ++j)
+            {
+                float v = r.rnd_int(0, 1000)/8.0, t = j;
+                rows.push_back(std::make_tuple(i, v, t, name));
+                Z[name].first.resize(n);
+                Z[name].second.resize(n);
+                auto& zv = Z[name].first[i];
+                auto& zt = Z[name].second[i];
+                zv.conservativeResize(zv.size()+1);
+                zt.conservativeResize(zt.size()+1);
+                zv(zv.size()-1) = v;
+                zt(zt.size()-1) = t;
+            }
+        }
+    // samples are shuffled; the values of a sample keep their order
+    vector<size_t> order(rows.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){
+            return (std::get<0>(rows[a])*7919) % n 
+                   < (std::get<0>(rows[b])*7919) % n; });
+    std::ofstream out(csv);
+    out << "name,id,value,date\n";
+    for (size_t k : order)
+        out << std::get<3>(rows[k]) << "," << std::get<0>(rows[k]) << "," 
+            << std::get<1>(rows[k]) << "," << std::get<2>(rows[k]) 
+            << (k % 2 ? "\r\n" : "\n");
+    out.close();
+
+    auto same = [](const LongData& A, const LongData& B){
+        if (A.size() != B.size())
+            return false;
+        for (const auto& z : A)
+        {
+            const auto& w = B.at(z.first);
+            if (z.second.first.size() != w.first.size())
+                return false;
+            for (size_t i = 0; i < w.first.size(); ++i)
+                if (!(z.second.first[i].matrix() == w.first[i].matrix())
+                    || !(z.second.second[i].matrix() == w.second[i].matrix()))
+                    return false;
+        }
+        return true;
+    };
+
+    LongData Zc, Zb;
+    Util::load_longitudinal(csv, Zc);
+    ASSERT_TRUE(same(Zc, Z));
+
+    Util::csv_to_longitudinal(csv, path);
+    ASSERT_TRUE(Util::is_longitudinal(path));
+    Util::load_longitudinal(path, Zb);
+    ASSERT_TRUE(same(Zb, Z));
+
+    // partial loads select and repeat samples by id
+    vector<int> idx = {7, 3, 3, 49};
+    LongData Zp;
+    for (const auto& z : Z)
+        for (int i : idx)
+        {
+            Zp[z.first].first.push_back(z.second.first[i]);
+            Zp[z.first].second.push_back(z.second.second[i]);
+        }
+    for (const string& p : {csv, path})
+    {
+        LongData Zi;
+        Util::load_partial_longitudinal(p, Zi, ',', idx);
+        ASSERT_TRUE(same(Zi, Zp));
+    }
+
+    // ids that aren't in the file are reported
+    LongData Ze;
+    ASSERT_THROW(Util::load_partial_longitudinal(csv, Ze, ',', {1, 50}),
+                 std::runtime_error);
+
+    out.open(csv);
+    out << "id,date,value,name\n0,1,2,a\n1,oops,2,a\n";
+    out.close();
+    ASSERT_THROW(Util::load_longitudinal(csv, Ze), std::runtime_error);
+
+    std::remove(csv.c_str());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,97 @@
+#include "testsHeader.h"
+
+/// inputs covering the range of each kernel, plus values that need care:
+/// zeros, signed infinities, nans, tiny and huge magnitudes
+ArrayXf kernel_inputs()
+{
+    int n = 20000;
+    ArrayXf x(n + 12);
+    x.head(n) = ArrayXf::LinSpaced(n, -120, 120);
+    x.segment(n/2, 1000) = ArrayXf::LinSpaced(1000, -1, 1);
+    x.segment(n/4, 500) = ArrayXf::LinSpaced(500, -1e4, 1e4);
+    x.tail(12) << 0, -0.0f, 1e-40f, -1e-40f, 1e-7f, 3e4f, -3e4f, 1e30f,
+                  MAX_FLT, MIN_FLT, std::numeric_limits<float>::infinity(),
+                  std::numeric_limits<float>::quiet_NaN();
+    return x;
+}
+
+/// succeeds if a and b agree to a relative tolerance, treating nans and
+/// infinities of the same kind as equal
+::testing::AssertionResult close(const ArrayXf& a, const ArrayXf& b, 
+                                 float tol=1e-5)
+{
+    for (int i = 0; i < a.size(); ++i)
+    {
+        if (std::isnan(a(i)) || std::isnan(b(i)))
+        {
+            if (std::isnan(a(i)) != std::isnan(b(i)))
+                return ::testing::AssertionFailure() 
+                    << "at " << i << ": " << a(i) << " != " << b(i);
+            continue;
+        }
+        if (std::isinf(a(i)) || std::isinf(b(i)))
+        {
+            if (a(i) != b(i))
+                return ::testing::AssertionFailure() 
+                    << "at " << i << ": " << a(i) << " != " << b(i);
+            continue;
+        }
+        if (std::abs(a(i) - b(i)) > tol*(1e-1 + std::abs(b(i))))
+            return ::testing::AssertionFailure() 
+                << "at " << i << ": " << a(i) << " != " << b(i);
+    }
+    return ::testing::AssertionSuccess();
+}
+
+TEST(Kernels, MatchScalarVersions)
+{
+    ArrayXf x = kernel_inputs();
+    ArrayXf y = x.reverse();
+    ArrayXf out(x.size());
+    int N = x.size();
+
+    for (float w : {1.0f, -0.37f, 2.5f})
+    {
+        CPU_Exp(out.data(), x.data(), N, w);
+        ASSERT_TRUE(close(out, Node::limited(exp(w*x))));
+
+        CPU_Log(out.data(), x.data(), N, w);
+        ASSERT_TRUE(close(out, (abs(x) > NEAR_ZERO).select(log(abs(w*x)),
+                                                          MIN_FLT)));
+
+        CPU_Logit(out.data(), x.data(), N, w);
+        ASSERT_TRUE(close(out, 1/(1+(Node::limited(exp(-w*x))))));
+
+        CPU_Sin(out.data(), x.data(), N, w);
+        ASSERT_TRUE(close(out, Node::limited(sin(w*x))));
+
+        CPU_Cos(out.data(), x.data(), N, w);
+        ASSERT_TRUE(close(out, Node::limited(cos(w*x))));
+
+        CPU_Tanh(out.data(), x.data(), N, w);
+        ASSERT_TRUE(close(out, Node::limited(tanh(w*x))));
+
+        CPU_Gaussian(out.data(), x.data(), N, w);
+        ASSERT_TRUE(close(out, Node::limited(exp(-pow(w - x, 2)))));
+
+        ArrayXf x1 = x.head(20000)/50, x2 = y.head(20000)/50;
+        ArrayXf o2(x1.size());
+        CPU_Gaussian2D(o2.data(), x1.data(), x2.data(), x1.size(),
+                       x1.mean(), variance(x1), x2.mean(), variance(x2),
+                       w, 0.5);
+        ASSERT_TRUE(close(o2, Node::limited(exp(-1*(
+                        pow(w*(x1-x1.mean()), 2)/(2*variance(x1))
+                        + pow(0.5f*(x2 - x2.mean()), 2)/variance(x2))))));
+
+        CPU_Exponent(out.data(), x.data(), y.data(), N, w, 0.5);
+        ASSERT_TRUE(close(out, Node::limited(pow(w*x, 0.5f*y))));
+    }
+}
+
+TEST(Kernels, WriteInPlace)
+{
+    ArrayXf x = kernel_inputs();
+    ArrayXf expected = Node::limited(sin(0.5f*x));
+    CPU_Sin(x.data(), x.data(), x.size(), 0.5);
+    ASSERT_TRUE(close(x, expected));
+}
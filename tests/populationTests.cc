@@ -56,3 +56,36 @@ TEST(Population, PopulationTests)
     
 }
 
+
+TEST(Population, ArchiveInsert)
+{
+    Archive archive;
+    archive.set_objectives({"fitness","size"});
+
+    auto candidate = [](float f, float c, unsigned id)
+    {
+        Individual ind;
+        ind.obj = {f, c};
+        ind.Phi = MatrixXf::Ones(2, 100);
+        ind.set_id(id);
+        return ind;
+    };
+
+    ASSERT_TRUE(archive.insert(candidate(2, 2, 0)));
+    ASSERT_TRUE(archive.insert(candidate(1, 3, 1)));
+    // dominated, or the same objectives as an archived program
+    ASSERT_FALSE(archive.insert(candidate(3, 3, 2)));
+    ASSERT_FALSE(archive.insert(candidate(2, 2, 3)));
+    // dominates 0
+    ASSERT_TRUE(archive.insert(candidate(2, 1, 4)));
+
+    archive.sort();
+    ASSERT_EQ(archive.individuals.size(), 2);
+    ASSERT_EQ(archive.individuals.at(0).id, 1);
+    ASSERT_EQ(archive.individuals.at(1).id, 4);
+    for (const auto& ind : archive.individuals)
+    {
+        ASSERT_EQ(ind.rank, 1);
+        ASSERT_EQ(ind.Phi.size(), 0);
+    }
+}
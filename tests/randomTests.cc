@@ -74,3 +74,54 @@ TEST(Random, SetSeed)
         ASSERT_EQ(doubles[2][i], r.rnd_dbl());
         
 }
+
+TEST(Random, WeightedOrder)
+{
+    r.set_seed(42);
+
+    // a permutation, with zero weights last
+    vector<float> w = {0.5, 0, 2, 1, 0, 3};
+    vector<size_t> order = r.weighted_order(w);
+    vector<size_t> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < w.size(); ++i)
+        ASSERT_EQ(sorted.at(i), i);
+    ASSERT_EQ(w.at(order.at(4)), 0);
+    ASSERT_EQ(w.at(order.at(5)), 0);
+
+    // each index comes first in proportion to its weight
+    w = {1, 2, 7};
+    vector<float> first(3, 0);
+    int trials = 20000;
+    for (int i = 0; i < trials; ++i)
+        first.at(r.weighted_order(w).at(0)) += 1.0/trials;
+    ASSERT_NEAR(first.at(0), 0.1, 0.02);
+    ASSERT_NEAR(first.at(1), 0.2, 0.02);
+    ASSERT_NEAR(first.at(2), 0.7, 0.02);
+}
+
+TEST(Random, WeightedOrderScaling)
+{
+    // orders cases as class-weighted lexicase does, on large imbalanced 
+    // sets of cases
+    r.set_seed(42);
+    for (int N : {1000, 10000, 100000})
+    {
+        vector<float> w(N);
+        for (int i = 0; i < N; ++i)
+            w.at(i) = i % 10 == 0 ? 0.9 : 0.1;   // imbalanced classes
+
+        vector<size_t> order = r.weighted_order(w);
+        ASSERT_EQ(order.size(), N);
+        vector<size_t> sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        for (int i = 0; i < N; ++i)
+            ASSERT_EQ(sorted.at(i), i);
+
+        // heavier cases come earlier on average
+        double heavy = 0, light = 0;
+        for (int k = 0; k < N; ++k)
+            (order.at(k) % 10 == 0 ? heavy : light) += k;
+        ASSERT_LT(heavy/(N/10), light/(N - N/10));
+    }
+}
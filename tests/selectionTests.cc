@@ -1,4 +1,7 @@
 #include "testsHeader.h"
+#include "../src/sel/lexicase_core.h"
+#include "../src/sel/nd_sort.h"
+using namespace Sel;
 
 class SelectionTest : public testing::TestWithParam<std::string> {
 protected:
@@ -75,3 +78,172 @@ INSTANTIATE_TEST_SUITE_P(AllSelectionTypes, SelectionTest,
     testing::Values("lexicase", "fair_lexicase", "pareto_lexicase",
                     "split_lexicase", "static_split_lexicase", "semi_split_lexicase",
                     "simanneal", "tournament", "offspring", "random", "nsga2"));
+
+TEST(LexicaseCore, FiltersMatchScan)
+{
+    // 150 individuals span two full blocks and a partial one
+    int P = 150, N = 4;
+    MatrixXf errors = MatrixXf::Random(P, N).cwiseAbs();
+    LexicaseCore core(errors);
+
+    for (int trial = 0; trial < 3; ++trial)
+    {
+        // the full pool, then sparser ones
+        CasePool pool(P);
+        vector<size_t> members;
+        for (int j = 0; j < P; ++j)
+        {
+            if (trial > 0 && (j % (trial*3)) != 0)
+                pool.words.at(j/64) &= ~(uint64_t(1) << (j%64));
+            else
+                members.push_back(j);
+        }
+        ASSERT_EQ(pool.count(), members.size());
+        ASSERT_TRUE(pool.members() == members);
+
+        for (int c = 0; c < N; ++c)
+        {
+            float min_error = MAX_FLT;
+            for (auto j : members)
+                min_error = std::min(min_error, errors(j, c));
+            ASSERT_EQ(core.min(pool, c), min_error);
+
+            VectorXf g = core.gather(pool, c);
+            for (size_t k = 0; k < members.size(); ++k)
+                ASSERT_EQ(g(k), errors(members.at(k), c));
+
+            float t = min_error + 0.3;
+            for (bool strict : {false, true})
+            {
+                CasePool kept = pool;
+                size_t n = core.keep(kept, c, t, strict);
+                vector<size_t> expected;
+                for (auto j : members)
+                    if (strict ? errors(j, c) < t : errors(j, c) <= t)
+                        expected.push_back(j);
+                ASSERT_EQ(n, expected.size());
+                ASSERT_TRUE(kept.members() == expected);
+            }
+        }
+    }
+}
+
+TEST(LexicaseCore, SelectsElite)
+{
+    // individual 70 is best on every case, so it wins every event
+    int P = 100, N = 10;
+    MatrixXf errors = MatrixXf::Random(P, N).cwiseAbs().array() + 1;
+    errors.row(70).setZero();
+    LexicaseCore core(errors);
+
+    vector<size_t> cases(N);
+    std::iota(cases.begin(), cases.end(), 0);
+    auto filter = [&](CasePool& pool, size_t h)
+    {
+        float t = core.min(pool, cases[h]);
+        core.keep(pool, cases[h], t);
+        return t;
+    };
+    for (int i = 0; i < 10; ++i)
+    {
+        size_t n_cases;
+        float threshold;
+        ASSERT_EQ(core.select(cases, filter, n_cases, threshold), 70);
+        ASSERT_EQ(n_cases, 1);
+        ASSERT_EQ(threshold, 0);
+    }
+    // with no filtering, everyone is in the last pool
+    auto keep_all = [](CasePool& pool, size_t h) { return 0.0f; };
+    size_t n_cases;
+    float threshold;
+    ASSERT_TRUE(core.select(cases, keep_all, n_cases, threshold) < P);
+    ASSERT_EQ(n_cases, N);
+}
+
+/// ranks (from 0) of the rows of F, by peeling off non-dominated rows
+vector<int> brute_force_ranks(const Objectives& F)
+{
+    int P = F.rows(), M = F.cols();
+    auto dominates = [&](int a, int b)
+    {
+        bool better = false;
+        for (int k = 0; k < M; ++k)
+        {
+            if (F(a,k) > F(b,k))
+                return false;
+            better |= F(a,k) < F(b,k);
+        }
+        return better;
+    };
+    vector<int> rank(P, -1);
+    for (int r = 0, left = P; left > 0; ++r)
+    {
+        vector<int> front;
+        for (int i = 0; i < P; ++i)
+        {
+            if (rank[i] >= 0)
+                continue;
+            bool dominated = false;
+            for (int j = 0; j < P && !dominated; ++j)
+                dominated = rank[j] < 0 && dominates(j, i);
+            if (!dominated)
+                front.push_back(i);
+        }
+        for (auto i : front)
+            rank[i] = r;
+        left -= front.size();
+    }
+    return rank;
+}
+
+TEST(NDSort, MatchesBruteForce)
+{
+    r.set_seed(42);
+    for (int M : {2, 3, 5})
+    {
+        // small integers, so that many rows tie
+        Objectives F(300, M);
+        for (int i = 0; i < F.rows(); ++i)
+            for (int k = 0; k < M; ++k)
+                F(i,k) = r.rnd_int(0, 9);
+
+        vector<int> rank = brute_force_ranks(F);
+        vector<vector<int>> fronts = nd_sort(F);
+
+        int n = 0;
+        for (int f = 0; f < fronts.size(); ++f)
+        {
+            ASSERT_TRUE(std::is_sorted(fronts[f].begin(), fronts[f].end()));
+            for (auto i : fronts[f])
+                ASSERT_EQ(rank[i], f);
+            n += fronts[f].size();
+        }
+        ASSERT_EQ(n, F.rows());
+        ASSERT_TRUE(nd_front(F) == fronts.at(0));
+    }
+}
+
+TEST(NDSort, CrowdingDistance)
+{
+    Objectives F(4, 2);
+    F << 0, 4,
+         1, 2,
+         3, 1,
+         4, 0;
+    vector<int> front = {0, 1, 2, 3};
+    ArrayXf d = crowding_distance(F, front);
+
+    float inf = std::numeric_limits<float>::max();
+    ASSERT_EQ(d(0), inf);
+    ASSERT_EQ(d(3), inf);
+    ASSERT_FLOAT_EQ(d(1), 3.0/4 + 3.0/4);
+    ASSERT_FLOAT_EQ(d(2), 3.0/4 + 2.0/4);
+
+    // an objective without spread adds nothing
+    F.col(1).setConstant(1);
+    d = crowding_distance(F, {1, 2});
+    ASSERT_EQ(d(0), inf);
+    ASSERT_EQ(d(1), inf);
+    d = crowding_distance(F, front);
+    ASSERT_FLOAT_EQ(d(1), 3.0/4);
+}